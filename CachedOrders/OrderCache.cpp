@@ -93,26 +93,586 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include "OrderCache.h"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <utility>
 #include <memory>
 #include <unordered_set>
 #include <shared_mutex>
-#ifdef THROW_EXCEPTIONS
-#include <stdexcept>
-#endif
 #include <mutex>
 #include <thread>
 #include <type_traits>
+#include <stdexcept>
+#include <cstring>
+#include <cstddef>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// vectorized matching kernels (x86-64 only, runtime dispatch)
+#if defined(__x86_64__) || defined(_M_X64)
+#define ORDER_CACHE_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SIMD_TARGET(isa)
+#else
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+
+namespace {
+	/// <summary>
+	/// Appends the order to the membership index (stores its position on the order) - O(1)
+	/// </summary>
+	inline void addMember(order_list& members, order_ptr& ptr, uint32_t Order::* slot) {
+		(*ptr).*slot = (uint32_t)members.size();
+		members.push_back(ptr);
+	}
+
+	/// <summary>
+	/// Removes the order from the membership index - O(1) (the last order takes its position)
+	/// </summary>
+	template <typename Index>
+	inline void removeMember(Index& index, const std::string& key, order_ptr& ptr, uint32_t Order::* slot) {
+		auto it = index.find(key);
+		if (it == index.end())
+			return;
+
+		// remark: the members may have been moved out (mass cancels)
+		order_list& members = it->second;
+		const uint32_t position = (*ptr).*slot;
+		if (position >= members.size() || members[position] != ptr)
+			return;
+
+		members[position] = members.back();
+		(*members[position]).*slot = position;
+		members.pop_back();
+	}
+
+	/// <summary>
+	/// Adds the lots to the ring bucket of the interval (resets the bucket of an older interval)
+	/// </summary>
+	template <typename Ring>
+	inline void addVolume(Ring& ring, uint64_t index, uint64_t qty) {
+		auto& bucket = ring[index % ring.size()];
+		if (bucket.index != index) {
+			bucket.index = index;
+			bucket.volume = 0;
+		}
+		bucket.volume += qty;
+	}
+
+	/// <summary>
+	/// Gets the running aggregates of the key (user or company), created with its securities lots 
+	/// tracked by the same counter of the aggregates map
+	/// </summary>
+	template <typename Map>
+	inline RiskExposure& exposure(Map& exposures, const std::string& key) {
+		auto it = exposures.find(key);
+		if (it == exposures.end()) {
+			RiskExposure::security_lots lots(RiskExposure::security_lots::allocator_type(exposures.get_allocator().counter()));
+			it = exposures.emplace(key, RiskExposure{ 0, 0, std::move(lots) }).first;
+		}
+		return it->second;
+	}
+
+	/// <summary>
+	/// Gets the list of the orders waiting for matching on the security, created tracked by the 
+	/// same counter of the pending matches map
+	/// </summary>
+	template <typename Map>
+	inline typename Map::mapped_type& pendingList(Map& pending, const std::string& securityId) {
+		auto it = pending.find(securityId);
+		if (it == pending.end())
+			it = pending.emplace(securityId, typename Map::mapped_type(
+				typename Map::mapped_type::allocator_type(pending.get_allocator().counter()))).first;
+		return it->second;
+	}
+
+	/// <summary>
+	/// Gets the matched volume series of the security, created with its rings tracked by the same 
+	/// counter of the series map
+	/// </summary>
+	template <typename Map>
+	inline typename Map::mapped_type& matchedSeries(Map& series, const std::string& securityId) {
+		auto it = series.find(securityId);
+		if (it == series.end()) {
+			typedef typename Map::mapped_type::volume_ring volume_ring;
+			const typename volume_ring::allocator_type allocator(series.get_allocator().counter());
+			it = series.emplace(securityId, typename Map::mapped_type{ 
+				volume_ring(VOLUME_SECOND_BUCKETS, allocator), volume_ring(VOLUME_MINUTE_BUCKETS, allocator) }).first;
+		}
+		return it->second;
+	}
+
+	/// <summary>
+	/// Copies the running aggregates out of the cache (untracked securities lots)
+	/// </summary>
+	inline RiskExposure detachExposure(const RiskExposure& exposure) {
+		RiskExposure copy;
+		copy.buy = exposure.buy;
+		copy.sell = exposure.sell;
+		copy.securities.insert(exposure.securities.cbegin(), exposure.securities.cend());
+		return copy;
+	}
+
+	/// <summary>
+	/// Gets the timing wheel tick of the expiry time, i.e. the first tick at or after it
+	/// </summary>
+	inline uint64_t expiryTick(const uint64_t& expiry) {
+		return expiry / EXPIRY_TICK_US + (expiry % EXPIRY_TICK_US ? 1 : 0);
+	}
+
+
+	/// <summary>
+	/// Counterparty fill found by the matching kernels (side book position and lots)
+	/// </summary>
+	struct side_fill {
+		uint32_t position;
+		uint32_t qty;
+	};
+
+	/// <summary>
+	/// Matching kernel: fills (in arrival order) the counterparties with working lots from other companies, 
+	/// updating the working lots array and returning the total matched lots
+	/// </summary>
+	typedef uint32_t(*match_kernel)(uint32_t* working, const uint32_t* companies, size_t first, size_t n, 
+		uint32_t company, uint32_t quantity, side_fill* fills, size_t& count);
+
+	/// <summary>
+	/// Scalar matching kernel (fallback and blocks tails)
+	/// </summary>
+	uint32_t scalarKernel(uint32_t* working, const uint32_t* companies, size_t first, size_t n,
+		uint32_t company, uint32_t quantity, side_fill* fills, size_t& count) {
+
+		uint32_t matched = 0;
+		for (size_t i = first; i < n && quantity; i++) {
+			if (!working[i] || companies[i] == company)
+				continue;
+			const uint32_t qty = std::min(quantity, working[i]);
+			working[i] -= qty;
+			quantity -= qty;
+			matched += qty;
+			fills[count++] = { (uint32_t)i, qty };
+		}
+		return matched;
+	}
+
+	/// <summary>
+	/// Filter kernel: stores the positions of the quantities with at least "minQty" lots (compress), 
+	/// returning the number of positions
+	/// </summary>
+	typedef size_t(*filter_kernel)(const uint32_t* quantities, size_t first, size_t n, uint32_t minQty, uint32_t* positions);
+
+	/// <summary>
+	/// Scalar filter kernel (fallback and blocks tails)
+	/// </summary>
+	size_t scalarFilter(const uint32_t* quantities, size_t first, size_t n, uint32_t minQty, uint32_t* positions) {
+		size_t count = 0;
+		for (size_t i = first; i < n; i++) {
+			positions[count] = (uint32_t)i;
+			count += quantities[i] >= minQty; // branchless
+		}
+		return count;
+	}
+
+#ifdef ORDER_CACHE_SIMD
+	inline unsigned lowestBit(unsigned mask) {
+		#if defined(_MSC_VER) && !defined(__clang__)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return (unsigned)index;
+		#else
+		return (unsigned)__builtin_ctz(mask);
+		#endif
+	}
+
+	inline unsigned bitCount(unsigned mask) {
+		#if defined(_MSC_VER) && !defined(__clang__)
+		return (unsigned)__popcnt(mask);
+		#else
+		return (unsigned)__builtin_popcount(mask);
+		#endif
+	}
+
+	/// <summary>
+	/// Fills the eligible counterparties of a block (bit mask) until the quantity is exhausted
+	/// </summary>
+	inline uint32_t fillBlock(uint32_t* working, size_t base, unsigned mask, uint32_t quantity, side_fill* fills, size_t& count) {
+		uint32_t matched = 0;
+		for (; mask && quantity; mask &= mask - 1) {
+			const size_t i = base + lowestBit(mask);
+			const uint32_t qty = std::min(quantity, working[i]);
+			working[i] -= qty;
+			quantity -= qty;
+			matched += qty;
+			fills[count++] = { (uint32_t)i, qty };
+		}
+		return matched;
+	}
+
+	/// <summary>
+	/// AVX2 matching kernel: 8 counterparties per block, blocks entirely consumed (eligible lots 
+	/// not greater than the remaining quantity) are filled at once, the last one serially
+	/// </summary>
+	SIMD_TARGET("avx2")
+	uint32_t avx2Kernel(uint32_t* working, const uint32_t* companies, size_t first, size_t n,
+		uint32_t company, uint32_t quantity, side_fill* fills, size_t& count) {
+
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i self = _mm256_set1_epi32((int)company);
+		uint32_t matched = 0;
+		size_t i = first;
+
+		for (; i + 8 <= n && quantity; i += 8) {
+			const __m256i lots = _mm256_loadu_si256((const __m256i*)(working + i));
+			const __m256i owners = _mm256_loadu_si256((const __m256i*)(companies + i));
+			const __m256i skip = _mm256_or_si256(_mm256_cmpeq_epi32(lots, zero), _mm256_cmpeq_epi32(owners, self));
+			const unsigned mask = ~(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(skip)) & 0xFFu;
+			if (!mask)
+				continue;
+
+			// eligible lots of the block (64 bits sum)
+			const __m256i eligible = _mm256_andnot_si256(skip, lots);
+			const __m256i sum4 = _mm256_add_epi64(
+				_mm256_cvtepu32_epi64(_mm256_castsi256_si128(eligible)),
+				_mm256_cvtepu32_epi64(_mm256_extracti128_si256(eligible, 1)));
+			const __m128i sum2 = _mm_add_epi64(_mm256_castsi256_si128(sum4), _mm256_extracti128_si256(sum4, 1));
+			const uint64_t total = (uint64_t)_mm_cvtsi128_si64(sum2) + (uint64_t)_mm_extract_epi64(sum2, 1);
+
+			if (total > quantity) {
+				matched += fillBlock(working, i, mask, quantity, fills, count);
+				return matched;
+			}
+
+			for (unsigned m = mask; m; m &= m - 1) {
+				const size_t position = i + lowestBit(m);
+				fills[count++] = { (uint32_t)position, working[position] };
+			}
+			_mm256_storeu_si256((__m256i*)(working + i), _mm256_and_si256(skip, lots));
+			quantity -= (uint32_t)total;
+			matched += (uint32_t)total;
+		}
+
+		return matched + (quantity ? scalarKernel(working, companies, i, n, company, quantity, fills, count) : 0);
+	}
+
+	/// <summary>
+	/// AVX-512 matching kernel: 16 counterparties per block (see "avx2Kernel()")
+	/// </summary>
+	SIMD_TARGET("avx512f")
+	uint32_t avx512Kernel(uint32_t* working, const uint32_t* companies, size_t first, size_t n,
+		uint32_t company, uint32_t quantity, side_fill* fills, size_t& count) {
+
+		const __m512i self = _mm512_set1_epi32((int)company);
+		uint32_t matched = 0;
+		size_t i = first;
+
+		for (; i + 16 <= n && quantity; i += 16) {
+			const __m512i lots = _mm512_loadu_si512((const void*)(working + i));
+			const __m512i owners = _mm512_loadu_si512((const void*)(companies + i));
+			const __mmask16 mask = _mm512_test_epi32_mask(lots, lots) & _mm512_cmpneq_epu32_mask(owners, self);
+			if (!mask)
+				continue;
+
+			// eligible lots of the block (64 bits sum)
+			// remark: zero masked forms (the unmasked ones read an undefined source, i.e. -Wmaybe-uninitialized on GCC)
+			const __m512i eligible = _mm512_maskz_mov_epi32(mask, lots);
+			const __m512i sum8 = _mm512_add_epi64(
+				_mm512_maskz_cvtepu32_epi64(0xFF, _mm512_maskz_extracti64x4_epi64(0xFF, eligible, 0)),
+				_mm512_maskz_cvtepu32_epi64(0xFF, _mm512_maskz_extracti64x4_epi64(0xFF, eligible, 1)));
+			const __m256i sum4 = _mm256_add_epi64(_mm512_maskz_extracti64x4_epi64(0xFF, sum8, 0), _mm512_maskz_extracti64x4_epi64(0xFF, sum8, 1));
+			const __m128i sum2 = _mm_add_epi64(_mm256_castsi256_si128(sum4), _mm256_extracti128_si256(sum4, 1));
+			const uint64_t total = (uint64_t)_mm_cvtsi128_si64(sum2) + (uint64_t)_mm_extract_epi64(sum2, 1);
+
+			if (total > quantity) {
+				matched += fillBlock(working, i, mask, quantity, fills, count);
+				return matched;
+			}
+
+			for (unsigned m = mask; m; m &= m - 1) {
+				const size_t position = i + lowestBit(m);
+				fills[count++] = { (uint32_t)position, working[position] };
+			}
+			_mm512_mask_storeu_epi32((void*)(working + i), mask, _mm512_setzero_si512());
+			quantity -= (uint32_t)total;
+			matched += (uint32_t)total;
+		}
+
+		return matched + (quantity ? scalarKernel(working, companies, i, n, company, quantity, fills, count) : 0);
+	}
+
+	/// <summary>
+	/// AVX2 filter kernel: compares 8 quantities per instruction (unsigned "max(q, min) == q")
+	/// </summary>
+	SIMD_TARGET("avx2")
+	size_t avx2Filter(const uint32_t* quantities, size_t first, size_t n, uint32_t minQty, uint32_t* positions) {
+		const __m256i minimum = _mm256_set1_epi32((int)minQty);
+		size_t count = 0;
+		size_t i = first;
+
+		for (; i + 8 <= n; i += 8) {
+			const __m256i lots = _mm256_loadu_si256((const __m256i*)(quantities + i));
+			const __m256i selected = _mm256_cmpeq_epi32(_mm256_max_epu32(lots, minimum), lots);
+			for (unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(selected)); mask; mask &= mask - 1)
+				positions[count++] = (uint32_t)(i + lowestBit(mask));
+		}
+
+		return count + scalarFilter(quantities, i, n, minQty, positions + count);
+	}
+
+	/// <summary>
+	/// AVX-512 filter kernel: compares 16 quantities per instruction and compresses the selected positions
+	/// </summary>
+	SIMD_TARGET("avx512f")
+	size_t avx512Filter(const uint32_t* quantities, size_t first, size_t n, uint32_t minQty, uint32_t* positions) {
+		const __m512i minimum = _mm512_set1_epi32((int)minQty);
+		const __m512i step = _mm512_set1_epi32(16);
+		__m512i index = _mm512_add_epi32(_mm512_set1_epi32((int)first),
+			_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+		size_t count = 0;
+		size_t i = first;
+
+		for (; i + 16 <= n; i += 16) {
+			const __mmask16 mask = _mm512_cmpge_epu32_mask(_mm512_loadu_si512((const void*)(quantities + i)), minimum);
+			_mm512_mask_compressstoreu_epi32((void*)(positions + count), mask, index);
+			count += bitCount((unsigned)mask);
+			index = _mm512_add_epi32(index, step);
+		}
+
+		return count + scalarFilter(quantities, i, n, minQty, positions + count);
+	}
+#endif // ORDER_CACHE_SIMD
+
+	/// <summary>
+	/// Matching and filter kernels of an instruction set
+	/// </summary>
+	struct kernel_dispatch {
+		match_kernel kernel = scalarKernel;
+		filter_kernel filter = scalarFilter;
+		const char* name = "scalar";
+	};
+
+	/// <summary>
+	/// Vectorized instruction sets supported by the current CPU
+	/// </summary>
+	struct cpu_support {
+		bool avx2 = false;
+		bool avx512 = false;
+
+		cpu_support() {
+			#ifdef ORDER_CACHE_SIMD
+			#if defined(_MSC_VER) && !defined(__clang__)
+			int info[4];
+			__cpuid(info, 1);
+			const bool osxsave = (info[2] & (1 << 27)) != 0;
+			const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+			__cpuidex(info, 7, 0);
+			avx2 = (xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)) != 0;
+			avx512 = (xcr0 & 0xE6) == 0xE6 && (info[1] & (1 << 16)) != 0;
+			#else
+			__builtin_cpu_init();
+			avx2 = __builtin_cpu_supports("avx2");
+			avx512 = __builtin_cpu_supports("avx512f");
+			#endif
+			#endif // ORDER_CACHE_SIMD
+		}
+	};
+
+	/// <summary>
+	/// Finds the kernels by name ("avx512", "avx2" or "scalar"), nullptr if unknown or not supported by the current CPU
+	/// </summary>
+	inline const kernel_dispatch* findDispatch(const std::string& name) {
+		static const kernel_dispatch scalar;
+		if (name == scalar.name)
+			return &scalar;
+
+		#ifdef ORDER_CACHE_SIMD
+		static const cpu_support support;
+		static const kernel_dispatch avx2{ avx2Kernel, avx2Filter, "avx2" };
+		static const kernel_dispatch avx512{ avx512Kernel, avx512Filter, "avx512" };
+		if (name == avx2.name && support.avx2)
+			return &avx2;
+		if (name == avx512.name && support.avx512)
+			return &avx512;
+		#endif // ORDER_CACHE_SIMD
+		return nullptr;
+	}
+
+	/// <summary>
+	/// Selected kernels (default: the widest instruction set supported by the current CPU)
+	/// </summary>
+	inline std::atomic<const kernel_dispatch*>& selectedDispatch() {
+		static std::atomic<const kernel_dispatch*> selected{ [] {
+			for (const char* name : { "avx512", "avx2" })
+				if (const kernel_dispatch* dispatch = findDispatch(name))
+					return dispatch;
+			return findDispatch("scalar");
+		}() };
+		return selected;
+	}
+
+	inline const kernel_dispatch& matchingDispatch() {
+		return *selectedDispatch().load(std::memory_order_relaxed);
+	}
+}
+
+
+/// <summary>
+/// Initializes a new instance of the <see cref="OrderCache"/> class.
+/// </summary>
+OrderCache::OrderCache() :
+	_orders(order_storage::allocator_type(&_ordersMemory)),
+	_orderIndex(decltype(_orderIndex)::allocator_type(&_orderIndexMemory)),
+	_numericOrderIndex(&_numericOrderIndexMemory),
+	_userOrdersIndex(order_index_map::allocator_type(&_userOrdersIndexMemory)),
+	_companyOrdersIndex(order_index_map::allocator_type(&_companyOrdersIndexMemory)),
+	_sessionOrdersIndex(order_index_map::allocator_type(&_sessionOrdersIndexMemory)),
+	_securityOrdersIndex(order_index_map::allocator_type(&_securityOrdersIndexMemory)),
+	_securityQuantities(order_qty_array_map::allocator_type(&_securityQuantitiesMemory)),
+	_companyKeys(decltype(_companyKeys)::allocator_type(&_companyKeysMemory)),
+	_userExposures(decltype(_userExposures)::allocator_type(&_riskExposuresMemory)),
+	_companyExposures(decltype(_companyExposures)::allocator_type(&_riskExposuresMemory)),
+	_pendingMatches(decltype(_pendingMatches)::allocator_type(&_pendingMatchesMemory)),
+	_matchingStats(decltype(_matchingStats)::allocator_type(&_matchingStatsMemory)),
+	_expiryWheel((EXPIRY_WHEEL_LEVELS << EXPIRY_WHEEL_BITS) + 2, decltype(_expiryWheel)::allocator_type(&_expiryWheelMemory)),
+	_matchedVolume(decltype(_matchedVolume)::allocator_type(&_matchedVolumeMemory)),
+	_changeLog(decltype(_changeLog)::allocator_type(&_changeLogMemory)),
+	_securityLongOrdersIndex(order_match_index::allocator_type(&_longOrdersIndexMemory)),
+	_securityShortOrdersIndex(order_match_index::allocator_type(&_shortOrdersIndexMemory)),
+	_matchedQuantity(decltype(_matchedQuantity)::allocator_type(&_matchedQuantityMemory)),
+	_securityFills(decltype(_securityFills)::allocator_type(&_orderMatchesMemory)),
+	_fillSecurityKeys(decltype(_fillSecurityKeys)::allocator_type(&_orderMatchesMemory)),
+	_orderMatches(order_match_storage::allocator_type(&_orderMatchesMemory)),
+	_tombstones(decltype(_tombstones)::allocator_type(&_tombstonesMemory)) {
+}
+
+
+/// <summary>
+/// Finalizes an instance of the <see cref="OrderCache"/> class (stops the background reclamation, if any).
+/// </summary>
+OrderCache::~OrderCache() {
+	_deferredDeletion = false;
+	if (_reclaimer.joinable())
+		_reclaimer.join();
+}
+
+
+/// <summary>
+/// Sets the deferred deletion mode (tombstones + batched background reclamation).
+/// </summary>
+/// <param name="value">The value.</param>
+void OrderCache::setDeferredDeletion(const bool& value) {
+	if (_deferredDeletion.exchange(value) == value)
+		return;
+
+	if (value) {
+		// background reclamation passes (bounded, the write lock is released between passes)
+		_reclaimer = std::thread([this]() {
+			while (_deferredDeletion.load(std::memory_order_relaxed)) {
+				std::this_thread::sleep_for(std::chrono::microseconds(RECLAIM_INTERVAL_US));
+				while (pendingReclaims() && reclaimOrders() == RECLAIM_BATCH_SIZE)
+					std::this_thread::yield();
+			}
+		});
+	}
+	else {
+		if (_reclaimer.joinable())
+			_reclaimer.join();
+		// remark: orders pinned by readers stay tombstoned (see "reclaimOrders()")
+		while (reclaimOrders() == RECLAIM_BATCH_SIZE);
+	}
+}
+
+
+/// <summary>
+/// Unlinks and releases the oldest cancelled orders not reachable by pinned readers, up to 
+/// RECLAIM_BATCH_SIZE orders (deferred deletion mode).
+/// Remark: O(n + k) - k <= RECLAIM_BATCH_SIZE, one compaction pass per affected side index
+/// </summary>
+/// <returns>the number of reclaimed orders</returns>
+size_t OrderCache::reclaimOrders() {
+
+	write_lock lock = lockForUpdateOrders();
+
+	if (_tombstones.empty())
+		return 0;
+
+	// new readers pin the next epoch: orders retired before the oldest pinned epoch are unreachable
+	_epochs.advance();
+	const uint64_t safe = _epochs.safe();
+
+	// remark: the tombstones are in retirement (epoch) order, i.e. the unreachable ones come first
+	thread_local std::vector<order_ptr> victims;
+	victims.clear();
+	while (!_tombstones.empty() && _tombstones.front().second < safe && victims.size() < RECLAIM_BATCH_SIZE) {
+		victims.push_back(_tombstones.front().first);
+		_tombstones.pop_front();
+	}
+
+	// the indexes removals left by the cancels, then the compaction
+	for (order_ptr& ptr : victims)
+		removeMembers(ptr);
+	unlinkOrders(victims);
+
+	return victims.size();
+}
+
+
+/// <summary>
+/// Gets the number of cancelled orders waiting for reclamation (deferred deletion mode).
+/// </summary>
+/// <returns></returns>
+size_t OrderCache::pendingReclaims() const {
+	read_lock lock = lockForReadOrders();
+	return _tombstones.size();
+}
 
 
 /// <summary>
 /// Adds the order into current order cache.
-/// Remark: O(1)
+/// Remark: O(1) amortized (hash inserts and array appends), plus O(counterparties) matching at add
 /// </summary>
 /// <param name="order">The order.</param>
 void OrderCache::addOrder(Order order) {
 
+	const RiskReject reject = addOrderChecked(std::move(order));
+
+	#ifdef THROW_EXCEPTIONS
+	if (reject == RiskReject::DuplicateOrder)
+		throw std::invalid_argument("error adding order: duplicated order id");
+	if (reject != RiskReject::None)
+		throw std::range_error("error adding order: risk limit exceeded");
+	#else
+	(void)reject;
+	#endif // THROW_EXCEPTIONS
+}
+
+
+/// <summary>
+/// Adds the order into current order cache, checking the pre-trade risk limits first.
+/// Remark: O(1) amortized (hash inserts and array appends), plus O(counterparties) matching at add
+/// </summary>
+/// <param name="order">The order.</param>
+/// <returns>the reject reason, RiskReject::None if added</returns>
+RiskReject OrderCache::addOrderChecked(Order order) {
+
 	// thread-safe lock (writting data)
 	write_lock lock = lockForUpdateOrders();
 
@@ -127,31 +687,27 @@ void OrderCache::addOrder(Order order) {
 	#endif // _DEBUG
 		
 	// parameters validation: checks for duplicated orders 
-	if (exists(order.orderId())) {
-		#ifdef THROW_EXCEPTIONS
-		throw std::invalid_argument("error adding order: duplicated order id");
-		#else
-		return;
-		#endif // THROW_EXCEPTIONS
-	}
-	
-	// stores the order (remark: uses 'std::move' for not coping the Order instance)
-	_orders.push_front(std::move(order));
+	if (exists(order.orderId()))
+		return RiskReject::DuplicateOrder;
 
-	// gets the order interator/pointer
-	order_ptr ptr = _orders.begin();
+	// pre-trade risk checks (running aggregates - O(1)), before any index insertion
+	if (_riskChecks) {
+		const RiskReject reject = checkRisk(order, order.workingQty());
+		if (reject != RiskReject::None) {
+			#ifdef _DEBUG
+			if (_verbose)
+				out << "order rejected (risk limit: " << (int)reject << "): " << order.str() << '\n';
+			#endif // _DEBUG
+			return reject;
+		}
+	}
 	
-	// stores the indexes for fast access - O(1)
-	_orderIndex.insert({ ptr->orderId(), ptr}); // index by order ID  (orderId => order ptr [1:1])		
-	_userOrdersIndex[ptr->user()].insert(ptr->orderId()); // index by user (user => orderId [1:n])
-	_securityOrdersIndex[ptr->securityId()].insert(ptr->orderId()); // index by security (securityId => orderId [1:n])
+	// stores the order and its indexes
+	order_ptr ptr = insertOrder(std::move(order));
 
-	// stores indexes specialized for matching algorithim (critical path - O(1))	
-	order_list& matchIndex = isBuySide(ptr) ? 
-		_securityLongOrdersIndex[ptr->securityId()] : 
-		_securityShortOrdersIndex[ptr->securityId()];
-	
-	matchIndex.push_back(ptr);
+	// replicates the order as added (i.e. before matching)
+	if (_replica)
+		publish(OrderMutation{ MutationType::AddOrder, ptr->clone() });
 		
 	#ifdef _DEBUG
 	if (_verbose) {
@@ -160,17 +716,72 @@ void OrderCache::addOrder(Order order) {
 	}
 	#endif // _DEBUG
 
-	#ifdef USE_CACHED_MATCHING_AT_ADD_ORDER		
-	//
-	// does order matching (order filling) 
-	// as the orders are inserted (and cache matched values)
-	//	
-	matchOrderInCache(ptr, false);	
-	#endif
+	// does order matching (order filling) as the orders are inserted (and cache matched values), 
+	// or marks the security dirty (lazy matching)
+	matchAdded(ptr);
 
 	#ifdef SHOW_EXECUTION_TIMES
 	TestUtils::toc(start, "adding order execution time: ");
 	#endif
+
+	return RiskReject::None;
+}
+
+
+/// <summary>
+/// Stores the order and its indexes, without matching (without locks - thread unsafe).
+/// Remark: O(1) amortized (hash inserts and array appends, no ordered index)
+/// </summary>
+/// <param name="order">The order.</param>
+/// <returns>the stored order pointer</returns>
+order_ptr OrderCache::insertOrder(Order&& order) {
+
+	// copies of orders stored by a cache carry its bookkeeping (e.g. from "getAllOrders()")
+	order.resetCacheState();
+
+	// stores the order (remark: uses 'std::move' for not coping the Order instance)
+	_orders.push_front(std::move(order));
+
+	// gets the order interator/pointer
+	order_ptr ptr = _orders.begin();
+	
+	// stores the indexes for fast access - O(1)
+	// index by order ID  (orderId => order ptr [1:1]): numeric identifiers without hashing, if enabled
+	uint64_t numericId;
+	if (!_numericOrderIds || !utils::parseId(ptr->orderId(), numericId) || !_numericOrderIndex.insert(numericId, ptr))
+		_orderIndex.insert({ ptr->orderId(), ptr});
+	addMember(_userOrdersIndex[ptr->user()], ptr, &Order::m_userSlot); // index by user (user => order ptr [1:n])
+	addMember(_companyOrdersIndex[ptr->company()], ptr, &Order::m_companySlot); // index by company (company => order ptr [1:n])
+	if (!ptr->session().empty())
+		addMember(_sessionOrdersIndex[ptr->session()], ptr, &Order::m_sessionSlot); // index by session (session => order ptr [1:n])
+	addMember(_securityOrdersIndex[ptr->securityId()], ptr, &Order::m_securitySlot); // index by security (securityId => order ptr [1:n])
+	_securityQuantities[ptr->securityId()].push_back(ptr->qty()); // security quantities (same positions)
+
+	// interns the company (side book company arrays)
+	ptr->m_companyKey = _companyKeys.emplace(ptr->company(), (uint32_t)_companyKeys.size()).first->second;
+
+	// stores indexes specialized for matching algorithim (critical path - O(1))	
+	ptr->m_arrival = ++_arrivals;
+	pushSide(sideBook(ptr), ptr);
+
+	// good-till-date / good-for-day orders (timing wheel - O(1))
+	scheduleExpiry(ptr);
+
+	// change data capture
+	recordChange(*ptr);
+
+	// user and company running aggregates (risk checks)
+	if (_riskChecks) {
+		RiskExposure& user = exposure(_userExposures, ptr->user());
+		RiskExposure& company = exposure(_companyExposures, ptr->company());
+		ptr->m_userRisk = &user;
+		ptr->m_companyRisk = &company;
+		ptr->m_userSecurityRisk = &user.securities[ptr->securityId()];
+		ptr->m_companySecurityRisk = &company.securities[ptr->securityId()];
+		addExposure(*ptr, ptr->workingQty());
+	}
+
+	return ptr;
 }
 
 
@@ -188,8 +799,18 @@ void OrderCache::cancelOrder(const std::string& orderId) {
 	// thread-safe lock (writting data)
 	write_lock lock = lockForUpdateOrders();
 
+	// lazy matching: the pending orders are matched before the book changes
+	if (_pendingCount) {
+		const order_ptr* found = findOrder(orderId);
+		if (found)
+			settle((*found)->securityId());
+	}
+
 	cancelSingleOrder(orderId, false);	
 
+	if (_replica)
+		publish(OrderMutation{ MutationType::CancelOrder, std::nullopt, orderId });
+
 	#ifdef SHOW_EXECUTION_TIMES
 	TestUtils::toc(start, "cancel order execution time: ");
 	#endif
@@ -230,19 +851,30 @@ void OrderCache::cancelOrdersForUser(const std::string& user) {
 		#endif 
 	}
 
-	// gets all orders from user with O(1)
-	orders_keys ordersKeys = _userOrdersIndex[user];
+	// gets all orders from user with O(1) (moved, not copied) and removes them in bulk
+	order_list& index = _userOrdersIndex[user];
+	order_list orders = std::move(index);
+	index.clear();
+
+	// lazy matching: the pending orders of the affected securities are matched before the books change
+	settleOrders(orders);
 
 	#ifdef _DEBUG
 	if (_verbose) {
 		out << " - Users orders:\n";
-		for (auto& orderId : ordersKeys)
-			out << "   " << orderId << '\n';
+		for (auto& order : orders)
+			out << "   " << order->orderId() << '\n';
 		out.flush();
 	}
 	#endif // _DEBUG
 
-	cancelOrders(ordersKeys, 0);
+	cancelOrders(orders, 0);
+
+	// releases the user index entry
+	_userOrdersIndex.erase(user);
+
+	if (_replica)
+		publish(OrderMutation{ MutationType::CancelOrdersForUser, std::nullopt, user });
 
 	#ifdef SHOW_EXECUTION_TIMES
 	TestUtils::toc(start, "cancel all orders from user execution time: ");
@@ -251,98 +883,360 @@ void OrderCache::cancelOrdersForUser(const std::string& user) {
 
 
 /// <summary>
-/// Cancels the orders for sec identifier with minimum quantity of lots (thread-safe).
+/// Cancels the orders for the specified company (thread-safe), i.e. firm "kill switch".
+/// Remark: single bulk operation (one lock, one compaction pass per affected side index)
 /// </summary>
-/// <param name="securityId">The security identifier.</param>
-/// <param name="minQty">The minimum size to cancel the order.</param>
-void OrderCache::cancelOrdersForSecIdWithMinimumQty(const std::string& securityId, unsigned int minQty) {
-	
+/// <param name="company">The company.</param>
+void OrderCache::cancelOrdersForCompany(const std::string& company) {
+
 	// thread-safe lock (writting data)
 	write_lock lock = lockForUpdateOrders();
 
-	#if defined(SHOW_EXECUTION_TIMES)	
-	auto start = TestUtils::tic();	
+	#ifdef SHOW_EXECUTION_TIMES
+	auto start = debug::TestUtils::tic();
 	#endif
 
 	#ifdef _DEBUG
 	utils::osyncstream out;
-
-	if (_verbose) {
-		out << "\nCanceling all orders by security: '" << securityId << "' ";
-		if (minQty > 0)
-			out << "[min: " << minQty << "] ";
-		out << "[OrderCache::cancelOrdersForSecIdWithMinimumQty()]\n";
-	}
+	if (_verbose)
+		out << "\nCanceling all orders by company: '" << company << "' [OrderCache::cancelOrdersForCompany()]\n";
 	#endif // _DEBUG
 
-	// parameters validation: checks for nonexistent security
-	if (!_securityOrdersIndex.count(securityId)) {
-		#ifdef _DEBUG
-		if (_verbose)
-			out << "\nNo orders for security: '" << securityId << "'\n";
-		#endif // _DEBUG
-
+	// parameters validation: checks for nonexistent company
+	auto index = _companyOrdersIndex.find(company);
+	if (index == _companyOrdersIndex.end()) {
 		#ifdef THROW_EXCEPTIONS
-		throw std::range_error("error cancelling order for security: security id not found");
-		#else
+		throw std::range_error("error cancelling order for company: company not found!");
+		#else		
 		return;
-		#endif
-	}
-	
-	// gets all orders from security with O(1)
-	orders_keys ordersKeys = _securityOrdersIndex[securityId];
-	
-	#ifdef _DEBUG
-	if (_verbose) {
-		out << " - Security orders:\n";
-		for (auto& orderId : ordersKeys)
-			out << "   " << orderId << '\n';
-		out.flush();
+		#endif 
 	}
-	#endif // _DEBUG
 
-	cancelOrders(ordersKeys, minQty);
-	
+	// gets all orders from company with O(1) (moved, not copied) and removes them in bulk
+	order_list orders = std::move(index->second);
+	index->second.clear();
+
+	// lazy matching: the pending orders of the affected securities are matched before the books change
+	settleOrders(orders);
+	cancelOrders(orders, 0);
+
+	// releases the company index entry
+	_companyOrdersIndex.erase(company);
+
+	if (_replica)
+		publish(OrderMutation{ MutationType::CancelOrdersForCompany, std::nullopt, company });
+
 	#ifdef SHOW_EXECUTION_TIMES
-	TestUtils::toc(start, "cancel all orders from security execution time: ");
+	debug::TestUtils::toc(start, "cancel all orders from company execution time: ");
 	#endif
 }
 
 
 /// <summary>
-/// Gets the matching size for security.
-/// Remark: O(1)
+/// Cancels the orders entered by the specified client session (thread-safe), i.e. cancel on disconnect.
+/// Remark: single bulk operation (one lock, one compaction pass per affected side index)
 /// </summary>
-/// <param name="securityId">The security identifier.</param>
-/// <returns></returns>
-unsigned int OrderCache::getMatchingSizeForSecurity(const std::string& securityId) {
+/// <param name="session">The session identifier.</param>
+void OrderCache::cancelOrdersForSession(const std::string& session) {
 
-	// thread-safe lock (reading data)
-	read_lock lock = lockForReadOrders();
+	// thread-safe lock (writting data)
+	write_lock lock = lockForUpdateOrders();
 
-	#if defined(_DEBUG) || defined(SHOW_EXECUTION_TIMES)
+	#ifdef SHOW_EXECUTION_TIMES
 	auto start = debug::TestUtils::tic();
-	utils::osyncstream out;
 	#endif
 
-	// parameters validation: checks for nonexistent security
-	if (!_securityOrdersIndex.count(securityId)) {
-		#ifdef _DEBUG
-		if (_verbose)
-			out << "\nNo orders for securitu '" << securityId << "'\n";
-		#endif // _DEBUG
+	#ifdef _DEBUG
+	utils::osyncstream out;
+	if (_verbose)
+		out << "\nCanceling all orders by session: '" << session << "' [OrderCache::cancelOrdersForSession()]\n";
+	#endif // _DEBUG
 
+	// parameters validation: checks for nonexistent session
+	auto index = _sessionOrdersIndex.find(session);
+	if (index == _sessionOrdersIndex.end()) {
 		#ifdef THROW_EXCEPTIONS
-		throw std::range_error("error matching orders for security: security id not found");
-		#else
-		return 0;
-		#endif
+		throw std::range_error("error cancelling order for session: session not found!");
+		#else		
+		return;
+		#endif 
 	}
-	
-	int qty = 0;
 
-#ifndef USE_CACHED_MATCHING_AT_ADD_ORDER
-	//
+	// gets all orders from session with O(1) (moved, not copied) and removes them in bulk
+	order_list orders = std::move(index->second);
+	index->second.clear();
+
+	// lazy matching: the pending orders of the affected securities are matched before the books change
+	settleOrders(orders);
+	cancelOrders(orders, 0);
+
+	// releases the session index entry
+	_sessionOrdersIndex.erase(session);
+
+	if (_replica)
+		publish(OrderMutation{ MutationType::CancelOrdersForSession, std::nullopt, session });
+
+	#ifdef SHOW_EXECUTION_TIMES
+	debug::TestUtils::toc(start, "cancel all orders from session execution time: ");
+	#endif
+}
+
+
+/// <summary>
+/// Amends the order quantity in place (thread-safe), i.e. without cancel and re-add.
+/// Remark: O(1) reduce (O(n) on increase with "AmendPolicy::LosePriority", plus matching)
+/// </summary>
+/// <param name="orderId">The order identifier.</param>
+/// <param name="qty">The new order quantity.</param>
+void OrderCache::amendOrder(const std::string& orderId, unsigned int qty) {
+
+	const RiskReject reject = amendOrderChecked(orderId, qty);
+
+	#ifdef THROW_EXCEPTIONS
+	if (reject == RiskReject::UnknownOrder)
+		throw std::invalid_argument("error amending order: order id not found");
+	if (reject != RiskReject::None)
+		throw std::range_error("error amending order: risk limit exceeded");
+	#else
+	(void)reject;
+	#endif // THROW_EXCEPTIONS
+}
+
+
+/// <summary>
+/// Amends the order quantity in place (thread-safe), checking the pre-trade risk limits first on increases.
+/// Remark: O(1) reduce (O(n) on increase with "AmendPolicy::LosePriority", plus matching)
+/// </summary>
+/// <param name="orderId">The order identifier.</param>
+/// <param name="qty">The new order quantity.</param>
+/// <returns>the reject reason, RiskReject::None if amended</returns>
+RiskReject OrderCache::amendOrderChecked(const std::string& orderId, unsigned int qty) {
+
+	// thread-safe lock (writting data)
+	write_lock lock = lockForUpdateOrders();
+
+	#ifdef SHOW_EXECUTION_TIMES
+	auto start = debug::TestUtils::tic();
+	#endif
+
+	// parameters validation: checks for nonexistent orders
+	const order_ptr* found = findOrder(orderId);
+	if (!found)
+		return RiskReject::UnknownOrder;
+
+	order_ptr ptr = *found;
+	const AmendPolicy policy = _amendPolicy;
+
+	// lazy matching: the pending orders are matched before the book changes (filled lots)
+	settle(ptr->securityId());
+
+	#ifdef _DEBUG
+	utils::osyncstream out;
+	if (_verbose)
+		out << "amending order '" << orderId << "' quantity: " << ptr->qty() << " => " << qty << " [OrderCache::amendOrder()]\n";
+	#endif // _DEBUG
+
+	// pre-trade risk checks on the additional lots (running aggregates - O(1)), before the book changes
+	if (_riskChecks && qty > ptr->qty()) {
+		const RiskReject reject = checkRisk(*ptr, qty - ptr->qty());
+		if (reject != RiskReject::None) {
+			#ifdef _DEBUG
+			if (_verbose)
+				out << "amend rejected (risk limit: " << (int)reject << "): " << ptr->str() << '\n';
+			#endif // _DEBUG
+			return reject;
+		}
+	}
+
+	if (qty == 0) {
+		cancelSingleOrder(orderId, 0, false);
+	}
+	else if (qty != ptr->qty()) {
+		// filled lots cannot be undone
+		const unsigned int filled = ptr->filledQty();
+		if (qty < filled)
+			qty = filled;
+
+		const bool increase = qty > ptr->qty();
+
+		addExposure(*ptr, (int64_t)(qty - filled) - (int64_t)ptr->workingQty());
+		ptr->m_qty = qty;
+		ptr->m_workingQty = qty - filled;
+		recordChange(*ptr);
+		_securityQuantities[ptr->securityId()][ptr->m_securitySlot] = qty;
+
+		side_book& book = sideBook(ptr);
+		if (increase && policy == AmendPolicy::LosePriority) {
+			// re-queued at the end of its side index (newest counterparty)
+			eraseSide(book, ptr);
+			ptr->m_arrival = ++_arrivals;
+			pushSide(book, ptr);
+		}
+		else
+			updateSide(book, ptr);
+
+		// matches the additional lots only (incremental matched quantity)
+		if (increase)
+			matchAdded(ptr);
+	}
+
+	if (_replica) {
+		OrderMutation mutation{ MutationType::AmendOrder, std::nullopt, orderId, qty };
+		mutation.policy = policy;
+		publish(std::move(mutation));
+	}
+
+	#ifdef SHOW_EXECUTION_TIMES
+	debug::TestUtils::toc(start, "amend order execution time: ");
+	#endif
+
+	return RiskReject::None;
+}
+
+
+/// <summary>
+/// Cancels the orders for sec identifier with minimum quantity of lots (thread-safe).
+/// </summary>
+/// <param name="securityId">The security identifier.</param>
+/// <param name="minQty">The minimum size to cancel the order.</param>
+void OrderCache::cancelOrdersForSecIdWithMinimumQty(const std::string& securityId, unsigned int minQty) {
+	
+	// thread-safe lock (writting data)
+	write_lock lock = lockForUpdateOrders();
+
+	#if defined(SHOW_EXECUTION_TIMES)	
+	auto start = TestUtils::tic();	
+	#endif
+
+	#ifdef _DEBUG
+	utils::osyncstream out;
+
+	if (_verbose) {
+		out << "\nCanceling all orders by security: '" << securityId << "' ";
+		if (minQty > 0)
+			out << "[min: " << minQty << "] ";
+		out << "[OrderCache::cancelOrdersForSecIdWithMinimumQty()]\n";
+	}
+	#endif // _DEBUG
+
+	// parameters validation: checks for nonexistent security
+	if (!_securityOrdersIndex.count(securityId)) {
+		#ifdef _DEBUG
+		if (_verbose)
+			out << "\nNo orders for security: '" << securityId << "'\n";
+		#endif // _DEBUG
+
+		#ifdef THROW_EXCEPTIONS
+		throw std::range_error("error cancelling order for security: security id not found");
+		#else
+		return;
+		#endif
+	}
+	
+	// lazy matching: the pending orders are matched before the book changes
+	settle(securityId);
+
+	// gets the orders from security with at least "minQty" lots: vectorized scan (compare and compress) 
+	// over the security quantities array with O(n) at memory bandwidth (no pointer chasing), writing 
+	// only the qualifying positions, i.e. selective cancels touch only the k matching orders
+	// remark: skips the cancelled orders (deferred deletion, see "cancelOrders()")
+	const order_list& members = _securityOrdersIndex[securityId];
+	const quantity_list& quantities = _securityQuantities[securityId];
+	// remark: reused buffer, grows only to the largest scanned security (no allocation per cancel)
+	thread_local std::vector<uint32_t> positions;
+	if (positions.size() < quantities.size())
+		positions.resize(quantities.size());
+	const size_t count = matchingDispatch().filter(quantities.data(), 0, quantities.size(), minQty, positions.data());
+
+	order_list orders;
+	orders.reserve(count);
+	for (size_t i = 0; i < count; i++)
+		orders.push_back(members[positions[i]]);
+	
+	#ifdef _DEBUG
+	if (_verbose) {
+		out << " - Security orders:\n";
+		for (auto& order : orders)
+			out << "   " << order->orderId() << '\n';
+		out.flush();
+	}
+	#endif // _DEBUG
+
+	// remark: minimum quantity already checked
+	cancelOrders(orders, 0);
+
+	if (_replica)
+		publish(OrderMutation{ MutationType::CancelOrdersForSecIdWithMinimumQty, std::nullopt, securityId, minQty });
+	
+	#ifdef SHOW_EXECUTION_TIMES
+	TestUtils::toc(start, "cancel all orders from security execution time: ");
+	#endif
+}
+
+
+/// <summary>
+/// Gets the matching size for security.
+/// Remark: O(1)
+/// </summary>
+/// <param name="securityId">The security identifier.</param>
+/// <returns></returns>
+unsigned int OrderCache::getMatchingSizeForSecurity(const std::string& securityId) {
+
+	if (_matchingMode != MatchingMode::Default) {
+		// accounts the query and checks for pending orders (reading data, i.e. concurrent queries)
+		bool dirty = false, adapt = false, untracked = false;
+		{
+			read_lock lock = lockForReadOrders();
+			auto matching = _matchingStats.find(securityId);
+			if (matching != _matchingStats.end())
+				adapt = queried(matching->second);
+			else
+				untracked = _securityOrdersIndex.count(securityId) > 0;
+			dirty = _pendingMatches.count(securityId) > 0;
+		}
+
+		// matches the orders added since the last query on the security or switches its strategy, 
+		// i.e. dirty securities only (writting data)
+		if (dirty || adapt || untracked) {
+			write_lock lock = lockForUpdateOrders();
+			if (untracked && _securityOrdersIndex.count(securityId))
+				adapt = queried(_matchingStats[securityId]);
+			if (adapt)
+				adaptStrategy(securityId, _matchingStats[securityId]);
+			settle(securityId);
+		}
+	}
+
+	// thread-safe lock (reading data)
+	read_lock lock = lockForReadOrders();
+
+	#if defined(_DEBUG) || defined(SHOW_EXECUTION_TIMES)
+	auto start = debug::TestUtils::tic();
+	utils::osyncstream out;
+	#endif
+
+	// parameters validation: checks for nonexistent security
+	if (!_securityOrdersIndex.count(securityId)) {
+		#ifdef _DEBUG
+		if (_verbose)
+			out << "\nNo orders for securitu '" << securityId << "'\n";
+		#endif // _DEBUG
+
+		#ifdef THROW_EXCEPTIONS
+		throw std::range_error("error matching orders for security: security id not found");
+		#else
+		return 0;
+		#endif
+	}
+	
+	int qty = 0;
+
+	// lazy / adaptive matching: values are already stored in cache (settled above)
+	if (_matchingMode != MatchingMode::Default)
+		return getMatchedQuantityInCache(securityId);
+
+#ifndef USE_CACHED_MATCHING_AT_ADD_ORDER
+	//
 	// single thread appproach - O(n)
 	//
 
@@ -361,7 +1255,7 @@ unsigned int OrderCache::getMatchingSizeForSecurity(const std::string& securityI
 		// single thread / iteractive approach - O(n) (one loop per buy order)
 		// (performance comparison purposes only)
 		//
-		for (order_ptr& order : _securityLongOrdersIndex[securityId])
+		for (order_ptr& order : _securityLongOrdersIndex[securityId].orders)
 			qty += matchOrderInCache(order, false);
 	}
 	else {
@@ -371,7 +1265,7 @@ unsigned int OrderCache::getMatchingSizeForSecurity(const std::string& securityI
 		_ThreadPool.clear();
 		unsigned int nthreads = std::thread::hardware_concurrency();		
 
-		for (order_ptr& order : _securityLongOrdersIndex[securityId]) {
+		for (order_ptr& order : _securityLongOrdersIndex[securityId].orders) {
 			{
 				// adds new thread to the pool
 				std::lock_guard<std::mutex> lock(_ThreadPoolMutex);
@@ -444,6 +1338,9 @@ std::vector<Order> OrderCache::getAllOrders() const {
 	auto start = TestUtils::tic();
 	#endif
 
+	// lazy matching: the pending orders are matched before the read
+	settleForRead();
+
 	// thread-safe lock (reading data)
 	read_lock lock = lockForReadOrders();
 	
@@ -458,7 +1355,16 @@ std::vector<Order> OrderCache::getAllOrders() const {
 	// orders batch removal methods can be O(n), otherwise they will be O(n.m).
 	// The trade-off is that the current method is O(n) instead of O(1) if orther were at a "std::vector"
 	//
-	return std::vector<Order>(_orders.cbegin(), _orders.cend());
+	if (_tombstones.empty())
+		return std::vector<Order>(_orders.cbegin(), _orders.cend());
+
+	// skips the cancelled orders waiting for reclamation (deferred deletion)
+	std::vector<Order> orders;
+	orders.reserve(size());
+	for (const Order& order : _orders)
+		if (!order.cancelled())
+			orders.push_back(order);
+	return orders;
 
 	#ifdef SHOW_EXECUTION_TIMES
 	TestUtils::toc(start, "get all orders execution time: ");
@@ -492,6 +1398,18 @@ Order& OrderCache::getOrder(const std::string& orderId) const {
 	auto start = TestUtils::tic();
 	#endif
 
+	// lazy matching: the pending orders of the order security are matched before the read
+	if (_matchingMode != MatchingMode::Default) {
+		std::string securityId;
+		{
+			read_lock lock = lockForReadOrders();
+			const order_ptr* ptr = findOrder(orderId);
+			if (ptr)
+				securityId = (*ptr)->securityId();
+		}
+		settleForRead(&securityId);
+	}
+
 	read_lock lock = lockForReadOrders();
 
 	// parameters validation: checks for nonexistent orders
@@ -501,7 +1419,11 @@ Order& OrderCache::getOrder(const std::string& orderId) const {
 	#endif
 
 	// gets order by index - O(1)
-	return *_orderIndex.at(orderId);
+	const order_ptr* ptr = findOrder(orderId);
+	if (!ptr)
+		// remark: same behavior of "std::unordered_map::at()"
+		throw std::out_of_range("order not found");
+	return **ptr;
 
 	#ifdef SHOW_EXECUTION_TIMES
 	TestUtils::toc(start, "get order by id execution time: ");
@@ -510,502 +1432,3294 @@ Order& OrderCache::getOrder(const std::string& orderId) const {
 
 
 /// <summary>
-/// Gets all orders matches by specified security identifier
+/// Gets the identifiers of the orders for sec identifier with minimum quantity of lots (ascending quantity).
+/// Remark: O(n + k log k) - vectorized quantities scan, k: number of returned orders
+/// </summary>
+/// <param name="securityId">The security identifier.</param>
+/// <param name="minQty">The minimum quantity.</param>
+/// <returns>the order identifiers</returns>
+std::vector<std::string> OrderCache::getOrdersForSecIdWithMinimumQty(const std::string& securityId, unsigned int minQty) const {
+
+	read_lock lock = lockForReadOrders();
+
+	std::vector<std::string> orders;
+	auto index = _securityOrdersIndex.find(securityId);
+	if (index == _securityOrdersIndex.end())
+		return orders;
+
+	// filters the orders with at least "minQty" lots (same scan of "cancelOrdersForSecIdWithMinimumQty()")
+	const order_list& members = index->second;
+	const quantity_list& quantities = _securityQuantities.at(securityId);
+	std::vector<uint32_t> positions(quantities.size());
+	positions.resize(matchingDispatch().filter(quantities.data(), 0, quantities.size(), minQty, positions.data()));
+
+	// skips the cancelled orders waiting for reclamation (deferred deletion)
+	positions.erase(std::remove_if(positions.begin(), positions.end(), [&members](uint32_t position) {
+		return members[position]->cancelled();
+	}), positions.end());
+
+	// ascending quantity (ties in arrival order on the security index)
+	std::stable_sort(positions.begin(), positions.end(), [&quantities](uint32_t a, uint32_t b) {
+		return quantities[a] < quantities[b];
+	});
+
+	orders.reserve(positions.size());
+	for (uint32_t position : positions)
+		orders.push_back(members[position]->orderId());
+	return orders;
+}
+
+
+/// <summary>
+/// Gets all orders matches (in sequence order)
 /// </summary>
 /// <param name="securityId">The security identifier.</param>
 /// <returns></returns>
 std::vector<OrderFill> OrderCache::getAllOrderMatches() const {
 
+	settleForRead();
 	read_lock lock = lockForReadOrders();
+	std::lock_guard<std::mutex> guard(_fillsMutex);
 
-	// moves cached internal list to vector - O(n), see comments on
+	// copies the fills by their handles - O(n), see comments on
 	// code of OrderCache::getAllOrders()
-	return std::vector<OrderFill>(_orderMatches.cbegin(), _orderMatches.cend());
+	std::vector<OrderFill> fills;
+	fills.reserve(_orderMatches.size());
+	for (const fill_handle& handle : _orderMatches)
+		fills.push_back(_securityFills[handle.security][handle.position]);
+	return fills;
 }
 
 
 /// <summary>
 /// Gets all orders matches by specified security identifier
+/// Remark: O(k) - k: fills on the security
 /// </summary>
 /// <param name="securityId">The security identifier.</param>
 /// <returns></returns>
 std::vector<OrderFill> OrderCache::getOrderMatchesBySecurity(const std::string& securityId) const {
 
+	settleForRead(&securityId);
 	read_lock lock = lockForReadOrders();
+	std::lock_guard<std::mutex> guard(_fillsMutex);
 
-	// parameters validation: checks for nonexistent security
-	if (!_securityOrdersIndex.count(securityId))
+	// parameters validation: checks for securities without fills
+	auto key = _fillSecurityKeys.find(securityId);
+	if (key == _fillSecurityKeys.end())
 		return std::vector<OrderFill>();
 
-#ifndef USE_CACHED_MATCHING_AT_ADD_ORDER	
-	//
-	// not implemented for this case (lack of time... kkkk) 
-	//
-	return std::vector<OrderFill>();
-#else
+	// copies the security fills only (contiguous chunks)
+	const order_fill_chunks& fills = _securityFills[key->second];
+	return std::vector<OrderFill>(fills.cbegin(), fills.cend());
+}
 
-	// returns cached values
-	auto& orders = _orderMatches;
 
-	// moves cached internal list to vector - O(n), see comments on
-	// code of OrderCache::getAllOrders()
-	return std::vector<OrderFill>(orders.cbegin(), orders.cend());
+/// <summary>
+/// Gets a page of the orders matches, by fill sequence number.
+/// Remark: O(k) - k: number of returned fills
+/// </summary>
+/// <param name="fromSequence">The first fill sequence number.</param>
+/// <param name="limit">The maximum number of fills.</param>
+/// <returns></returns>
+std::vector<OrderFill> OrderCache::getOrderMatches(uint64_t fromSequence, size_t limit) const {
+
+	settleForRead();
+	read_lock lock = lockForReadOrders();
+	std::lock_guard<std::mutex> guard(_fillsMutex);
+
+	std::vector<OrderFill> fills;
+	if (fromSequence >= _orderMatches.size())
+		return fills;
+
+	// remark: the sequence number is the handle position
+	const size_t last = (size_t)std::min<uint64_t>(_orderMatches.size(), fromSequence + std::min<uint64_t>(limit, _orderMatches.size()));
+	fills.reserve(last - (size_t)fromSequence);
+	for (size_t sequence = (size_t)fromSequence; sequence < last; sequence++) {
+		const fill_handle& handle = _orderMatches[sequence];
+		fills.push_back(_securityFills[handle.security][handle.position]);
+	}
+	return fills;
+}
 
-#endif	
 
-};
+/// <summary>
+/// Gets a page of the orders matches of the security, by fill sequence number.
+/// Remark: O(log n + k) - n: fills on the security, k: number of returned fills
+/// </summary>
+/// <param name="securityId">The security identifier.</param>
+/// <param name="fromSequence">The first fill sequence number.</param>
+/// <param name="limit">The maximum number of fills.</param>
+/// <returns></returns>
+std::vector<OrderFill> OrderCache::getOrderMatchesBySecurity(const std::string& securityId, uint64_t fromSequence, size_t limit) const {
+
+	settleForRead(&securityId);
+	read_lock lock = lockForReadOrders();
+	std::lock_guard<std::mutex> guard(_fillsMutex);
+
+	std::vector<OrderFill> fills;
+	auto key = _fillSecurityKeys.find(securityId);
+	if (key == _fillSecurityKeys.end())
+		return fills;
+
+	// the security fills are sorted by sequence number
+	const order_fill_chunks& securityFills = _securityFills[key->second];
+	auto first = std::lower_bound(securityFills.cbegin(), securityFills.cend(), fromSequence,
+		[](const OrderFill& fill, uint64_t sequence) { return fill.sequence() < sequence; });
+	const size_t count = std::min<size_t>(limit, (size_t)(securityFills.cend() - first));
+	fills.assign(first, first + count);
+	return fills;
+}
 
 
 /// <summary>
-/// Checks the order existence by the specified order identifier (Id).
-/// remark: O(1)
-/// remark: ** this is NOT required for the proposed problem itself, just a "aditional feature"... **
+/// Gets the sequence number of the next order fill, i.e. the number of fills.
 /// </summary>
-/// <param name="orderId">The order identifier.</param>
-/// <returns>
-/// True case order is found, False otherwise
-/// </returns>
-const bool OrderCache::exists(const std::string& orderId) const {
+/// <returns></returns>
+uint64_t OrderCache::orderMatchesSequence() const {
+	settleForRead();
+	read_lock lock = lockForReadOrders();
+	std::lock_guard<std::mutex> guard(_fillsMutex);
+	return _orderMatches.size();
+}
 
-	// checks index map hash with O(1) - using "map.contains_key()"
-	return _orderIndex.count(orderId) > 0;
+
+/// <summary>
+/// Gets the fills key of the security, interned on its first fill [PRIVATE - auxiliar function]
+/// Remark: O(1)
+/// </summary>
+/// <param name="securityId">The security identifier.</param>
+/// <param name="concurrent">Concurrent matching walk (locks the fills storage).</param>
+/// <returns></returns>
+uint32_t OrderCache::fillKey(const std::string& securityId, bool concurrent) {
+	std::unique_lock<std::mutex> guard(_fillsMutex, std::defer_lock);
+	if (concurrent)
+		guard.lock();
+	auto key = _fillSecurityKeys.emplace(securityId, (uint32_t)_securityFills.size());
+	if (key.second)
+		_securityFills.emplace_back(order_fill_chunks::allocator_type(&_orderMatchesMemory));
+	return key.first->second;
 }
 
 
 /// <summary>
-/// Gets the number of orders in current cache instance.
-/// remark: O(1)
+/// Stores the order fill on its security fills and its handle on the sequence order [PRIVATE - auxiliar function]
+/// Remark: O(1)
+/// </summary>
+/// <param name="security">The security fills key.</param>
+/// <param name="fill">The order fill.</param>
+/// <param name="concurrent">Concurrent matching walk (locks the fills storage).</param>
+void OrderCache::storeFill(uint32_t security, OrderFill&& fill, bool concurrent) {
+	std::unique_lock<std::mutex> guard(_fillsMutex, std::defer_lock);
+	if (concurrent)
+		guard.lock();
+	order_fill_chunks& fills = _securityFills[security];
+	fill.m_sequence = _orderMatches.size();
+	_orderMatches.push_back(fill_handle{ security, (uint32_t)fills.size() });
+	fills.push_back(std::move(fill));
+}
+
+
+/// <summary>
+/// Gets the memory footprint of the current cache instance, by internal data 
+/// structure (exact allocated bytes) and by security (attributed bytes).
+/// remark: O(n)
 /// remark: ** this is NOT required for the proposed problem itself, just a "aditional feature"... **
 /// </summary>
 /// <returns></returns>
-const size_t OrderCache::size() const {
+MemoryReport OrderCache::memoryReport() const {
 
-	// gets cache size with O(1) - using "map.size()"
-	return _orderIndex.size();
-}
+	read_lock lock = lockForReadOrders();
 
+	MemoryReport report;
 
+	// allocator counters (exact bytes of nodes, buckets and arrays)
+	auto usage = [](const utils::memory_counter& counter, size_t elements) {
+		MemoryUsage value;
+		value.elements = elements;
+		value.allocations = counter.allocations.load(std::memory_order_relaxed);
+		value.allocatedBytes = counter.bytes.load(std::memory_order_relaxed);
+		value.peakBytes = counter.peak.load(std::memory_order_relaxed);
+		return value;
+	};
 
-/********************************************************************************************************************************
+	// string keys spilling out of the small string buffer (not seen by the allocators)
+	auto keysHeapBytes = [](const auto& map) {
+		size_t bytes = 0;
+		for (auto& item : map)
+			bytes += utils::heapBytes(item.first);
+		return bytes;
+	};
 
-															PRIVATE MEMBERS
+	// approximated node sizes (per security attribution only)
+	constexpr size_t orderNodeBytes = sizeof(Order) + 2 * sizeof(void*);
+	constexpr size_t orderIndexNodeBytes = sizeof(std::string) + sizeof(order_ptr) + 2 * sizeof(void*);
 
-********************************************************************************************************************************/
+	MemoryUsage& orders = report.structures["_orders"] = usage(_ordersMemory, _orders.size());
+	for (const Order& order : _orders)
+		orders.stringBytes += order.heapBytes();
 
+	MemoryUsage& orderIndex = report.structures["_orderIndex"] = usage(_orderIndexMemory, _orderIndex.size());
+	orderIndex.stringBytes = keysHeapBytes(_orderIndex);
 
+	report.structures["_numericOrderIndex"] = usage(_numericOrderIndexMemory, _numericOrderIndex.size());
 
-/// <summary>
-/// Cancels the order [PRIVATE]
-/// remark: O(1)
-/// </summary>
-/// <param name="orderId">The order identifier.</param>
-/// <param name="minQty">Only cancel the specified order if the order quantity if greather than minQty value.</param>
-void OrderCache::cancelSingleOrder(const std::string& orderId, unsigned int minQty, bool lockOrder) {
-	
-	#if defined(_DEBUG) || defined(SHOW_EXECUTION_TIMES)
-	utils::osyncstream out;
-	#endif // _DEBUG
+	MemoryUsage& userIndex = report.structures["_userOrdersIndex"] = usage(_userOrdersIndexMemory, _userOrdersIndex.size());
+	userIndex.stringBytes = keysHeapBytes(_userOrdersIndex);
 
-	// parameters validation: checks for nonexistent orders
-	if (!_orderIndex.count(orderId)) {
-		#ifdef _DEBUG
-		if (!exists(orderId) && !lockOrder)
-			out << "WARNING: order id not found: '" << orderId << "'\n";
-		#endif // _DEBUG
-		#ifdef THROW_EXCEPTIONS	
-		throw std::invalid_argument("error cancelling order: order id not found");
-		#else
-		return;
-		#endif // THROW_EXCEPTIONS	
-	}
+	MemoryUsage& companyIndex = report.structures["_companyOrdersIndex"] = usage(_companyOrdersIndexMemory, _companyOrdersIndex.size());
+	companyIndex.stringBytes = keysHeapBytes(_companyOrdersIndex);
 
-	// only locks on multi-thread 
-	//lockOrder = lockOrder && _multiThread;
+	MemoryUsage& sessionIndex = report.structures["_sessionOrdersIndex"] = usage(_sessionOrdersIndexMemory, _sessionOrdersIndex.size());
+	sessionIndex.stringBytes = keysHeapBytes(_sessionOrdersIndex);
 
-	#ifdef _DEBUG
-	if (_verbose) {
-		out << " - cancelling order id: '" << orderId << "'";
-		if (minQty > 0)
-			out << "[min:" << minQty << "]";
-		out << " [cancelSingleOrder()] " << (lockOrder ? "[lock]\n" : "[no lock]\n");
-	}
-	#endif // _DEBUG
+	size_t expiring = 0;
+	for (const order_list& bucket : _expiryWheel)
+		expiring += bucket.size();
+	report.structures["_expiryWheel"] = usage(_expiryWheelMemory, expiring);
 
-	// retrives order pointer (as iterator) by "orderId" with O(1)  
-	// (fast order access)
-	order_ptr ptr = _orderIndex[orderId];
-		
-	if (minQty > 0 && ptr->qty() < minQty)
-		// checkes for mininum quantity of lots criteria for cancelation, if applicable.
-		return;
+	MemoryUsage& securityIndex = report.structures["_securityOrdersIndex"] = usage(_securityOrdersIndexMemory, _securityOrdersIndex.size());
+	securityIndex.stringBytes = keysHeapBytes(_securityOrdersIndex);
 
-	if (lockOrder) 
-		ptr->lock();
+	MemoryUsage& quantities = report.structures["_securityQuantities"] = usage(_securityQuantitiesMemory, _securityQuantities.size());
+	quantities.stringBytes = keysHeapBytes(_securityQuantities);
+
+	MemoryUsage& longIndex = report.structures["_securityLongOrdersIndex"] = usage(_longOrdersIndexMemory, _securityLongOrdersIndex.size());
+	longIndex.stringBytes = keysHeapBytes(_securityLongOrdersIndex);
+
+	MemoryUsage& shortIndex = report.structures["_securityShortOrdersIndex"] = usage(_shortOrdersIndexMemory, _securityShortOrdersIndex.size());
+	shortIndex.stringBytes = keysHeapBytes(_securityShortOrdersIndex);
+
+	MemoryUsage& matchedQuantity = report.structures["_matchedQuantity"] = usage(_matchedQuantityMemory, _matchedQuantity.size());
+	matchedQuantity.stringBytes = keysHeapBytes(_matchedQuantity);
+
+	MemoryUsage& riskExposures = report.structures["_riskExposures"] = usage(_riskExposuresMemory, _userExposures.size() + _companyExposures.size());
+	riskExposures.stringBytes = keysHeapBytes(_userExposures) + keysHeapBytes(_companyExposures);
+	for (const auto& exposures : { &_userExposures, &_companyExposures })
+		for (const auto& item : *exposures)
+			riskExposures.stringBytes += keysHeapBytes(item.second.securities);
+
+	MemoryUsage& orderMatches = report.structures["_orderMatches"] = usage(_orderMatchesMemory, _orderMatches.size());
+	orderMatches.stringBytes = keysHeapBytes(_fillSecurityKeys);
+	for (const order_fill_chunks& fills : _securityFills)
+		for (const OrderFill& fill : fills)
+			orderMatches.stringBytes += fill.heapBytes();
+
+	MemoryUsage& matchedVolume = report.structures["_matchedVolume"] = usage(_matchedVolumeMemory, _matchedVolume.size());
+	matchedVolume.stringBytes = keysHeapBytes(_matchedVolume);
+
+	MemoryUsage& pendingMatches = report.structures["_pendingMatches"] = usage(_pendingMatchesMemory, _pendingCount);
+	pendingMatches.stringBytes = keysHeapBytes(_pendingMatches);
+
+	MemoryUsage& matchingStats = report.structures["_matchingStats"] = usage(_matchingStatsMemory, _matchingStats.size());
+	matchingStats.stringBytes = keysHeapBytes(_matchingStats);
+
+	report.structures["_tombstones"] = usage(_tombstonesMemory, _tombstones.size());
+
+	MemoryUsage& companyKeys = report.structures["_companyKeys"] = usage(_companyKeysMemory, _companyKeys.size());
+	companyKeys.stringBytes = keysHeapBytes(_companyKeys);
+
+	MemoryUsage& changeLog = report.structures["_changeLog"] = usage(_changeLogMemory, _changeLog.size());
+	for (const change_entry& entry : _changeLog)
+		changeLog.stringBytes += utils::heapBytes(entry.removedId);
+
+	// each order owns a "std::shared_mutex" allocated by "std::make_shared" (control block + mutex)
+	report.orderMutexBytes = _orders.size() * (sizeof(std::shared_mutex) + 2 * sizeof(void*));
+
+	//
+	// attributes orders and index entries to each security
+	//
+	for (auto& item : _securityOrdersIndex) {
+		SecurityMemoryUsage& security = report.securities[item.first];
+		security.orders = item.second.size();
+		security.indexBytes = item.second.capacity() * sizeof(order_ptr);
+		auto quantities = _securityQuantities.find(item.first);
+		if (quantities != _securityQuantities.end())
+			security.indexBytes += quantities->second.capacity() * sizeof(uint32_t);
+
+		for (const order_ptr& order : item.second) {
+			security.orderBytes += orderNodeBytes + order->heapBytes();
+			// order index entry, user and company memberships
+			security.indexBytes += orderIndexNodeBytes + utils::heapBytes(order->orderId()) + 2 * sizeof(order_ptr);
+		}
+	}
+
+	for (auto& item : _securityQuantities)
+		report.securities[item.first].indexBytes += item.second.capacity() * sizeof(uint32_t);
+
+	for (auto& item : _securityLongOrdersIndex)
+		report.securities[item.first].sideIndexBytes += item.second.capacityBytes();
+
+	for (auto& item : _securityShortOrdersIndex)
+		report.securities[item.first].sideIndexBytes += item.second.capacityBytes();
+
+	return report;
+}
+
+
+/// <summary>
+/// Low jitter configuration: all orders and indexes storage is taken from a pre-sized arena 
+/// (huge pages, prefaulted and locked in memory), starting a new session.
+/// Remark: only on empty caches
+/// </summary>
+/// <param name="bytes">The arena size (rounded up to huge pages).</param>
+/// <param name="lockPages">true to lock the arena in memory.</param>
+/// <returns>true case the arena was reserved.</returns>
+bool OrderCache::reserveArena(size_t bytes, const bool& lockPages) {
+
+	write_lock lock = lockForUpdateOrders();
+
+	// remark: the arena must outlive the blocks allocated from it (reserved once)
+	if (!_orders.empty() || _arena) {
+		#ifdef THROW_EXCEPTIONS
+		throw std::logic_error("error reserving memory arena: the order cache is not empty");
+		#else
+		return false;
+		#endif
+	}
+
+	std::unique_ptr<utils::memory_arena> arena(new utils::memory_arena());
+	if (!arena->reserve(bytes, lockPages))
+		return false;
+
+	_arena = std::move(arena);
+	for (utils::memory_counter* counter : { &_ordersMemory, &_orderIndexMemory, &_numericOrderIndexMemory, 
+		&_userOrdersIndexMemory, &_companyOrdersIndexMemory, &_sessionOrdersIndexMemory, &_expiryWheelMemory, &_securityOrdersIndexMemory, &_securityQuantitiesMemory,
+		&_longOrdersIndexMemory, &_shortOrdersIndexMemory, &_matchedQuantityMemory, &_orderMatchesMemory, &_riskExposuresMemory, &_changeLogMemory, &_matchedVolumeMemory, &_pendingMatchesMemory, &_matchingStatsMemory, &_tombstonesMemory, &_companyKeysMemory })
+		counter->arena = _arena.get();
+
+	_sessionFaults = utils::page_faults::current();
+	return true;
+}
+
+
+/// <summary>
+/// Starts the trading session: page faults are reported from now on.
+/// </summary>
+void OrderCache::startSession() {
+	write_lock lock = lockForUpdateOrders();
+	_sessionFaults = utils::page_faults::current();
+}
+
+
+/// <summary>
+/// Gets the memory arena report (pages, usage and process page faults taken during the session).
+/// </summary>
+/// <returns></returns>
+ArenaReport OrderCache::arenaReport() const {
+
+	read_lock lock = lockForReadOrders();
+
+	ArenaReport report;
+	if (_arena) {
+		static const char* pages[] = { "none", "standard", "transparent", "huge" };
+		report.pages = pages[(int)_arena->pages()];
+		report.reservedBytes = _arena->reservedBytes();
+		report.usedBytes = _arena->usedBytes();
+		report.fallbacks = _arena->fallbacks();
+		report.locked = _arena->locked();
+	}
+
+	const utils::page_faults faults = utils::page_faults::current();
+	report.minorFaults = faults.minor - std::min(faults.minor, _sessionFaults.minor);
+	report.majorFaults = faults.major - std::min(faults.major, _sessionFaults.major);
+
+	// the order strings are not arena allocated: only the SSO buffer lives in the order node
+	for (const Order& order : _orders) {
+		const size_t bytes = order.heapBytes();
+		report.stringHeapBytes += bytes;
+		report.stringHeapOrders += bytes > 0;
+	}
+	return report;
+}
+
+
+/// <summary>
+/// Encodes all orders in current cache instance at the end of the output buffer
+/// (JSON array or binary records).
+/// remark: O(n)
+/// remark: ** this is NOT required for the proposed problem itself, just a "aditional feature"... **
+/// </summary>
+/// <param name="out">The output buffer.</param>
+/// <param name="format">The export format.</param>
+/// <returns>the number of exported orders</returns>
+size_t OrderCache::exportOrders(utils::output_buffer& out, ExportFormat format) const {
+
+	#ifdef SHOW_EXECUTION_TIMES
+	auto start = debug::TestUtils::tic();
+	#endif
+
+	settleForRead();
+	read_lock lock = lockForReadOrders();
+
+	// remark: skips the cancelled orders waiting for reclamation (deferred deletion)
+	if (format == ExportFormat::Binary) {
+		// records count header, then one record per order
+		out.appendVarint(size());
+		for (const Order& order : _orders)
+			if (!order.cancelled())
+				order.writeBinary(out);
+	}
+	else {
+		out.append('[');
+		bool first = true;
+		for (const Order& order : _orders) {
+			if (order.cancelled())
+				continue;
+			if (!first)
+				out.append(',');
+			order.writeJson(out);
+			first = false;
+		}
+		out.append(']');
+	}
+
+	#ifdef SHOW_EXECUTION_TIMES
+	debug::TestUtils::toc(start, "export orders execution time: ");
+	#endif
+
+	return size();
+}
+
+
+/// <summary>
+/// Checks the order existence by the specified order identifier (Id).
+/// remark: O(1)
+/// remark: ** this is NOT required for the proposed problem itself, just a "aditional feature"... **
+/// </summary>
+/// <param name="orderId">The order identifier.</param>
+/// <returns>
+/// True case order is found, False otherwise
+/// </returns>
+const bool OrderCache::exists(const std::string& orderId) const {
+
+	// checks index map hash with O(1) - using "map.contains_key()"
+	return findOrder(orderId) != nullptr;
+}
+
+
+/// <summary>
+/// Gets the order pointer by identifier (numeric or hash index), nullptr if not found [PRIVATE - auxiliar function]
+/// Remark: O(1) - numeric identifiers: two array indexings (no hashing)
+/// </summary>
+/// <param name="orderId">The order identifier.</param>
+/// <returns></returns>
+const order_ptr* OrderCache::findOrder(const std::string& orderId) const {
+	uint64_t numericId;
+	if (_numericOrderIds && utils::parseId(orderId, numericId)) {
+		if (const order_ptr* ptr = _numericOrderIndex.find(numericId))
+			return ptr;
+	}
+	auto it = _orderIndex.find(orderId);
+	return it == _orderIndex.end() ? nullptr : &it->second;
+}
+
+
+/// <summary>
+/// Sets the numeric order identifiers mode (direct indexed table), only on an empty cache.
+/// </summary>
+/// <param name="value">The value.</param>
+void OrderCache::setNumericOrderIds(const bool& value) {
+
+	write_lock lock = lockForUpdateOrders();
+
+	if (!_orders.empty()) {
+		#ifdef THROW_EXCEPTIONS
+		throw std::logic_error("error setting numeric order ids: the order cache is not empty");
+		#else
+		return;
+		#endif
+	}
+
+	_numericOrderIds = value;
+	_numericOrderIndex.clear();
+}
+
+
+/// <summary>
+/// Sets the pre-trade risk limits of each user and of each company and enables the risk checks.
+/// </summary>
+/// <param name="user">The limits of each user.</param>
+/// <param name="company">The limits of each company.</param>
+void OrderCache::setRiskLimits(const RiskLimits& user, const RiskLimits& company) {
+
+	write_lock lock = lockForUpdateOrders();
+
+	// remark: the running aggregates start with the cache
+	if (!_riskChecks && !_orders.empty()) {
+		#ifdef THROW_EXCEPTIONS
+		throw std::logic_error("error setting risk limits: the order cache is not empty");
+		#else
+		return;
+		#endif
+	}
+
+	_userLimits = user;
+	_companyLimits = company;
+	_riskChecks = true;
+}
+
+
+/// <summary>
+/// Gets the running aggregates of the user working lots (risk checks enabled).
+/// </summary>
+/// <returns></returns>
+RiskExposure OrderCache::userExposure(const std::string& user) const {
+	read_lock lock = lockForReadOrders();
+	std::lock_guard<std::mutex> guard(_riskMutex);
+	auto it = _userExposures.find(user);
+	return it == _userExposures.end() ? RiskExposure{} : detachExposure(it->second);
+}
+
+
+/// <summary>
+/// Gets the running aggregates of the company working lots (risk checks enabled).
+/// </summary>
+/// <returns></returns>
+RiskExposure OrderCache::companyExposure(const std::string& company) const {
+	read_lock lock = lockForReadOrders();
+	std::lock_guard<std::mutex> guard(_riskMutex);
+	auto it = _companyExposures.find(company);
+	return it == _companyExposures.end() ? RiskExposure{} : detachExposure(it->second);
+}
+
+
+/// <summary>
+/// Gets the global mutation sequence number (order adds, fills, amends and cancels).
+/// </summary>
+/// <returns></returns>
+uint64_t OrderCache::changeSequence() const {
+	read_lock lock = lockForReadOrders();
+	std::lock_guard<std::mutex> guard(_changeLogMutex);
+	return _changeSequence;
+}
+
+
+/// <summary>
+/// Sets the change log capacity (0 disables it), logging from the current sequence on.
+/// </summary>
+/// <param name="capacity">The number of changes kept.</param>
+void OrderCache::setChangeLog(const size_t& capacity) {
+	write_lock lock = lockForUpdateOrders();
+	std::lock_guard<std::mutex> guard(_changeLogMutex);
+	_changeLog.assign(capacity, change_entry{});
+	_changeLogStart = _changeSequence;
+}
+
+
+/// <summary>
+/// Gets the orders changed and cancelled since the specified mutation sequence number.
+/// Remark: O(changes) - O(n) on resynchronization
+/// </summary>
+/// <param name="sequence">The last sequence seen (0 for the whole book).</param>
+/// <returns></returns>
+OrderChanges OrderCache::getOrdersChangedSince(uint64_t sequence) const {
+
+	settleForRead();
+	read_lock lock = lockForReadOrders();
+	std::lock_guard<std::mutex> guard(_changeLogMutex);
+
+	OrderChanges changes;
+	changes.sequence = _changeSequence;
+	if (sequence >= _changeSequence)
+		return changes;
+
+	// the oldest change still logged (bounded ring, logging since "_changeLogStart")
+	const uint64_t capacity = _changeLog.size();
+	const uint64_t oldest = std::max(_changeLogStart, _changeSequence > capacity ? _changeSequence - capacity : 0) + 1;
+	if (capacity == 0 || sequence + 1 < oldest) {
+		// not covered by the log: the whole book
+		changes.resync = true;
+		changes.orders.reserve(size());
+		for (const Order& order : _orders)
+			if (!order.cancelled())
+				changes.orders.push_back(order);
+		return changes;
+	}
+
+	// from the newest change to the oldest one: each order once, at its current state, i.e. the 
+	// newest change of an order supersedes the older ones (linked changes, no id hashing)
+	std::vector<bool> superseded((size_t)(_changeSequence - sequence));
+	std::unordered_set<std::string_view> removed;
+	for (uint64_t current = _changeSequence; current > sequence; current--) {
+		if (superseded[(size_t)(current - sequence - 1)])
+			continue;
+
+		const change_entry& entry = _changeLog[current % capacity];
+		for (uint64_t previous = entry.previous; previous > sequence; previous = _changeLog[previous % capacity].previous)
+			superseded[(size_t)(previous - sequence - 1)] = true;
+
+		if (entry.order)
+			changes.orders.push_back(*entry.order);
+		// remark: a reused id reports its newest order only (live or removed)
+		else if (!findOrder(entry.removedId) && removed.insert(entry.removedId).second)
+			changes.cancelled.push_back(entry.removedId);
+	}
+	std::reverse(changes.orders.begin(), changes.orders.end());
+	std::reverse(changes.cancelled.begin(), changes.cancelled.end());
+	return changes;
+}
+
+
+/// <summary>
+/// Stamps the order change with the next mutation sequence and logs it, if enabled [PRIVATE - auxiliar function]
+/// Remark: O(1)
+/// </summary>
+/// <param name="order">The order.</param>
+/// <param name="concurrent">Concurrent matching walk (locks the change log).</param>
+void OrderCache::recordChange(Order& order, bool concurrent) {
+	std::unique_lock<std::mutex> guard(_changeLogMutex, std::defer_lock);
+	if (concurrent)
+		guard.lock();
+	const uint64_t previous = order.m_changeSequence;
+	order.m_changeSequence = ++_changeSequence;
+	if (_changeLog.empty())
+		return;
+
+	change_entry& entry = _changeLog[_changeSequence % _changeLog.size()];
+	entry.sequence = _changeSequence;
+	entry.previous = previous;
+	entry.order = &order;
+}
+
+
+/// <summary>
+/// Stamps the order removal with the next mutation sequence and logs its id, if enabled [PRIVATE - auxiliar function]
+/// Remark: O(1) - the id is copied into the ring slot capacity (allocates only on longer ids)
+/// </summary>
+/// <param name="order">The order.</param>
+void OrderCache::recordRemoval(Order& order) {
+	const uint64_t previous = order.m_changeSequence;
+	order.m_changeSequence = ++_changeSequence;
+	if (_changeLog.empty())
+		return;
+
+	change_entry& entry = _changeLog[_changeSequence % _changeLog.size()];
+	entry.sequence = _changeSequence;
+	entry.previous = previous;
+	entry.order = nullptr;
+	entry.removedId.assign(order.m_orderId);
+}
+
+
+/// <summary>
+/// Sets the matched volume series (time buckets by security).
+/// </summary>
+/// <param name="value">The value.</param>
+void OrderCache::setVolumeSeries(const bool& value) {
+	write_lock lock = lockForUpdateOrders();
+	_volumeSeries = value;
+}
+
+
+/// <summary>
+/// Gets the matched lots of the security by time bucket on the range [from, to).
+/// Remark: O(buckets)
+/// </summary>
+/// <param name="securityId">The security identifier.</param>
+/// <param name="from">The range start (microseconds since epoch).</param>
+/// <param name="to">The range end (microseconds since epoch, exclusive).</param>
+/// <param name="resolution">The bucket interval.</param>
+/// <returns></returns>
+std::vector<VolumeBucket> OrderCache::getMatchedVolume(const std::string& securityId, uint64_t from, uint64_t to, 
+	VolumeResolution resolution) const {
+
+	settleForRead(&securityId);
+	std::shared_lock<std::shared_timed_mutex> lock(_matchedQuantityMutex);
+
+	std::vector<VolumeBucket> buckets;
+	auto series = _matchedVolume.find(securityId);
+	if (to <= from || series == _matchedVolume.end())
+		return buckets;
+
+	const uint64_t interval = resolution == VolumeResolution::Second ? 1000000 : 60000000;
+	const volume_series::volume_ring& ring = resolution == VolumeResolution::Second ? series->second.seconds : series->second.minutes;
+
+	// remark: only the last ring size buckets of the range are kept
+	const uint64_t last = (to - 1) / interval;
+	uint64_t first = from / interval;
+	if (last - first >= ring.size())
+		first = last - ring.size() + 1;
+
+	buckets.reserve((size_t)(last - first + 1));
+	for (uint64_t index = first; index <= last; index++) {
+		const volume_bucket& bucket = ring[index % ring.size()];
+		buckets.push_back(VolumeBucket{ index * interval, bucket.index == index ? bucket.volume : 0 });
+	}
+	return buckets;
+}
+
+
+/// <summary>
+/// Sets the order matching mode (leaving the lazy mode settles all pending orders).
+/// </summary>
+/// <param name="value">The value.</param>
+void OrderCache::setMatchingMode(const MatchingMode& value) {
+	write_lock lock = lockForUpdateOrders();
+	if (value != MatchingMode::Lazy)
+		settleAll();
+	_matchingMode = value;
+}
+
+
+/// <summary>
+/// Gets the number of orders waiting for matching (lazy matching mode).
+/// </summary>
+/// <returns></returns>
+size_t OrderCache::pendingMatches() const {
+	read_lock lock = lockForReadOrders();
+	return _pendingCount;
+}
+
+
+/// <summary>
+/// Matches all orders waiting for matching (lazy matching mode).
+/// </summary>
+void OrderCache::settleMatching() {
+	write_lock lock = lockForUpdateOrders();
+	settleAll();
+}
+
+
+/// <summary>
+/// Marks the order security dirty: the order is matched on the next query on the security, 
+/// against the counterparties arrived until now [PRIVATE - auxiliar function]
+/// Remark: O(1)
+/// </summary>
+/// <param name="ptr">The order pointer.</param>
+void OrderCache::deferMatching(order_ptr& ptr) {
+	pendingList(_pendingMatches, ptr->securityId()).emplace_back(ptr, _arrivals);
+	_pendingCount++;
+}
+
+
+/// <summary>
+/// Matches the orders waiting for matching on the security, in arrival order (i.e. the same 
+/// fills of the matching at "addOrder()") [PRIVATE - auxiliar function]
+/// </summary>
+/// <param name="securityId">The security identifier.</param>
+void OrderCache::settle(const std::string& securityId) {
+	auto it = _pendingMatches.find(securityId);
+	if (it == _pendingMatches.end())
+		return;
+
+	pending_list pending = std::move(it->second);
+	_pendingMatches.erase(it);
+	_pendingCount -= pending.size();
+
+	auto start = std::chrono::steady_clock::now();
+	for (auto& item : pending)
+		matchOrderInCache(item.first, false, item.second);
+
+	SecurityMatchingStats& stats = _matchingStats[securityId].stats;
+	stats.lazyMatches += pending.size();
+	stats.lazyNanoseconds += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+/// <summary>
+/// Matches the added (or increased) order: at once (compile time mode or eager security 
+/// strategy) or on the next query on the security (lazy) [PRIVATE - auxiliar function]
+/// </summary>
+/// <param name="ptr">The order pointer.</param>
+void OrderCache::matchAdded(order_ptr& ptr) {
+
+	// risk checks: the running aggregates count the working lots after matching
+	if (_matchingMode == MatchingMode::Default || _riskChecks) {
+		#ifdef USE_CACHED_MATCHING_AT_ADD_ORDER
+		matchOrderInCache(ptr, false);
+		#endif
+		return;
+	}
+
+	security_matching& matching = _matchingStats[ptr->securityId()];
+	SecurityMatchingStats& stats = matching.stats;
+	stats.adds++;
+	const size_t addsSinceQuery = matching.addsSinceQuery.fetch_add(1, std::memory_order_relaxed) + 1;
+
+	if (_matchingMode == MatchingMode::Lazy)
+		stats.eager = false;
+	else if (stats.eager && addsSinceQuery > ADAPTIVE_LAZY_RATIO)
+		// queries are already rarer than the lazy threshold (e.g. never queried)
+		switchStrategy(ptr->securityId(), matching, false);
+
+	if (!stats.eager) {
+		deferMatching(ptr);
+		return;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	matchOrderInCache(ptr, false);
+	stats.eagerMatches++;
+	stats.eagerNanoseconds += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+/// <summary>
+/// Accounts a query on the security: smooths its adds per query (exponential moving average, 
+/// 1/8 weight) and checks, with hysteresis, its strategy case adaptive matching [PRIVATE - auxiliar function]
+/// Remark: atomics only, i.e. called under the read lock (concurrent queries)
+/// </summary>
+/// <param name="matching">The security matching strategy.</param>
+/// <returns>true case the strategy must switch (see "adaptStrategy()")</returns>
+bool OrderCache::queried(security_matching& matching) {
+
+	const size_t queries = matching.queries.fetch_add(1, std::memory_order_relaxed) + 1;
+	const double adds = (double)matching.addsSinceQuery.exchange(0, std::memory_order_relaxed);
+	double addsPerQuery = matching.addsPerQuery.load(std::memory_order_relaxed);
+	double smoothed;
+	do {
+		smoothed = queries == 1 ? adds : addsPerQuery + (adds - addsPerQuery) / 8;
+	} while (!matching.addsPerQuery.compare_exchange_weak(addsPerQuery, smoothed, std::memory_order_relaxed));
+
+	// remark: the strategy changes under the write lock only (queries just read it)
+	if (_matchingMode != MatchingMode::Adaptive)
+		return false;
+	const bool eager = matching.stats.eager;
+	return (!eager && smoothed < ADAPTIVE_EAGER_RATIO) || (eager && smoothed > ADAPTIVE_LAZY_RATIO);
+}
+
+
+/// <summary>
+/// Switches the security strategy case still required by its adds per query (adaptive matching) [PRIVATE - auxiliar function]
+/// Remark: the pending orders are settled by the query itself (before any eager match)
+/// </summary>
+/// <param name="securityId">The security identifier.</param>
+/// <param name="matching">The security matching strategy.</param>
+void OrderCache::adaptStrategy(const std::string& securityId, security_matching& matching) {
+	const double addsPerQuery = matching.addsPerQuery.load(std::memory_order_relaxed);
+	if (!matching.stats.eager && addsPerQuery < ADAPTIVE_EAGER_RATIO)
+		switchStrategy(securityId, matching, true);
+	else if (matching.stats.eager && addsPerQuery > ADAPTIVE_LAZY_RATIO)
+		switchStrategy(securityId, matching, false);
+}
+
+
+/// <summary>
+/// Switches the security strategy, logging the decision (adaptive matching) [PRIVATE - auxiliar function]
+/// </summary>
+void OrderCache::switchStrategy(const std::string& securityId, security_matching& matching, bool eager) {
+	SecurityMatchingStats& stats = matching.stats;
+	stats.eager = eager;
+	stats.switches++;
+	_matchingSwitches.push_back(MatchingSwitch{ securityId, eager, matching.addsPerQuery.load(std::memory_order_relaxed),
+		matching.addsSinceQuery.load(std::memory_order_relaxed) });
+	if (_matchingSwitches.size() > MATCHING_SWITCH_LOG)
+		_matchingSwitches.pop_front();
+}
+
+
+/// <summary>
+/// Gets the matching strategies report (per security strategy, costs and the last switch decisions).
+/// </summary>
+/// <returns></returns>
+MatchingStats OrderCache::matchingStats() const {
+	read_lock lock = lockForReadOrders();
+
+	MatchingStats stats;
+	for (auto& item : _matchingStats) {
+		SecurityMatchingStats& security = stats.securities[item.first] = item.second.stats;
+		security.queries = item.second.queries.load(std::memory_order_relaxed);
+		security.addsSinceQuery = item.second.addsSinceQuery.load(std::memory_order_relaxed);
+		security.addsPerQuery = item.second.addsPerQuery.load(std::memory_order_relaxed);
+	}
+	stats.switches.assign(_matchingSwitches.begin(), _matchingSwitches.end());
+	return stats;
+}
+
+
+/// <summary>
+/// Matches the orders waiting for matching on the securities of the orders, e.g. the victims of a 
+/// mass cancel (the other dirty securities are left pending) [PRIVATE - auxiliar function]
+/// Remark: O(1) per order
+/// </summary>
+/// <param name="orders">The orders.</param>
+void OrderCache::settleOrders(const order_list& orders) {
+	for (const order_ptr& ptr : orders) {
+		if (_pendingMatches.empty())
+			return;
+		settle(ptr->securityId());
+	}
+}
+
+
+/// <summary>
+/// Matches the orders waiting for matching on all securities [PRIVATE - auxiliar function]
+/// </summary>
+void OrderCache::settleAll() {
+	while (!_pendingMatches.empty()) {
+		const std::string securityId = _pendingMatches.begin()->first;
+		settle(securityId);
+	}
+}
+
+
+/// <summary>
+/// Matches the orders waiting for matching on the security (nullptr: on all securities) before a read, 
+/// i.e. reads report the fills of the matching at "addOrder()" [PRIVATE - auxiliar function]
+/// Remark: checks under the read lock, the write lock is taken only when dirty
+/// </summary>
+/// <param name="securityId">The security identifier, nullptr for all securities.</param>
+void OrderCache::settleForRead(const std::string* securityId) const {
+
+	if (_matchingMode == MatchingMode::Default)
+		return;
+
+	{
+		read_lock lock = lockForReadOrders();
+		if (securityId ? !_pendingMatches.count(*securityId) : !_pendingCount)
+			return;
+	}
+
+	// remark: logically const, the pending matches are the fills already due at "addOrder()"
+	OrderCache& cache = const_cast<OrderCache&>(*this);
+	write_lock lock = cache.lockForUpdateOrders();
+	if (securityId)
+		cache.settle(*securityId);
+	else
+		cache.settleAll();
+}
+
+
+/// <summary>
+/// Removes the orders expired at the specified time in a single bulk cancel (timing wheel).
+/// Remark: O(1) amortized per expired order
+/// </summary>
+/// <param name="now">The current time (microseconds since epoch).</param>
+/// <returns>the number of expired orders</returns>
+size_t OrderCache::expireOrders(const uint64_t& now) {
+	
+	// thread-safe lock (writting data)
+	write_lock lock = lockForUpdateOrders();
+
+	#ifdef SHOW_EXECUTION_TIMES
+	auto start = debug::TestUtils::tic();
+	#endif
+
+	order_list expired;
+	advanceExpiry(now / EXPIRY_TICK_US, expired);
+	const size_t count = expired.size();
+	removeExpired(expired);
+
+	if (_replica) {
+		OrderMutation mutation{ MutationType::ExpireOrders };
+		mutation.time = now;
+		publish(std::move(mutation));
+	}
+
+	#ifdef SHOW_EXECUTION_TIMES
+	debug::TestUtils::toc(start, "expire orders execution time: ");
+	#endif
+
+	return count;
+}
+
+
+/// <summary>
+/// Removes the orders expired at the current system time.
+/// </summary>
+/// <returns>the number of expired orders</returns>
+size_t OrderCache::expireOrders() {
+	const auto now = std::chrono::system_clock::now().time_since_epoch();
+	return expireOrders((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+}
+
+
+/// <summary>
+/// Removes the orders valid for the session only (Order::GOOD_FOR_DAY) in a single bulk cancel.
+/// Remark: O(n) on the session orders
+/// </summary>
+/// <returns>the number of expired orders</returns>
+size_t OrderCache::endSession() {
+
+	// thread-safe lock (writting data)
+	write_lock lock = lockForUpdateOrders();
+
+	// gets the session orders with O(1) (moved, not copied)
+	order_list expired = std::move(_expiryWheel.back());
+	_expiryWheel.back().clear();
+	for (order_ptr& ptr : expired)
+		ptr->m_expiryBucket = UINT32_MAX;
+
+	const size_t count = expired.size();
+	removeExpired(expired);
+
+	if (_replica)
+		publish(OrderMutation{ MutationType::EndSession });
+
+	return count;
+}
+
+
+/// <summary>
+/// Gets the number of orders scheduled for expiry (including the session orders).
+/// </summary>
+/// <returns></returns>
+size_t OrderCache::expiringOrders() const {
+	read_lock lock = lockForReadOrders();
+	size_t count = _expiryWheel.back().size();
+	for (const size_t& level : _expiryCounts)
+		count += level;
+	return count;
+}
+
+
+/// <summary>
+/// Gets the number of orders in current cache instance.
+/// remark: O(1)
+/// remark: ** this is NOT required for the proposed problem itself, just a "aditional feature"... **
+/// </summary>
+/// <returns></returns>
+const size_t OrderCache::size() const {
+
+	// gets cache size with O(1) - using "map.size()"
+	return _orderIndex.size() + _numericOrderIndex.size();
+}
+
+
+
+/********************************************************************************************************************************
+
+															PRIVATE MEMBERS
+
+********************************************************************************************************************************/
+
+
+
+/// <summary>
+/// Cancels the order [PRIVATE]
+/// remark: O(1)
+/// </summary>
+/// <param name="orderId">The order identifier.</param>
+/// <param name="minQty">Only cancel the specified order if the order quantity if greather than minQty value.</param>
+void OrderCache::cancelSingleOrder(const std::string& orderId, unsigned int minQty, bool lockOrder) {
+	
+	#if defined(_DEBUG) || defined(SHOW_EXECUTION_TIMES)
+	utils::osyncstream out;
+	#endif // _DEBUG
+
+	// parameters validation: checks for nonexistent orders
+	const order_ptr* found = findOrder(orderId);
+	if (!found) {
+		#ifdef _DEBUG
+		if (!exists(orderId) && !lockOrder)
+			out << "WARNING: order id not found: '" << orderId << "'\n";
+		#endif // _DEBUG
+		#ifdef THROW_EXCEPTIONS	
+		throw std::invalid_argument("error cancelling order: order id not found");
+		#else
+		return;
+		#endif // THROW_EXCEPTIONS	
+	}
+
+	// only locks on multi-thread 
+	//lockOrder = lockOrder && _multiThread;
+
+	#ifdef _DEBUG
+	if (_verbose) {
+		out << " - cancelling order id: '" << orderId << "'";
+		if (minQty > 0)
+			out << "[min:" << minQty << "]";
+		out << " [cancelSingleOrder()] " << (lockOrder ? "[lock]\n" : "[no lock]\n");
+	}
+	#endif // _DEBUG
+
+	// retrives order pointer (as iterator) by "orderId" with O(1)  
+	// (fast order access)
+	order_ptr ptr = *found;
+		
+	if (minQty > 0 && ptr->qty() < minQty)
+		// checkes for mininum quantity of lots criteria for cancelation, if applicable.
+		return;
+
+	if (lockOrder) 
+		ptr->lock();
+
+	if (_deferredDeletion) {
+		// deferred deletion: tombstone only (physical removal on background)
+		retireOrder(ptr);
+		if (lockOrder)
+			ptr->unlock();
+		return;
+	}
 
 	//std::mutex _lockTest;
 	//std::lock_guard<std::mutex> guard(_lockTest);
 	
-	// removes order cached indexes	with O(1)
-	_userOrdersIndex[ptr->user()].erase(orderId);
-	_securityOrdersIndex[ptr->securityId()].erase(orderId);
+	// removes order cached indexes	with O(1)
+	unindexOrder(ptr);
+	
+	// removes order indexes (optimized for the order matching procedure)
+	std::shared_mutex& mtx = isBuySide(ptr) ?
+		_longOrdersMutex : _shortOrdersMutex;
+
+	// remark: the order position is stored on the order (no search)
+	eraseSide(sideBook(ptr), ptr);
+
+	if (lockOrder) 
+		ptr->unlock();
+	
+	// removes the order instance itself with O(1)	
+	_orders.erase(ptr);
+	
+	#ifdef _DEBUG
+	if (exists(orderId)) 
+		out << "WARN: order not deleted: " << orderId << "\n";			
+	else if (_verbose)
+		out << "cache{size: " << size() << "} - order deleted: " << orderId << "\n";
+	
+	out.flush();
+	#endif // _DEBUG
+}
+
+
+
+/// <summary>
+/// Cancels the orders (uses multithreading if required) [PRIVATE - auxiliar function]
+/// </summary>
+/// <param name="orders">The orders.</param>
+/// <param name="minQty">Only cancel the specified order if the order quantity if greather than minQty value.</param>
+void OrderCache::cancelOrders(order_list& orders, unsigned int minQty) {
+
+	// deferred deletion: the user, company, session and security indexes keep the tombstones until reclaimed
+	if (!_tombstones.empty())
+		orders.erase(std::remove_if(orders.begin(), orders.end(), [](const order_ptr& ptr) { return ptr->cancelled(); }), orders.end());
+	if (orders.empty())
+		return;
+
+	// number of elements in the set of orders identifiers to remove
+	const unsigned int size = (unsigned int)orders.size();
+	// number of threads
+	const unsigned int nthreads = _multiThread ? std::thread::hardware_concurrency() : 1;
+	// the set will be processed in chunks os size:
+	const unsigned int chunkSize = (nthreads == 1 || size <= nthreads) ? size : 1 + ((size - 1) / nthreads);
+	// single thread approach: if required OR the chunk size 
+	// of the vector does not compensate for the thread overhead!		
+	bool singleThreadDelete = !_multiThread || chunkSize < DELETE_CHUNK_SIZE;
+
+	#ifdef _DEBUG
+	utils::osyncstream out;
+	out << "Cancel orders [OrderCache::cancelOrders() - private]: \n";
+	out << " - nthreads: " << nthreads << "\n";
+	out << " - chunk size: " << chunkSize << "\n";
+	out << " - multithread: " << (singleThreadDelete ? "no\n" : "yes\n");
+	out.flush();
+	#endif // _DEBUG
+	
+	singleThreadDelete = true;
+
+	if (orders.size() == 1) {
+		cancelSingleOrder(orders.front()->orderId(), minQty, false);
+	}
+	else if (singleThreadDelete) {
+		// marks the victims (checks for mininum quantity of lots criteria for cancelation, if applicable)
+		std::vector<order_ptr> victims;
+		victims.reserve(orders.size());
+		for (order_ptr& ptr : orders)
+			if (minQty == 0 || ptr->qty() >= minQty)
+				victims.push_back(ptr);
+		
+		if (_deferredDeletion) {
+			// tombstones only (physical removal on background)
+			for (order_ptr& ptr : victims)
+				retireOrder(ptr);
+		}
+		else
+			// removes all victims with a single compaction pass per side index
+			compactOrders(victims);
+	}
+	else
+	{
+		//
+		// multithread approach
+		//		
+		std::vector<std::thread> threads;
+
+		// creates a "removal" thread for each order chunk set (of size "chunkSize")
+		utils::chunks(orders.begin(), orders.end(), chunkSize,
+			[&](order_list::iterator start, order_list::iterator end) {
+				threads.push_back(std::thread([=, &orders]() { cancelOrdersRange(orders, start, end, minQty); }));
+			});
+				
+		// waits for all threads to finish
+		for (auto& thread : threads)
+			thread.join();
+	}	
+}
+
+
+/// <summary>
+/// Removes the marked orders from all indexes and from the orders list, with a single 
+/// (stable) compaction pass per affected side index [PRIVATE - auxiliar function]
+/// 
+/// Remark: O(n + k) - n: orders in the affected securities, k: victims 
+///         (removing one by one costs O(n) per victim on the side indexes)
+/// </summary>
+/// <param name="victims">The orders to remove.</param>
+void OrderCache::compactOrders(const std::vector<order_ptr>& victims) {
+
+	for (order_ptr ptr : victims)
+		unindexOrder(ptr);
+
+	unlinkOrders(victims);
+}
+
+
+/// <summary>
+/// Removes the orders from the side indexes and releases them, with a single 
+/// (stable) compaction pass per affected side index [PRIVATE - auxiliar function]
+/// </summary>
+/// <param name="victims">The orders to remove.</param>
+void OrderCache::unlinkOrders(const std::vector<order_ptr>& victims) {
+
+	if (victims.empty())
+		return;
+
+	#ifdef _DEBUG
+	utils::osyncstream out;
+	if (_verbose)
+		out << " - compacting " << victims.size() << " cancelled orders [OrderCache::unlinkOrders()]\n";
+	#endif // _DEBUG
+
+	// marks the victims and collects the affected side indexes
+	std::unordered_set<const Order*> marked;
+	marked.reserve(victims.size());
+	std::unordered_set<side_book*> sides;
+
+	for (order_ptr ptr : victims) {
+		marked.insert(&*ptr);
+		sides.insert(&sideBook(ptr));
+	}
+
+	// one stable pass per affected side index (keeps the counterparties ordering)
+	for (side_book* book : sides) {
+		size_t kept = 0;
+		for (size_t i = 0; i < book->size(); i++) {
+			if (marked.count(&*book->orders[i]))
+				continue;
+			book->orders[kept] = book->orders[i];
+			book->working[kept] = book->working[i];
+			book->companies[kept] = book->companies[i];
+			book->orders[kept]->m_sideSlot = (uint32_t)kept;
+			kept++;
+		}
+		book->orders.resize(kept);
+		book->working.resize(kept);
+		book->companies.resize(kept);
+	}
+
+	// removes the orders itself
+	for (order_ptr ptr : victims)
+		_orders.erase(ptr);
+
+	#ifdef _DEBUG
+	if (_verbose)
+		out << "cache{size: " << size() << "} - orders released: " << victims.size() << "\n";
+	#endif // _DEBUG
+}
+
+
+/// <summary>
+/// Removes the order from the identifier indexes (order, user, company and security) [PRIVATE - auxiliar function]
+/// Remark: O(1)
+/// </summary>
+/// <param name="ptr">The order pointer.</param>
+void OrderCache::unindexOrder(order_ptr& ptr) {
+	removeMembers(ptr);
+	detachOrder(ptr);
+}
+
+
+/// <summary>
+/// Removes the order from the user, company, session and security indexes [PRIVATE - auxiliar function]
+/// Remark: O(1)
+/// </summary>
+/// <param name="ptr">The order pointer.</param>
+void OrderCache::removeMembers(order_ptr& ptr) {
+	removeMember(_userOrdersIndex, ptr->user(), ptr, &Order::m_userSlot);
+	removeMember(_companyOrdersIndex, ptr->company(), ptr, &Order::m_companySlot);
+	if (!ptr->session().empty())
+		removeMember(_sessionOrdersIndex, ptr->session(), ptr, &Order::m_sessionSlot);
+	removeSecurityMember(ptr);
+}
+
+
+/// <summary>
+/// Removes the order from the order identifier index and the expiry wheel, releases its exposure 
+/// and logs the change [PRIVATE - auxiliar function]
+/// Remark: O(1)
+/// </summary>
+/// <param name="ptr">The order pointer.</param>
+void OrderCache::detachOrder(order_ptr& ptr) {
+	unscheduleExpiry(ptr);
+	addExposure(*ptr, -(int64_t)ptr->workingQty());
+	ptr->m_userRisk = nullptr;
+	recordRemoval(*ptr);
+	uint64_t numericId;
+	if (!_numericOrderIds || !utils::parseId(ptr->orderId(), numericId) || !_numericOrderIndex.erase(numericId))
+		_orderIndex.erase(ptr->orderId());
+}
+
+
+/// <summary>
+/// Checks the additional order lots against the user and company risk limits (per side, per security and overall) [PRIVATE - auxiliar function]
+/// Remark: O(1)
+/// </summary>
+/// <param name="order">The order.</param>
+/// <param name="qty">The additional working lots (all the working lots of a new order, the increase of an amend).</param>
+/// <returns>the reject reason, RiskReject::None if within the limits</returns>
+RiskReject OrderCache::checkRisk(const Order& order, uint64_t qty) const {
+	const bool isBuy = order.m_side != "Sell";
+
+	auto check = [&](const tracked_map<std::string, RiskExposure>& exposures, const std::string& key, 
+		const RiskLimits& limits, RiskReject side, RiskReject security, RiskReject total) {
+		uint64_t sideQty = 0, securityQty = 0, totalQty = 0;
+		auto it = exposures.find(key);
+		if (it != exposures.end()) {
+			sideQty = isBuy ? it->second.buy : it->second.sell;
+			totalQty = it->second.total();
+			auto lots = it->second.securities.find(order.m_securityId);
+			if (lots != it->second.securities.end())
+				securityQty = lots->second;
+		}
+		if (sideQty + qty > limits.maxSideQty)
+			return side;
+		if (securityQty + qty > limits.maxSecurityQty)
+			return security;
+		if (totalQty + qty > limits.maxTotalQty)
+			return total;
+		return RiskReject::None;
+	};
+
+	const RiskReject reject = check(_userExposures, order.m_user, _userLimits, 
+		RiskReject::UserSideLimit, RiskReject::UserSecurityLimit, RiskReject::UserTotalLimit);
+	if (reject != RiskReject::None)
+		return reject;
+	return check(_companyExposures, order.m_company, _companyLimits, 
+		RiskReject::CompanySideLimit, RiskReject::CompanySecurityLimit, RiskReject::CompanyTotalLimit);
+}
+
+
+/// <summary>
+/// Adds the working lots delta of the order to its user and company aggregates (risk checks) [PRIVATE - auxiliar function]
+/// Remark: O(1) - no lookups (the order points to its aggregates); the concurrent matching walk holds "_riskMutex"
+/// </summary>
+/// <param name="order">The order.</param>
+/// <param name="qty">The working lots delta.</param>
+void OrderCache::addExposure(Order& order, int64_t qty) {
+	if (!order.m_userRisk || qty == 0)
+		return;
+
+	const bool isBuy = order.m_side != "Sell";
+	(isBuy ? order.m_userRisk->buy : order.m_userRisk->sell) += qty;
+	(isBuy ? order.m_companyRisk->buy : order.m_companyRisk->sell) += qty;
+	*order.m_userSecurityRisk += qty;
+	*order.m_companySecurityRisk += qty;
+}
+
+
+/// <summary>
+/// Schedules the order expiry on the timing wheel, if any [PRIVATE - auxiliar function]
+/// Remark: O(1)
+/// </summary>
+/// <param name="ptr">The order pointer.</param>
+void OrderCache::scheduleExpiry(order_ptr& ptr) {
+	const uint64_t expiry = ptr->expiry();
+	if (expiry == Order::GOOD_TILL_CANCEL)
+		return;
+
+	if (expiry == Order::GOOD_FOR_DAY) {
+		ptr->m_expiryBucket = (uint32_t)_expiryWheel.size() - 1;
+		addMember(_expiryWheel.back(), ptr, &Order::m_expirySlot);
+		return;
+	}
+
+	// past expiries on the next tick
+	placeExpiry(ptr, std::max(expiryTick(expiry), _expiryTick + 1));
+}
+
+
+/// <summary>
+/// Places the order on the timing wheel: the lowest level whose range covers the distance to the 
+/// current tick, at the slot of the expiry tick on that level (overflow bucket beyond the wheel range),
+/// i.e. the order is moved down (cascaded) once per level until the level 0 slot expires it [PRIVATE - auxiliar function]
+/// Remark: O(1)
+/// </summary>
+/// <param name="ptr">The order pointer.</param>
+/// <param name="tick">The expiry tick (not before the current tick).</param>
+void OrderCache::placeExpiry(order_ptr& ptr, uint64_t tick) {
+	const uint64_t delta = tick - _expiryTick;
+
+	unsigned int level = 0;
+	while (level < EXPIRY_WHEEL_LEVELS && (delta >> (EXPIRY_WHEEL_BITS * (level + 1))) != 0)
+		level++;
+
+	uint32_t bucket = level << EXPIRY_WHEEL_BITS;
+	if (level < EXPIRY_WHEEL_LEVELS)
+		bucket += (uint32_t)((tick >> (EXPIRY_WHEEL_BITS * level)) & ((1u << EXPIRY_WHEEL_BITS) - 1));
+
+	ptr->m_expiryBucket = bucket;
+	addMember(_expiryWheel[bucket], ptr, &Order::m_expirySlot);
+	_expiryCounts[level]++;
+}
+
+
+/// <summary>
+/// Removes the order from its timing wheel bucket, if any (the last order takes its position) [PRIVATE - auxiliar function]
+/// Remark: O(1)
+/// </summary>
+/// <param name="ptr">The order pointer.</param>
+void OrderCache::unscheduleExpiry(order_ptr& ptr) {
+	const uint32_t bucket = ptr->m_expiryBucket;
+	if (bucket == UINT32_MAX)
+		return;
+
+	ptr->m_expiryBucket = UINT32_MAX;
+	order_list& members = _expiryWheel[bucket];
+	const uint32_t position = ptr->m_expirySlot;
+	if (position >= members.size() || members[position] != ptr)
+		return;
+
+	members[position] = members.back();
+	members[position]->m_expirySlot = position;
+	members.pop_back();
+
+	if (bucket + 1 < _expiryWheel.size())
+		_expiryCounts[bucket >> EXPIRY_WHEEL_BITS]--;
+}
+
+
+/// <summary>
+/// Advances the timing wheel up to the specified tick, collecting the expired orders. Each step 
+/// jumps to the next tick with work (the next level 0 tick, or the next slot boundary of the lowest 
+/// non-empty level), cascades the wrapped levels down and expires the level 0 slot [PRIVATE - auxiliar function]
+/// Remark: O(1) amortized per expired order (plus one step per non-empty slot boundary)
+/// </summary>
+/// <param name="tick">The target tick.</param>
+/// <param name="expired">The expired orders (output).</param>
+void OrderCache::advanceExpiry(uint64_t tick, order_list& expired) {
+	constexpr uint64_t mask = (1u << EXPIRY_WHEEL_BITS) - 1;
+	const uint32_t overflow = EXPIRY_WHEEL_LEVELS << EXPIRY_WHEEL_BITS;
+
+	// moves the bucket orders down to their current level (or out)
+	auto cascade = [&](uint32_t bucket, unsigned int level) {
+		order_list orders = std::move(_expiryWheel[bucket]);
+		_expiryWheel[bucket].clear();
+		_expiryCounts[level] -= orders.size();
+		for (order_ptr& ptr : orders)
+			placeExpiry(ptr, std::max(expiryTick(ptr->expiry()), _expiryTick));
+	};
+
+	while (_expiryTick < tick) {
+		unsigned int level = 0;
+		while (level < EXPIRY_WHEEL_LEVELS && _expiryCounts[level] == 0)
+			level++;
+
+		if (level == EXPIRY_WHEEL_LEVELS) {
+			if (_expiryCounts[level] == 0) {
+				_expiryTick = tick;
+				break;
+			}
+			
+			// only far expiries: jumps next to the earliest one (or to the target)
+			uint64_t earliest = UINT64_MAX;
+			for (order_ptr& ptr : _expiryWheel[overflow])
+				earliest = std::min(earliest, expiryTick(ptr->expiry()));
+			// remark: the orders are placed again relative to the new tick
+			_expiryTick = earliest > tick ? tick : std::max(_expiryTick, earliest - 1);
+			cascade(overflow, EXPIRY_WHEEL_LEVELS);
+			continue;
+		}
+
+		// next tick with work (remark: level boundaries are also boundaries of the lower levels)
+		const uint64_t span = 1ull << (EXPIRY_WHEEL_BITS * level);
+		_expiryTick = std::min(tick, (_expiryTick / span + 1) * span);
+
+		// cascades the wrapped levels, from the overflow bucket down to level 1
+		if (_expiryCounts[EXPIRY_WHEEL_LEVELS] && (_expiryTick & ((1ull << (EXPIRY_WHEEL_BITS * EXPIRY_WHEEL_LEVELS)) - 1)) == 0)
+			cascade(overflow, EXPIRY_WHEEL_LEVELS);
+		for (unsigned int wrapped = EXPIRY_WHEEL_LEVELS - 1; wrapped >= 1; wrapped--) {
+			const unsigned int shift = EXPIRY_WHEEL_BITS * wrapped;
+			if ((_expiryTick & ((1ull << shift) - 1)) == 0)
+				cascade((wrapped << EXPIRY_WHEEL_BITS) + (uint32_t)((_expiryTick >> shift) & mask), wrapped);
+		}
+
+		// expires the level 0 slot
+		order_list& slot = _expiryWheel[_expiryTick & mask];
+		_expiryCounts[0] -= slot.size();
+		for (order_ptr& ptr : slot) {
+			ptr->m_expiryBucket = UINT32_MAX;
+			expired.push_back(ptr);
+		}
+		slot.clear();
+	}
+}
+
+
+/// <summary>
+/// Removes the expired orders in bulk, reusing the mass cancels machinery [PRIVATE - auxiliar function]
+/// </summary>
+/// <param name="expired">The expired orders (already unscheduled).</param>
+void OrderCache::removeExpired(order_list& expired) {
+	if (expired.empty())
+		return;
+
+	// lazy matching: the pending orders of the affected securities are matched before the books change
+	settleOrders(expired);
+	cancelOrders(expired, 0);
+}
+
+
+/// <summary>
+/// Removes the order from the security orders index and, at the same position, from the 
+/// security quantities (the last order takes its position) [PRIVATE - auxiliar function]
+/// Remark: O(1)
+/// </summary>
+/// <param name="ptr">The order pointer.</param>
+void OrderCache::removeSecurityMember(order_ptr& ptr) {
+	auto it = _securityOrdersIndex.find(ptr->securityId());
+	if (it == _securityOrdersIndex.end())
+		return;
+
+	const order_list& members = it->second;
+	const uint32_t position = ptr->m_securitySlot;
+	if (position < members.size() && members[position] == ptr) {
+		quantity_list& quantities = _securityQuantities[ptr->securityId()];
+		quantities[position] = quantities.back();
+		quantities.pop_back();
+	}
+	removeMember(_securityOrdersIndex, ptr->securityId(), ptr, &Order::m_securitySlot);
+}
+
+
+/// <summary>
+/// Tombstones the order and removes it from the order identifier index (deferred deletion) [PRIVATE - auxiliar function]
+/// 
+/// Remark: the order stays on the side indexes (skipped by matching), on the user, company, session 
+///         and security indexes (skipped by mass cancels) and on the orders list until "reclaimOrders()" 
+///         runs, so references taken by pinned readers stay valid. The order identifier is unindexed 
+///         right away, so that the identifier can be reused.
+/// </summary>
+/// <param name="ptr">The order pointer.</param>
+void OrderCache::retireOrder(order_ptr& ptr) {
+	ptr->m_cancelled = true;
+	updateSide(sideBook(ptr), ptr);
+	detachOrder(ptr);
+	_tombstones.push_back({ ptr, _epochs.current() });
+}
+
+
+/// <summary>
+/// Gets the security side book of the order [PRIVATE - auxiliar function]
+/// </summary>
+/// <param name="ptr">The order pointer.</param>
+side_book& OrderCache::sideBook(order_ptr& ptr) {
+	return isBuySide(ptr) ?
+		_securityLongOrdersIndex[ptr->securityId()] :
+		_securityShortOrdersIndex[ptr->securityId()];
+}
+
+
+/// <summary>
+/// Appends the order to the side book - O(1) [PRIVATE - auxiliar function]
+/// </summary>
+void OrderCache::pushSide(side_book& book, order_ptr& ptr) {
+	ptr->m_sideSlot = (uint32_t)book.size();
+	book.orders.push_back(ptr);
+	book.working.push_back(ptr->cancelled() ? 0 : ptr->workingQty());
+	book.companies.push_back(ptr->m_companyKey);
+}
+
+
+/// <summary>
+/// Removes the order from the side book, keeping the counterparties ordering - O(n) [PRIVATE - auxiliar function]
+/// </summary>
+void OrderCache::eraseSide(side_book& book, order_ptr& ptr) {
+	const size_t position = ptr->m_sideSlot;
+	if (position >= book.size() || book.orders[position] != ptr)
+		return;
+
+	book.orders.erase(book.orders.begin() + position);
+	book.working.erase(book.working.begin() + position);
+	book.companies.erase(book.companies.begin() + position);
+	for (size_t i = position; i < book.size(); i++)
+		book.orders[i]->m_sideSlot = (uint32_t)i;
+}
+
+
+/// <summary>
+/// Refreshes the order working lots on the side book (0 for cancelled orders) - O(1) [PRIVATE - auxiliar function]
+/// </summary>
+void OrderCache::updateSide(side_book& book, order_ptr& ptr) {
+	const size_t position = ptr->m_sideSlot;
+	if (position < book.size() && book.orders[position] == ptr)
+		book.working[position] = ptr->cancelled() ? 0 : ptr->workingQty();
+}
+
+
+/// <summary>
+/// Gets the vectorized counterparties scan kernel selected for the current CPU ("avx512", "avx2" or "scalar").
+/// </summary>
+const char* OrderCache::matchingKernel() {
+	return matchingDispatch().name;
+}
+
+
+/// <summary>
+/// Selects the vectorized counterparties scan kernel ("avx512", "avx2" or "scalar") for all caches of the process.
+/// </summary>
+/// <param name="name">The kernel name.</param>
+/// <returns>false case the kernel is unknown or not supported by the current CPU (selection unchanged)</returns>
+bool OrderCache::setMatchingKernel(const std::string& name) {
+	const kernel_dispatch* dispatch = findDispatch(name);
+	if (!dispatch)
+		return false;
+	selectedDispatch().store(dispatch, std::memory_order_relaxed);
+	return true;
+}
+
+
+/// <summary>
+/// Cancels the orders on the specified range
+/// [PRIVATE - auxiliar function: used only at OrderCache::cancelOrders()]
+/// 
+/// Remark: defined for order removal multi-threading approach (maintability and readability)
+/// </summary>
+/// <param name="orders">The orders.</param>
+/// <param name="start">start iterator.</param>
+/// <param name="start">end iterator.</param>
+/// <param name="minQty">Only cancel the specified order if the order quantity if greather than minQty value.</param>
+void OrderCache::cancelOrdersRange(order_list& orders, order_list::iterator start, order_list::iterator end, unsigned int minQty) {
+
+	#ifdef _DEBUG
+	utils::osyncstream out;
+	out << " - starting thread for deleting orders - start id: '" << (*start)->orderId() << "' \n";
+	out.flush();
+	#endif // _DEBUG
+
+	// for each order between the iterators (removes sequentially the chunk)
+	for (order_list::iterator it = start; it != end; it++) {		
+		cancelSingleOrder((*it)->orderId(), minQty, true);
+	}	
+}
+
+
+
+/// <summary>
+/// 
+/// Finds matches for the specified order and store it in cache [PRIVATE]
+/// 
+/// This is the O(n) implementation of "Unsorted Greedy" order pair matching (Algorithm 1, page 31)
+/// as described in Jonsou, V. and Steen, A. (2023), 
+/// available at <https://www.diva-portal.org/smash/get/diva2:1765801/FULLTEXT01.pdf> 
+/// 
+/// This function can used to:
+///    - searches for matches at "getMatchingSizeForSecurity()" (multithread), case USE_CACHED_MATCHING_AT_ADD_ORDER is NOT defined
+///    - searches for matches at "addOrder()", case macro USE_CACHED_MATCHING_AT_ADD_ORDER is defined
+///      
+/// On second approach, the matches values are stored in cached, and the method "getMatchingSizeForSecurity()"
+/// itself workes with O(1)
+/// 
+/// see file at "./docs/paper.pdf"
+/// </summary>
+/// <param name="orderId">The order identifier.</param>
+unsigned int OrderCache::matchOrderInCache(order_ptr& order, bool lockOrder, uint64_t horizon) {
+
+	#ifdef _DEBUG 
+	auto start = debug::TestUtils::tic();
+	utils::osyncstream out;
+	if (_verbose)
+		out << " - OrderCache::matchOrderInCache()\n";
+	#endif // _DEBUG
+
+	// locks the current order only!! 
+	// Others order can be written by other threads!
+	if (lockOrder)
+		order->lock();
+
+	if (order->isFilled() || order->cancelled()) {
+		// already filled (or cancelled): nothing to do!
+		// release order and return immediately (0 matched lots)
+		#ifdef _DEBUG 
+		if (_verbose)
+			out << "  order already filled! [working lots: " << order->workingQty() << "\n";
+		#endif // _DEBUG
+
+		if (lockOrder)
+			order->unlock();
+		
+		return 0;
+	}
+
+	#ifdef _DEBUG	
+	if (_verbose) {
+		debug::TestUtils::print(out, "*");
+		out << " - searching for matches (i.e. after add) and storing it in cache: \n   " << order->str() << '\n';
+	}
+	#endif // _DEBUG
+
+	// gets possible counterparties for the specified order 
+	// (defined by order security and "buy/sell" side)
+	const bool isBuy = isBuySide(order);	
+
+	// - uses sell counterparties to matches buy orders
+	// - uses buy counterparties to matches sell orders
+	side_book& counterParties = isBuy ?
+		_securityShortOrdersIndex[order->securityId()] :
+		_securityLongOrdersIndex[order->securityId()];
+
+
+	if (!counterParties.size()) {
+		// no counterparties to match!		
+		#ifdef _DEBUG
+		if (_verbose) {
+			out << "   No " << (isBuy ? "Sell" : "Buy") << " counterparties for match on security: " << order->securityId() << '\n';
+			debug::TestUtils::print(out, "*");
+		}
+		#endif // _DEBUG
+		// release order and return immediately (0 matched lots)
+		if (lockOrder)
+			order->unlock();
+		return 0;
+	}
+
+	#ifdef _DEBUG
+	// list all counterparties for specified order
+	if (_verbose) {
+		out << "   avaliable (possible) counterparties:\n";
+		debug::TestUtils::print(out, counterParties.orders, 6);
+	} 
+	#endif // _DEBUG
+
+
+	unsigned int matchedQuantity = 0;
+	int counter = 0;
+
+	// counterparties visible to the order (lazy matching: arrived before the horizon, 
+	// i.e. the leading side book positions, sorted by arrival)
+	const size_t visible = horizon == UINT64_MAX ? counterParties.size() :
+		(size_t)(std::partition_point(counterParties.orders.begin(), counterParties.orders.end(),
+			[horizon](const order_ptr& o) { return o->m_arrival <= horizon; }) - counterParties.orders.begin());
+
+#ifdef EXTENDED_INTERFACE
+	// fills of the security (deal information)
+	const uint32_t fillSecurity = fillKey(order->securityId(), lockOrder);
+#endif //EXTENDED_INTERFACE
+
+	const bool vectorized = !lockOrder && _vectorizedMatching;
+	if (vectorized) {
+		//
+		// vectorized scan over the side book arrays (working lots and company), 
+		// same fills of the orders walk (bellow), applied afterwards on the orders
+		//
+		thread_local std::vector<side_fill> fills;
+		if (fills.size() < visible)
+			fills.resize(visible);
+
+		size_t count = 0;
+		matchedQuantity = matchingDispatch().kernel(counterParties.working.data(), counterParties.companies.data(), 0, 
+			visible, order->m_companyKey, order->workingQty(), fills.data(), count);
+		order->fillLots(matchedQuantity);
+		addExposure(*order, -(int64_t)matchedQuantity);
+		if (matchedQuantity > 0)
+			recordChange(*order);
+
+		for (size_t i = 0; i < count; i++) {
+			order_ptr& counterPartyOrder = counterParties.orders[fills[i].position];
+			counterPartyOrder->fillLots(fills[i].qty);
+			addExposure(*counterPartyOrder, -(int64_t)fills[i].qty);
+			recordChange(*counterPartyOrder);
+
+			#ifdef _DEBUG
+			if (_verbose)
+				out << " - Matched " << fills[i].qty << " lots with counterparty: " << counterPartyOrder->str() << '\n';
+			#endif // _DEBUG
+
+#ifdef EXTENDED_INTERFACE
+			// stores deal information - Extended feature (not required for the proposed problem)
+			storeFill(fillSecurity, isBuy ?
+				OrderFill{ order->orderId(), counterPartyOrder->orderId(), fills[i].qty } :
+				OrderFill{ counterPartyOrder->orderId(), order->orderId(), fills[i].qty });
+#endif //EXTENDED_INTERFACE
+		}
+	}
+
+	// for each possible counterparty order (orders walk)
+	for (size_t position = 0; !vectorized && position < visible; position++) {
+		order_ptr& counterPartyOrder = counterParties.orders[position];
+		
+		// locks the counterparty order candidate
+		if (lockOrder)
+			counterPartyOrder->lock();
+		
+		#ifdef _DEBUG
+		if (_verbose)
+			out << "  checking counterparty: " << counterPartyOrder->str() << '\n';
+		#endif // _DEBUG	 
+
+		// company cannot trade with itself (no internal trades): skip orders from same company!
+		if (counterPartyOrder->isFilled() 
+			|| counterPartyOrder->cancelled()
+			|| order->company() == counterPartyOrder->company()) {
+
+			#ifdef _DEBUG
+			if (_verbose) {
+				out << "   skipping conterparty: ";
+				if (order->company() == counterPartyOrder->company())
+					out << "same company [" << order->company() << "]\n";
+				else
+					out << "no remaining position [" << counterPartyOrder->workingQty() << "]\n";
+			}
+			#endif
+
+			// unlock and skip counterparty
+			if (lockOrder)
+				counterPartyOrder->unlock();
+			continue;
+		}
+		// gets the tradable quantity of lots between current buy and sell order
+		// i.e., the counterparties should have at LEAST the same working quantity in order to trade!
+		unsigned int qty = std::min(order->workingQty(), counterPartyOrder->workingQty());
+		if (qty == 0) {
+
+			#ifdef _DEBUG
+			if (_verbose) {
+				out << " - no matches (0 lots) for:\n";
+				out << "       order:        " << order->str() << '\n';
+				out << "       counterparty: " << counterPartyOrder->str() << '\n';
+			}
+			#endif // _DEBUG
+			counterPartyOrder->unlock();
+			continue;
+		}
+
+		#ifdef _DEBUG
+		if (_verbose) {
+			out << " - Matched " << qty << " lots:\n";
+			out << "   order:        " << order->str() << '\n';
+			out << "   counterparty: " << counterPartyOrder->str() << '\n';
+		}
+		#endif // _DEBUG
+
+		// partially fill orders (i.e., on "qty" lots)
+		order->fillLots(qty);
+		counterPartyOrder->fillLots(qty);
+		if (_riskChecks) {
+			// the aggregates are shared by the matching threads (concurrent walk)
+			std::unique_lock<std::mutex> riskLock(_riskMutex, std::defer_lock);
+			if (lockOrder)
+				riskLock.lock();
+			addExposure(*order, -(int64_t)qty);
+			addExposure(*counterPartyOrder, -(int64_t)qty);
+		}
+		recordChange(*order, lockOrder);
+		recordChange(*counterPartyOrder, lockOrder);
+		counterParties.working[position] = counterPartyOrder->workingQty();
+		counterPartyOrder->unlock();
+	
+		matchedQuantity += qty;
+
+#ifdef EXTENDED_INTERFACE
+		//
+		// stores deal information - Extended feature (not required for the proposed problem)
+		//
+		OrderFill filledOrder = isBuy ?
+			OrderFill{ order->orderId(), counterPartyOrder->orderId(), qty } :
+			OrderFill{ counterPartyOrder->orderId(), order->orderId(), qty };
+		
+		// just stores deal information
+		storeFill(fillSecurity, std::move(filledOrder), lockOrder);
+
+#endif //EXTENDED_INTERFACE
+		
+
+		#ifdef _DEBUG
+		if (_verbose) {
+			out << " - after match : \n";
+			out << "   order:        " << order->str() << '\n';
+			out << "   counterparty: " << counterPartyOrder->str() << '\n';
+			out << "   total matched quantity on order '" << order->orderId() << "': " << matchedQuantity << " lots\n";
+		}
+		#endif // _DEBUG
+
+		if (order->isFilled()) {
+			// the order is filled: all work is done!!!
+			break;
+		}
+	}
+		
+	// refreshes the order working lots on its own side book
+	updateSide(sideBook(order), order);
+
+	if (lockOrder)
+		order->unlock();
+
+	// stores matched quantity of lots on cache (thread safe writing)
+	_matchedQuantityMutex.lock();
+	_matchedQuantity[order->securityId()] += matchedQuantity;
+	if (_volumeSeries && matchedQuantity > 0) {
+		// matched volume series (one clock read per matched order)
+		const uint64_t now = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+		volume_series& series = matchedSeries(_matchedVolume, order->securityId());
+		addVolume(series.seconds, now / 1000000, matchedQuantity);
+		addVolume(series.minutes, now / 60000000, matchedQuantity);
+	}
+	_matchedQuantityMutex.unlock();
+
+
+	#ifdef _DEBUG
+	if (_verbose) {
+		out << "   final matched quantity for order '" << order->orderId() << "': " << matchedQuantity << " lots.\n";
+		out << "   total matched quantity (cached) for security '" << order->securityId() << "': " << getMatchedQuantityInCache(order->securityId()) << " lots.\n";
+		debug::TestUtils::toc(out, start, "   elapsed time: ");
+		debug::TestUtils::print(out, "*");
+	}
+	#endif // _DEBUG
+
+	// ************* HERE *****************
+
+	return matchedQuantity;
+}
+
+
+void OrderCache::matchOrderInPool(order_ptr& ptr){
+
+	matchOrderInCache(std::ref(ptr), true);
+
+	// task is done, remove thread from pool
+	if (_ThreadPool.size() == 0)
+		return;
+
+	std::lock_guard<std::mutex> lock(_ThreadPoolMutex);
+	_ThreadPool.erase(
+		std::find_if(_ThreadPool.begin(), _ThreadPool.end(),
+			[](std::thread& x)
+			{
+				if (x.get_id() == std::this_thread::get_id())
+				{
+					// detach inside running thread
+					x.detach(); 
+					return true;
+				}
+				return false;
+			})
+	);
+}
+
+
+/// <summary>
+/// Gets the current cached matched quantity by security (thread-safe).
+/// </summary>
+/// <param name="securityId">The security identifier.</param>
+/// <returns></returns>
+unsigned int OrderCache::getMatchedQuantityInCache(const std::string& securityId) const {
 	
-	// removes order indexes (optimized for the order matching procedure)
-	std::shared_mutex& mtx = isBuySide(ptr) ?
-		_longOrdersMutex : _shortOrdersMutex;
+	// locks for reading values
+	_matchedQuantityMutex.lock_shared();	
+
+	// remark: retunrs 0 in case of the security identifier was not found
+	unsigned int value = (_matchedQuantity.count(securityId) == 0) ? 0 :
+		_matchedQuantity.at(securityId);
+
+	_matchedQuantityMutex.unlock_shared();
+
+	return value;
+}
+
+
+
+/// <summary>
+/// Copies the orders and the matched quantities into an empty order cache (without locks - thread unsafe).
+/// Remark: the orders are copied as they are (i.e. without matching again)
+/// </summary>
+/// <param name="target">The target cache.</param>
+void OrderCache::copyTo(OrderCache& target) const {
+
+	target._numericOrderIds = _numericOrderIds;
+	target._expiryTick = _expiryTick;
+	
+	// from the oldest to the newest order (orders are stored at front), 
+	// i.e. keeps the counterparties ordering of the matching indexes
+	for (auto it = _orders.rbegin(); it != _orders.rend(); ++it)
+		if (!it->cancelled())
+			target.insertOrder(it->clone());
+
+	// remark: element-wise (the allocators - memory counters - are not propagated)
+	for (const auto& matched : _matchedQuantity)
+		target._matchedQuantity.insert(matched);
+	target._volumeSeries = _volumeSeries;
+	for (const auto& series : _matchedVolume) {
+		volume_series& copy = matchedSeries(target._matchedVolume, series.first);
+		copy.seconds.assign(series.second.seconds.cbegin(), series.second.seconds.cend());
+		copy.minutes.assign(series.second.minutes.cbegin(), series.second.minutes.cend());
+	}
+
+	for (const auto& key : _fillSecurityKeys)
+		target._fillSecurityKeys.insert(key);
+	for (const order_fill_chunks& fills : _securityFills)
+		target._securityFills.emplace_back(fills.cbegin(), fills.cend(), order_fill_chunks::allocator_type(&target._orderMatchesMemory));
+	for (const fill_handle& handle : _orderMatches)
+		target._orderMatches.push_back(handle);
+}
+
+
+/// <summary>
+/// Sends the mutation to the read replica, if any (under the orders write lock).
+/// </summary>
+/// <param name="mutation">The mutation.</param>
+void OrderCache::publish(OrderMutation&& mutation) {
+	if (_replica)
+		_replica->push(std::move(mutation));
+}
+
+
+
+/********************************************************************************************************************************
+
+														LOW LATENCY MEMORY ARENA
+
+********************************************************************************************************************************/
+
+
+/// <summary>
+/// Gets the process page faults counters
+/// </summary>
+utils::page_faults utils::page_faults::current() {
+	page_faults faults;
+	#ifdef _WIN32
+	// remark: no minor/major distinction (soft and hard faults)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		faults.minor = counters.PageFaultCount;
+	#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+		faults.minor = (size_t)usage.ru_minflt;
+		faults.major = (size_t)usage.ru_majflt;
+	}
+	#endif
+	return faults;
+}
+
+
+/// <summary>
+/// Maps and prefaults the arena (rounded to huge pages), locking it in memory if required:
+///  - explicit huge pages ("MAP_HUGETLB" / "MEM_LARGE_PAGES"), if configured on the host
+///  - otherwise standard pages with transparent huge pages advice ("MADV_HUGEPAGE")
+/// </summary>
+/// <param name="bytes">The arena size.</param>
+/// <param name="lock">true to lock the arena in memory.</param>
+/// <returns>true case the arena was mapped.</returns>
+bool utils::memory_arena::reserve(size_t bytes, bool lock) {
+
+	release();
+	bytes = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+	if (!bytes)
+		return false;
+
+	#ifdef _WIN32
+	// remark: large pages require the "lock pages in memory" privilege (always locked)
+	void* base = VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+	if (base) {
+		m_pages = page_mode::huge;
+		m_locked = true;
+	}
+	else {
+		base = VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		if (!base)
+			return false;
+		m_pages = page_mode::standard;
+	}
+	#else
+	void* base = MAP_FAILED;
+	#ifdef MAP_HUGETLB
+	base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	m_pages = page_mode::huge;
+	#endif
+	if (base == MAP_FAILED) {
+		// no huge pages reserved on the host (e.g. "vm.nr_hugepages"): transparent huge pages advice
+		base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (base == MAP_FAILED)
+			return false;
+		m_pages = page_mode::standard;
+		#ifdef MADV_HUGEPAGE
+		if (madvise(base, bytes, MADV_HUGEPAGE) == 0)
+			m_pages = page_mode::transparent;
+		#endif
+	}
+	#endif
+
+	m_base = (char*)base;
+	m_bytes = bytes;
+	m_used = 0;
+	std::fill(std::begin(m_free), std::end(m_free), nullptr);
+
+	// prefaults the arena (touches every standard page)
+	volatile char* page = m_base;
+	for (size_t offset = 0; offset < bytes; offset += 4096)
+		page[offset] = 0;
+
+	if (lock && !m_locked) {
+		#ifdef _WIN32
+		m_locked = VirtualLock(base, bytes) != 0;
+		#else
+		m_locked = mlock(base, bytes) == 0;
+		#endif
+	}
+	return true;
+}
+
+
+/// <summary>
+/// Unmaps the arena (all blocks are released)
+/// </summary>
+void utils::memory_arena::release() {
+	if (m_base) {
+		#ifdef _WIN32
+		VirtualFree(m_base, 0, MEM_RELEASE);
+		#else
+		if (m_locked)
+			munlock(m_base, m_bytes);
+		munmap(m_base, m_bytes);
+		#endif
+	}
+	m_base = nullptr;
+	m_bytes = 0;
+	m_used = 0;
+	m_pages = page_mode::none;
+	m_locked = false;
+	std::fill(std::begin(m_free), std::end(m_free), nullptr);
+}
+
+
+
+/********************************************************************************************************************************
+
+														READ REPLICA
+
+********************************************************************************************************************************/
+
+
+namespace {
+	/// <summary>
+	/// Gets the steady clock time (microseconds)
+	/// </summary>
+	inline long long steadyMicroseconds(std::chrono::steady_clock::time_point time) {
+		return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+	}
+}
+
+
+/// <summary>
+/// Initializes a new instance of the <see cref="OrderCacheReplica"/> class, attached to the
+/// primary cache (current primary orders are copied to the follower).
+/// </summary>
+/// <param name="primary">The primary cache (must outlive the replica).</param>
+/// <param name="queueSize">The mutations queue size.</param>
+OrderCacheReplica::OrderCacheReplica(OrderCache& primary, size_t queueSize) :
+	_primary(primary), _queue(queueSize) {
+
+	{
+		// no mutation on primary while attaching
+		OrderCache::write_lock lock = _primary.lockForUpdateOrders();
+
+		if (_primary._replica) {
+			#ifdef THROW_EXCEPTIONS
+			throw std::logic_error("error attaching read replica: primary cache already has a replica");
+			#else
+			// remark: stays detached (queries return the empty follower state)
+			_running = false;
+			return;
+			#endif
+		}
+
+		_primary.settleAll();
+		_primary.copyTo(_follower);
+		_primary._replica = this;
+	}
+
+	_thread = std::thread([this]() { run(); });
+}
+
+
+/// <summary>
+/// Detaches from the primary cache and stops the follower thread.
+/// </summary>
+OrderCacheReplica::~OrderCacheReplica() {
+	if (!_thread.joinable())
+		return;
+
+	{
+		OrderCache::write_lock lock = _primary.lockForUpdateOrders();
+		_primary._replica = nullptr;
+	}
+
+	_running = false;
+	_thread.join();
+}
+
+
+/// <summary>
+/// Enqueues the mutation (called by the primary, under its write lock).
+/// Remark: never waits for the follower - spills into the overflow buffer case the queue is full
+/// </summary>
+/// <param name="mutation">The mutation.</param>
+void OrderCacheReplica::push(OrderMutation&& mutation) {
+	mutation.timestamp = std::chrono::steady_clock::now();
+	// remark: the primary write lock serializes the producers
+	uint64_t sequence = _published.load(std::memory_order_relaxed) + 1;
+	long long time = steadyMicroseconds(mutation.timestamp);
+	mutation.sequence = sequence;
+
+	// remark: no queue push while overflowing (the overflow buffer holds the newest mutations)
+	if (_overflowing.load(std::memory_order_relaxed) || !_queue.try_push(std::move(mutation))) {
+		std::lock_guard<std::mutex> lock(_overflowMutex);
+		_overflow.push_back(std::move(mutation));
+		_overflowing.store(true, std::memory_order_release);
+		_overflowMutations.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	_publishedTime.store(time, std::memory_order_relaxed);
+	_published.store(sequence, std::memory_order_release);
+}
+
+
+/// <summary>
+/// Follower thread: applies the queued mutations.
+/// </summary>
+void OrderCacheReplica::run() {
+	OrderMutation mutation;
+	std::vector<OrderMutation> overflow;
+	auto follow = [this](OrderMutation& mutation) {
+		apply(mutation);
+		_appliedTime.store(steadyMicroseconds(mutation.timestamp), std::memory_order_relaxed);
+		_applied.store(mutation.sequence, std::memory_order_release);
+	};
+
+	while (true) {
+		// remark: read before the queue - once overflowing, the queued mutations are the oldest ones
+		const bool overflowing = _overflowing.load(std::memory_order_acquire);
+		if (_queue.try_pop(mutation)) {
+			follow(mutation);
+			continue;
+		}
+
+		if (overflowing) {
+			// queue drained: takes the overflow buffer (the primary resumes the queue afterwards)
+			{
+				std::lock_guard<std::mutex> lock(_overflowMutex);
+				overflow.swap(_overflow);
+				_overflowing.store(false, std::memory_order_release);
+			}
+			for (OrderMutation& spilled : overflow)
+				follow(spilled);
+			overflow.clear();
+			continue;
+		}
+
+		// detached: stops once drained
+		if (!_running.load(std::memory_order_acquire))
+			break;
+
+		std::this_thread::yield();
+	}
+}
+
+
+/// <summary>
+/// Applies the mutation on the follower cache.
+/// </summary>
+/// <param name="mutation">The mutation.</param>
+void OrderCacheReplica::apply(OrderMutation& mutation) {
+	#ifdef THROW_EXCEPTIONS
+	// the primary already validated the mutation: follower errors are not expected
+	try {
+	#endif
+	switch (mutation.type) {
+	case MutationType::AddOrder:
+		_follower.addOrder(std::move(*mutation.order));
+		mutation.order.reset();
+		break;
+	case MutationType::CancelOrder:
+		_follower.cancelOrder(mutation.key);
+		break;
+	case MutationType::CancelOrdersForUser:
+		_follower.cancelOrdersForUser(mutation.key);
+		break;
+	case MutationType::CancelOrdersForSecIdWithMinimumQty:
+		_follower.cancelOrdersForSecIdWithMinimumQty(mutation.key, mutation.qty);
+		break;
+	case MutationType::CancelOrdersForCompany:
+		_follower.cancelOrdersForCompany(mutation.key);
+		break;
+	case MutationType::CancelOrdersForSession:
+		_follower.cancelOrdersForSession(mutation.key);
+		break;
+	case MutationType::AmendOrder:
+		_follower.setAmendPolicy(mutation.policy);
+		_follower.amendOrder(mutation.key, mutation.qty);
+		break;
+	case MutationType::ExpireOrders:
+		_follower.expireOrders(mutation.time);
+		break;
+	case MutationType::EndSession:
+		_follower.endSession();
+		break;
+	}
+	#ifdef THROW_EXCEPTIONS
+	}
+	catch (const std::exception&) {
+	}
+	#endif
+}
+
+
+/// <summary>
+/// Waits until the pending mutations are within the maximum lag.
+/// </summary>
+void OrderCacheReplica::waitForMaxLag() const {
+	uint64_t maxLag = _maxLag.load(std::memory_order_relaxed);
+	if (maxLag == ULLONG_MAX)
+		return;
+
+	uint64_t target = _published.load(std::memory_order_acquire);
+	target = target > maxLag ? target - maxLag : 0;
+	while (_applied.load(std::memory_order_acquire) < target)
+		std::this_thread::yield();
+}
+
+
+/// <summary>
+/// Waits until the follower applied all mutations published so far.
+/// </summary>
+void OrderCacheReplica::sync() const {
+	uint64_t target = _published.load(std::memory_order_acquire);
+	while (_applied.load(std::memory_order_acquire) < target)
+		std::this_thread::yield();
+}
+
+
+/// <summary>
+/// Gets the current staleness of the follower.
+/// </summary>
+/// <returns></returns>
+ReplicaStaleness OrderCacheReplica::staleness() const {
+	ReplicaStaleness value;
+	uint64_t applied = _applied.load(std::memory_order_acquire);
+	uint64_t published = _published.load(std::memory_order_acquire);
+	value.pendingMutations = published > applied ? published - applied : 0;
+	value.overflowMutations = _overflowMutations.load(std::memory_order_relaxed);
+	if (value.pendingMutations)
+		value.lagMicroseconds = _publishedTime.load(std::memory_order_relaxed) - _appliedTime.load(std::memory_order_relaxed);
+	return value;
+}
+
 
-	order_list& index = isBuySide(ptr) ?
-		_securityLongOrdersIndex[ptr->securityId()] :
-		_securityShortOrdersIndex[ptr->securityId()];
-		
-	index.erase(std::remove_if(index.begin(), index.end(),
-		[&orderId](auto& o) { return o->orderId() == orderId; }));
-		
-	// removes the main order index with O(1) 
-	_orderIndex.erase(orderId);
+/// <summary>
+/// Gets the matching size for security (follower state).
+/// </summary>
+/// <param name="securityId">The security identifier.</param>
+/// <returns></returns>
+unsigned int OrderCacheReplica::getMatchingSizeForSecurity(const std::string& securityId) {
+	waitForMaxLag();
+	return _follower.getMatchingSizeForSecurity(securityId);
+}
 
-	if (lockOrder) 
-		ptr->unlock();
-	
-	// removes the order instance itself with O(1)	
-	_orders.erase(ptr);
-	
-	#ifdef _DEBUG
-	if (exists(orderId)) 
-		out << "WARN: order not deleted: " << orderId << "\n";			
-	else if (_verbose)
-		out << "cache{size: " << size() << "} - order deleted: " << orderId << "\n";
-	
-	out.flush();
-	#endif // _DEBUG
+
+/// <summary>
+/// Gets all orders (follower state).
+/// </summary>
+/// <returns></returns>
+std::vector<Order> OrderCacheReplica::getAllOrders() const {
+	waitForMaxLag();
+	return _follower.getAllOrders();
 }
 
 
+/// <summary>
+/// Checks the order existence by the specified order identifier (follower state).
+/// </summary>
+/// <param name="orderId">The order identifier.</param>
+/// <returns></returns>
+bool OrderCacheReplica::exists(const std::string& orderId) const {
+	waitForMaxLag();
+	OrderCache::read_lock lock = _follower.lockForReadOrders();
+	return _follower.exists(orderId);
+}
+
 
 /// <summary>
-/// Cancels the orders (uses multithreading if required) [PRIVATE - auxiliar function]
+/// Gets the number of orders (follower state).
 /// </summary>
-/// <param name="orders">The order identifiers.</param>
-/// <param name="minQty">Only cancel the specified order if the order quantity if greather than minQty value.</param>
-void OrderCache::cancelOrders(orders_keys& orders, unsigned int minQty) {
+/// <returns></returns>
+size_t OrderCacheReplica::size() const {
+	waitForMaxLag();
+	OrderCache::read_lock lock = _follower.lockForReadOrders();
+	return _follower.size();
+}
 
-	// number of elements in the set of orders identifiers to remove
-	const unsigned int size = (unsigned int)orders.size();
-	// number of threads
-	const unsigned int nthreads = _multiThread ? std::thread::hardware_concurrency() : 1;
-	// the set will be processed in chunks os size:
-	const unsigned int chunkSize = (nthreads == 1 || size <= nthreads) ? size : 1 + ((size - 1) / nthreads);
-	// single thread approach: if required OR the chunk size 
-	// of the vector does not compensate for the thread overhead!		
-	bool singleThreadDelete = !_multiThread || chunkSize < DELETE_CHUNK_SIZE;
 
-	#ifdef _DEBUG
-	utils::osyncstream out;
-	out << "Cancel orders [OrderCache::cancelOrders() - private]: \n";
-	out << " - nthreads: " << nthreads << "\n";
-	out << " - chunk size: " << chunkSize << "\n";
-	out << " - multithread: " << (singleThreadDelete ? "no\n" : "yes\n");
-	out.flush();
-	#endif // _DEBUG
-	
-	singleThreadDelete = true;
 
-	if (singleThreadDelete) {
-		// single thread approach: if required OR the chunk size 
-		// of the vector does not compensate for the thread overhead!		
-		for (auto& orderId : orders) 			
-			cancelSingleOrder(std::ref(orderId), minQty, false);				
+/********************************************************************************************************************************
+
+														SHARED MEMORY ORDER CACHE
+
+********************************************************************************************************************************/
+
+
+namespace shm {
+
+	constexpr uint64_t MAGIC = 0x4F52444552434143ull; // "ORDERCAC"
+	constexpr uint32_t VERSION = 1;
+	constexpr uint32_t NIL = 0xFFFFFFFFu;              // null offset/index
+
+	/// <summary>
+	/// String stored in the segment arena (offset relative to the arena start)
+	/// </summary>
+	struct string_ref {
+		uint32_t offset;
+		uint32_t length;
+	};
+
+	/// <summary>
+	/// Segment header (offsets relative to the segment start)
+	/// </summary>
+	struct header {
+		uint64_t magic;
+		uint32_t version;
+		uint32_t orderCapacity;
+		uint32_t securityCapacity;
+		uint32_t symbolCapacity;
+		uint32_t orderTableMask;
+		uint32_t securityTableMask;
+		uint32_t symbolTableMask;
+		uint64_t arenaBytes;
+		uint64_t recordsOffset;
+		uint64_t orderTableOffset;
+		uint64_t securitiesOffset;
+		uint64_t securityTableOffset;
+		uint64_t symbolTableOffset;
+		uint64_t arenaOffset;
+
+		// seqlock: odd while the writer is mutating the segment
+		alignas(64) std::atomic<uint64_t> sequence;
+
+		uint64_t orders;        // live orders
+		uint64_t arenaUsed;     // arena bump pointer
+		uint32_t recordsUsed;   // records high watermark
+		uint32_t freeRecord;    // free records list head
+		uint32_t securities;    // security records in use
+		uint32_t symbols;       // interned strings
+	};
+
+	/// <summary>
+	/// Order record (linked to the security side lists by record indexes)
+	/// </summary>
+	struct order_record {
+		string_ref orderId;
+		uint32_t idCapacity;    // arena bytes reserved for the order id (reused by the next record owner)
+		uint32_t hash;          // order id hash
+		string_ref securityId;  // interned
+		string_ref side;        // interned
+		string_ref user;        // interned
+		string_ref company;     // interned (same company <=> same offset)
+		uint32_t qty;
+		uint32_t working;
+		uint32_t security;      // security record index
+		uint32_t prev;          // side list links (record indexes)
+		uint32_t next;
+		uint8_t live;
+		uint8_t buy;
+	};
+
+	/// <summary>
+	/// Security record: FIFO side lists (0 = buy, 1 = sell) and cached matched quantity
+	/// </summary>
+	struct security_record {
+		string_ref securityId;
+		uint32_t head[2];
+		uint32_t tail[2];
+		uint32_t orders;
+		uint64_t matched;
+	};
+
+	/// <summary>
+	/// FNV-1a hash
+	/// </summary>
+	inline uint32_t hash(const char* text, size_t length) {
+		uint64_t value = 14695981039346656037ull;
+		for (size_t i = 0; i < length; i++) {
+			value ^= (unsigned char)text[i];
+			value *= 1099511628211ull;
+		}
+		return (uint32_t)(value ^ (value >> 32));
 	}
-	else
-	{
-		//
-		// multithread approach
-		//		
-		std::vector<std::thread> threads;
 
-		// creates a "removal" thread for each order chunk set (of size "chunkSize")
-		utils::chunks(orders.begin(), orders.end(), chunkSize,
-			[&](orders_keys::iterator start, orders_keys::iterator end) {
-				threads.push_back(std::thread(&OrderCache::cancelOrdersRange, this, orders, start, end, minQty));
-			});
-				
-		// waits for all threads to finish
-		for (auto& thread : threads)
-			thread.join();
-	}	
+	inline uint32_t tableSize(uint32_t capacity) {
+		uint32_t size = 16;
+		while (size < 2 * capacity)
+			size <<= 1;
+		return size;
+	}
+
+	inline uint64_t align(uint64_t offset) {
+		return (offset + 63) & ~63ull;
+	}
 }
 
 
 /// <summary>
-/// Cancels the orders on the specified range
-/// [PRIVATE - auxiliar function: used only at OrderCache::cancelOrders()]
-/// 
-/// Remark: defined for order removal multi-threading approach (maintability and readability)
+/// Creates (or replaces) the named segment and opens it for writing.
 /// </summary>
-/// <param name="orders">The order identifiers.</param>
-/// <param name="start">start iterator.</param>
-/// <param name="start">end iterator.</param>
-/// <param name="minQty">Only cancel the specified order if the order quantity if greather than minQty value.</param>
-void OrderCache::cancelOrdersRange(orders_keys& orders, orders_keys::iterator& start, orders_keys::iterator& end, unsigned int minQty) {
+/// <param name="name">The segment name (e.g. "/orders").</param>
+/// <param name="capacity">The segment capacities.</param>
+SharedOrderCache::SharedOrderCache(const std::string& name, const SharedCacheCapacity& capacity) :
+	m_name(name), m_readOnly(false) {
+
+	// segment layout
+	shm::header layout{};
+	layout.magic = shm::MAGIC;
+	layout.version = shm::VERSION;
+	layout.orderCapacity = capacity.orders;
+	layout.securityCapacity = capacity.securities;
+	layout.symbolCapacity = capacity.symbols;
+	layout.orderTableMask = shm::tableSize(capacity.orders) - 1;
+	layout.securityTableMask = shm::tableSize(capacity.securities) - 1;
+	layout.symbolTableMask = shm::tableSize(capacity.symbols) - 1;
+	layout.arenaBytes = std::min<uint64_t>(capacity.arenaBytes, shm::NIL);
+
+	uint64_t offset = shm::align(sizeof(shm::header));
+	layout.recordsOffset = offset;
+	offset = shm::align(offset + (uint64_t)capacity.orders * sizeof(shm::order_record));
+	layout.orderTableOffset = offset;
+	offset = shm::align(offset + (uint64_t)(layout.orderTableMask + 1) * sizeof(uint32_t));
+	layout.securitiesOffset = offset;
+	offset = shm::align(offset + (uint64_t)capacity.securities * sizeof(shm::security_record));
+	layout.securityTableOffset = offset;
+	offset = shm::align(offset + (uint64_t)(layout.securityTableMask + 1) * sizeof(uint32_t));
+	layout.symbolTableOffset = offset;
+	offset = shm::align(offset + (uint64_t)(layout.symbolTableMask + 1) * sizeof(shm::string_ref));
+	layout.arenaOffset = offset;
+	offset += layout.arenaBytes;
+
+	if (!map(true, (size_t)offset)) {
+		#ifdef THROW_EXCEPTIONS
+		throw std::runtime_error("error creating shared memory segment: " + name);
+		#else
+		return;
+		#endif
+	}
 
-	#ifdef _DEBUG
-	utils::osyncstream out;
-	out << " - starting thread for deleting orders - start id: '" << *start << "' \n";
-	out.flush();
-	#endif // _DEBUG
+	// initializes the segment (the sequence stays odd until it is ready)
+	shm::header* header = (shm::header*)m_base;
+	header->sequence.store(1, std::memory_order_relaxed);
+	std::memcpy((char*)header, &layout, offsetof(shm::header, sequence));
+	header->orders = 0;
+	header->arenaUsed = 0;
+	header->recordsUsed = 0;
+	header->freeRecord = shm::NIL;
+	header->securities = 0;
+	header->symbols = 0;
+
+	locate();
+	std::fill(m_orderTable, m_orderTable + layout.orderTableMask + 1, shm::NIL);
+	std::fill(m_securityTable, m_securityTable + layout.securityTableMask + 1, shm::NIL);
+	std::fill(m_symbolTable, m_symbolTable + layout.symbolTableMask + 1, shm::string_ref{ shm::NIL, 0 });
+
+	header->sequence.store(2, std::memory_order_release);
+}
 
-	// for each order between the iterators (removes sequentially the chunk)
-	for (orders_keys::iterator it = start; it != end; it++) {		
-		cancelSingleOrder(*it, minQty, true);
-	}	
+
+/// <summary>
+/// Opens the existing named segment for reading only.
+/// </summary>
+/// <param name="name">The segment name (e.g. "/orders").</param>
+SharedOrderCache::SharedOrderCache(const std::string& name) :
+	m_name(name), m_readOnly(true) {
+
+	if (!map(false, 0) || ((shm::header*)m_base)->magic != shm::MAGIC || ((shm::header*)m_base)->version != shm::VERSION) {
+		unmap();
+		#ifdef THROW_EXCEPTIONS
+		throw std::runtime_error("error opening shared memory segment: " + name);
+		#else
+		return;
+		#endif
+	}
+
+	locate();
 }
 
 
+SharedOrderCache::~SharedOrderCache() {
+	unmap();
+}
+
 
 /// <summary>
+/// Removes the named segment (mapped instances stay valid until closed).
+/// </summary>
+/// <param name="name">The segment name.</param>
+bool SharedOrderCache::remove(const std::string& name) {
+	#ifdef _WIN32
+	// named file mappings are released with their last handle
+	return true;
+	#else
+	return shm_unlink(name.c_str()) == 0;
+	#endif
+}
+
+
+/// <summary>
+/// Maps the named segment [PRIVATE]
+/// </summary>
+/// <param name="create">true to create the segment (writer), false to open it read-only (reader).</param>
+/// <param name="bytes">The segment size (create only).</param>
+bool SharedOrderCache::map(bool create, size_t bytes) {
+	#ifdef _WIN32
+	HANDLE handle = create ?
+		CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((uint64_t)bytes >> 32), (DWORD)bytes, m_name.c_str()) :
+		OpenFileMappingA(FILE_MAP_READ, FALSE, m_name.c_str());
+	if (!handle)
+		return false;
+
+	void* base = MapViewOfFile(handle, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, bytes);
+	if (!base) {
+		CloseHandle(handle);
+		return false;
+	}
+
+	if (!create) {
+		MEMORY_BASIC_INFORMATION info;
+		VirtualQuery(base, &info, sizeof(info));
+		bytes = info.RegionSize;
+	}
+	m_handle = handle;
+	#else
+	if (create)
+		shm_unlink(m_name.c_str());
+
+	int fd = create ?
+		shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644) :
+		shm_open(m_name.c_str(), O_RDONLY, 0);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if ((create && ftruncate(fd, (off_t)bytes) != 0) || (!create && fstat(fd, &info) != 0)) {
+		close(fd);
+		return false;
+	}
+	if (!create)
+		bytes = (size_t)info.st_size;
+
+	void* base = bytes < sizeof(shm::header) ? MAP_FAILED :
+		mmap(nullptr, bytes, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+		return false;
+	#endif
+
+	m_base = base;
+	m_bytes = bytes;
+	return true;
+}
+
+
+/// <summary>
+/// Unmaps the segment [PRIVATE]
+/// </summary>
+void SharedOrderCache::unmap() {
+	if (m_base) {
+		#ifdef _WIN32
+		UnmapViewOfFile(m_base);
+		CloseHandle((HANDLE)m_handle);
+		#else
+		munmap(m_base, m_bytes);
+		#endif
+	}
+	m_base = nullptr;
+	m_handle = nullptr;
+	m_header = nullptr;
+}
+
+
+/// <summary>
+/// Resolves the segment regions from the header offsets [PRIVATE]
+/// </summary>
+void SharedOrderCache::locate() {
+	char* base = (char*)m_base;
+	m_header = (shm::header*)base;
+	m_records = (shm::order_record*)(base + m_header->recordsOffset);
+	m_orderTable = (uint32_t*)(base + m_header->orderTableOffset);
+	m_securities = (shm::security_record*)(base + m_header->securitiesOffset);
+	m_securityTable = (uint32_t*)(base + m_header->securityTableOffset);
+	m_symbolTable = (shm::string_ref*)(base + m_header->symbolTableOffset);
+	m_arena = base + m_header->arenaOffset;
+}
+
+
+void SharedOrderCache::beginWrite() {
+	m_header->sequence.fetch_add(1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+
+void SharedOrderCache::endWrite() {
+	m_header->sequence.fetch_add(1, std::memory_order_release);
+}
+
+
+/// <summary>
+/// Runs the read functor until it observes a consistent snapshot (seqlock, reader side) [PRIVATE]
 /// 
-/// Finds matches for the specified order and store it in cache [PRIVATE]
-/// 
-/// This is the O(n) implementation of "Unsorted Greedy" order pair matching (Algorithm 1, page 31)
-/// as described in Jonsou, V. and Steen, A. (2023), 
-/// available at <https://www.diva-portal.org/smash/get/diva2:1765801/FULLTEXT01.pdf> 
-/// 
-/// This function can used to:
-///    - searches for matches at "getMatchingSizeForSecurity()" (multithread), case USE_CACHED_MATCHING_AT_ADD_ORDER is NOT defined
-///    - searches for matches at "addOrder()", case macro USE_CACHED_MATCHING_AT_ADD_ORDER is defined
-///      
-/// On second approach, the matches values are stored in cached, and the method "getMatchingSizeForSecurity()"
-/// itself workes with O(1)
-/// 
-/// see file at "./docs/paper.pdf"
+/// Remark: the functor may observe torn data (retried), so it must bound all offsets it follows
+/// </summary>
+template <typename Func>
+auto SharedOrderCache::consistentRead(Func functor) const -> decltype(functor()) {
+	while (true) {
+		uint64_t before = m_header->sequence.load(std::memory_order_acquire);
+		if (before & 1) {
+			// writer in progress
+			std::this_thread::yield();
+			continue;
+		}
+
+		auto result = functor();
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (m_header->sequence.load(std::memory_order_relaxed) == before)
+			return result;
+	}
+}
+
+
+/// <summary>
+/// Checks that the current instance can mutate the segment [PRIVATE]
+/// </summary>
+bool SharedOrderCache::checkWritable() const {
+	if (isOpen() && !m_readOnly)
+		return true;
+
+	#ifdef THROW_EXCEPTIONS
+	throw std::logic_error("shared order cache: read-only instance");
+	#else
+	return false;
+	#endif
+}
+
+
+/// <summary>
+/// Copies an arena string (bounded) [PRIVATE]
+/// </summary>
+std::string SharedOrderCache::text(const shm::string_ref& ref) const {
+	if (ref.offset == shm::NIL || (uint64_t)ref.offset + ref.length > m_header->arenaBytes)
+		return std::string();
+	return std::string(m_arena + ref.offset, ref.length);
+}
+
+
+/// <summary>
+/// Compares an arena string (bounded) [PRIVATE]
+/// </summary>
+bool SharedOrderCache::equals(const shm::string_ref& ref, const std::string& value) const {
+	return ref.length == value.size() && ref.offset != shm::NIL
+		&& (uint64_t)ref.offset + ref.length <= m_header->arenaBytes
+		&& std::memcmp(m_arena + ref.offset, value.data(), ref.length) == 0;
+}
+
+
+/// <summary>
+/// Copies the string into the arena (bump allocation) [PRIVATE]
+/// </summary>
+bool SharedOrderCache::allocate(const std::string& value, shm::string_ref& ref) {
+	if (m_header->arenaUsed + value.size() > m_header->arenaBytes)
+		return false;
+	ref.offset = (uint32_t)m_header->arenaUsed;
+	ref.length = (uint32_t)value.size();
+	std::memcpy(m_arena + ref.offset, value.data(), value.size());
+	m_header->arenaUsed += value.size();
+	return true;
+}
+
+
+/// <summary>
+/// Gets the arena copy of the string, storing it once (security, side, user, company) [PRIVATE]
+/// </summary>
+bool SharedOrderCache::intern(const std::string& value, shm::string_ref& ref) {
+	uint32_t mask = m_header->symbolTableMask;
+	for (uint32_t slot = shm::hash(value.data(), value.size()) & mask; ; slot = (slot + 1) & mask) {
+		shm::string_ref& entry = m_symbolTable[slot];
+		if (entry.offset == shm::NIL) {
+			if (m_header->symbols >= m_header->symbolCapacity || !allocate(value, entry))
+				return false;
+			m_header->symbols++;
+			ref = entry;
+			return true;
+		}
+		if (equals(entry, value)) {
+			ref = entry;
+			return true;
+		}
+	}
+}
+
+
+/// <summary>
+/// Gets the arena offset of the interned string (NIL if not interned) [PRIVATE]
+/// </summary>
+uint32_t SharedOrderCache::findSymbol(const std::string& value) const {
+	uint32_t mask = m_header->symbolTableMask;
+	uint32_t slot = shm::hash(value.data(), value.size()) & mask;
+	for (uint32_t probes = 0; probes <= mask; probes++, slot = (slot + 1) & mask) {
+		const shm::string_ref& entry = m_symbolTable[slot];
+		if (entry.offset == shm::NIL)
+			return shm::NIL;
+		if (equals(entry, value))
+			return entry.offset;
+	}
+	return shm::NIL;
+}
+
+
+/// <summary>
+/// Gets the order table slot of the specified order id (NIL if not found) [PRIVATE]
+/// </summary>
+uint32_t SharedOrderCache::findOrder(const std::string& orderId) const {
+	uint32_t mask = m_header->orderTableMask;
+	uint32_t hash = shm::hash(orderId.data(), orderId.size());
+	uint32_t slot = hash & mask;
+	for (uint32_t probes = 0; probes <= mask; probes++, slot = (slot + 1) & mask) {
+		uint32_t index = m_orderTable[slot];
+		if (index == shm::NIL)
+			return shm::NIL;
+		if (index < m_header->orderCapacity && m_records[index].hash == hash && equals(m_records[index].orderId, orderId))
+			return slot;
+	}
+	return shm::NIL;
+}
+
+
+/// <summary>
+/// Gets the order table slot of the specified live record, probing from its stored hash (no id copy or rehash) [PRIVATE]
+/// </summary>
+uint32_t SharedOrderCache::findRecordSlot(uint32_t index) const {
+	uint32_t mask = m_header->orderTableMask;
+	uint32_t slot = m_records[index].hash & mask;
+	for (uint32_t probes = 0; probes <= mask; probes++, slot = (slot + 1) & mask) {
+		if (m_orderTable[slot] == index)
+			return slot;
+		if (m_orderTable[slot] == shm::NIL)
+			return shm::NIL;
+	}
+	return shm::NIL;
+}
+
+
+/// <summary>
+/// Gets the security record index of the specified security id (NIL if not found) [PRIVATE]
+/// </summary>
+uint32_t SharedOrderCache::findSecurity(const std::string& securityId) const {
+	uint32_t mask = m_header->securityTableMask;
+	uint32_t slot = shm::hash(securityId.data(), securityId.size()) & mask;
+	for (uint32_t probes = 0; probes <= mask; probes++, slot = (slot + 1) & mask) {
+		uint32_t index = m_securityTable[slot];
+		if (index == shm::NIL)
+			return shm::NIL;
+		if (index < m_header->securityCapacity && equals(m_securities[index].securityId, securityId))
+			return index;
+	}
+	return shm::NIL;
+}
+
+
+/// <summary>
+/// Gets (or creates) the security record of the specified security id (NIL if full) [PRIVATE]
+/// </summary>
+uint32_t SharedOrderCache::addSecurity(const std::string& securityId) {
+	uint32_t index = findSecurity(securityId);
+	if (index != shm::NIL)
+		return index;
+
+	shm::string_ref ref;
+	if (m_header->securities >= m_header->securityCapacity || !intern(securityId, ref))
+		return shm::NIL;
+
+	index = m_header->securities++;
+	shm::security_record& security = m_securities[index];
+	security.securityId = ref;
+	security.head[0] = security.head[1] = security.tail[0] = security.tail[1] = shm::NIL;
+	security.orders = 0;
+	security.matched = 0;
+
+	uint32_t mask = m_header->securityTableMask;
+	uint32_t slot = shm::hash(securityId.data(), securityId.size()) & mask;
+	while (m_securityTable[slot] != shm::NIL)
+		slot = (slot + 1) & mask;
+	m_securityTable[slot] = index;
+	return index;
+}
+
+
+/// <summary>
+/// Removes the order table slot (linear probing backward shift deletion) [PRIVATE]
+/// </summary>
+void SharedOrderCache::eraseOrderSlot(uint32_t slot) {
+	uint32_t mask = m_header->orderTableMask;
+	uint32_t next = slot;
+	while (true) {
+		next = (next + 1) & mask;
+		uint32_t index = m_orderTable[next];
+		if (index == shm::NIL)
+			break;
+		// moves back the entry unless its home slot lies cyclically in (slot, next]
+		uint32_t home = m_records[index].hash & mask;
+		bool inRange = slot <= next ? (slot < home && home <= next) : (slot < home || home <= next);
+		if (inRange)
+			continue;
+		m_orderTable[slot] = index;
+		slot = next;
+	}
+	m_orderTable[slot] = shm::NIL;
+}
+
+
+/// <summary>
+/// Unlinks the order record from its side list and frees it (writer, inside beginWrite/endWrite) [PRIVATE]
+/// </summary>
+void SharedOrderCache::cancelRecord(uint32_t index) {
+	shm::order_record& record = m_records[index];
+	shm::security_record& security = m_securities[record.security];
+	int side = record.buy ? 0 : 1;
+
+	if (record.prev != shm::NIL)
+		m_records[record.prev].next = record.next;
+	else
+		security.head[side] = record.next;
+
+	if (record.next != shm::NIL)
+		m_records[record.next].prev = record.prev;
+	else
+		security.tail[side] = record.prev;
+
+	security.orders--;
+	m_header->orders--;
+
+	// records free list (the order id arena space is kept for the next owner)
+	record.live = 0;
+	record.prev = shm::NIL;
+	record.next = m_header->freeRecord;
+	m_header->freeRecord = index;
+}
+
+
+/// <summary>
+/// Matches the order against the opposite side list (unsorted greedy, as OrderCache::matchOrderInCache()) [PRIVATE]
+/// </summary>
+void SharedOrderCache::match(uint32_t index) {
+	shm::order_record& order = m_records[index];
+	shm::security_record& security = m_securities[order.security];
+	uint64_t matched = 0;
+
+	for (uint32_t other = security.head[order.buy ? 1 : 0]; other != shm::NIL && order.working > 0; other = m_records[other].next) {
+		shm::order_record& counterParty = m_records[other];
+
+		// company cannot trade with itself (interned strings: same offset)
+		if (counterParty.working == 0 || counterParty.company.offset == order.company.offset)
+			continue;
+
+		uint32_t qty = std::min(order.working, counterParty.working);
+		order.working -= qty;
+		counterParty.working -= qty;
+		matched += qty;
+	}
+
+	security.matched += matched;
+}
+
+
+/// <summary>
+/// Builds an order instance from the record [PRIVATE]
 /// </summary>
-/// <param name="orderId">The order identifier.</param>
-unsigned int OrderCache::matchOrderInCache(order_ptr& order, bool lockOrder) {
+Order SharedOrderCache::toOrder(uint32_t index) const {
+	const shm::order_record& record = m_records[index];
+	Order order{ text(record.orderId), text(record.securityId), text(record.side), record.qty, text(record.user), text(record.company) };
+	order.fillLots(record.qty - std::min(record.qty, record.working));
+	return order;
+}
 
-	#ifdef _DEBUG 
-	auto start = debug::TestUtils::tic();
-	utils::osyncstream out;
-	if (_verbose)
-		out << " - OrderCache::matchOrderInCache()\n";
-	#endif // _DEBUG
 
-	// locks the current order only!! 
-	// Others order can be written by other threads!
-	if (lockOrder)
-		order->lock();
+/// <summary>
+/// Adds the order and matches it against the opposite side (writer only).
+/// </summary>
+/// <param name="order">The order.</param>
+void SharedOrderCache::addOrder(Order order) {
+	if (!checkWritable())
+		return;
 
-	if (order->isFilled()) {
-		// already filled: nothing to do!
-		// release order and return immediately (0 matched lots)
-		#ifdef _DEBUG 
-		if (_verbose)
-			out << "  order already filled! [working lots: " << order->workingQty() << "\n";
-		#endif // _DEBUG
+	std::lock_guard<std::mutex> guard(m_writeMutex);
 
-		if (lockOrder)
-			order->unlock();
-		
-		return 0;
+	const std::string orderId = order.orderId();
+	if (findOrder(orderId) != shm::NIL) {
+		#ifdef THROW_EXCEPTIONS
+		throw std::invalid_argument("error adding order: duplicated order id");
+		#else
+		return;
+		#endif
 	}
 
-	#ifdef _DEBUG	
-	if (_verbose) {
-		debug::TestUtils::print(out, "*");
-		out << " - searching for matches (i.e. after add) and storing it in cache: \n   " << order->str() << '\n';
+	// reuses a free record (or takes a new one)
+	uint32_t index = m_header->freeRecord;
+	if (index == shm::NIL && m_header->recordsUsed >= m_header->orderCapacity) {
+		#ifdef THROW_EXCEPTIONS
+		throw std::length_error("error adding order: shared order cache is full");
+		#else
+		return;
+		#endif
 	}
-	#endif // _DEBUG
 
-	// gets possible counterparties for the specified order 
-	// (defined by order security and "buy/sell" side)
-	const bool isBuy = isBuySide(order);	
+	beginWrite();
 
-	// - uses sell counterparties to matches buy orders
-	// - uses buy counterparties to matches sell orders
-	order_list counterParties = isBuy ?
-		_securityShortOrdersIndex[order->securityId()] :
-		_securityLongOrdersIndex[order->securityId()];
+	bool reused = index != shm::NIL;
+	if (!reused)
+		index = m_header->recordsUsed;
+	shm::order_record& record = m_records[index];
+	shm::order_record previous = record;
 
+	bool stored = true;
+	if (reused && previous.idCapacity >= orderId.size()) {
+		// the previous owner id space is large enough
+		record.orderId.length = (uint32_t)orderId.size();
+		std::memcpy(m_arena + record.orderId.offset, orderId.data(), orderId.size());
+	}
+	else {
+		stored = allocate(orderId, record.orderId);
+		record.idCapacity = record.orderId.length;
+	}
 
-	if (!counterParties.size()) {
-		// no counterparties to match!		
-		#ifdef _DEBUG
-		if (_verbose) {
-			out << "   No " << (isBuy ? "Sell" : "Buy") << " counterparties for match on security: " << order->securityId() << '\n';
-			debug::TestUtils::print(out, "*");
-		}
-		#endif // _DEBUG
-		// release order and return immediately (0 matched lots)
-		if (lockOrder)
-			order->unlock();
-		return 0;
+	uint32_t securityIndex = shm::NIL;
+	stored = stored
+		&& intern(order.side(), record.side) && intern(order.user(), record.user) && intern(order.company(), record.company)
+		&& (securityIndex = addSecurity(order.securityId())) != shm::NIL;
+
+	if (!stored) {
+		// arena/tables exhausted: record untouched
+		record = previous;
+		endWrite();
+		#ifdef THROW_EXCEPTIONS
+		throw std::length_error("error adding order: shared order cache arena is full");
+		#else
+		return;
+		#endif
 	}
 
-	#ifdef _DEBUG
-	// list all counterparties for specified order
-	if (_verbose) {
-		out << "   avaliable (possible) counterparties:\n";
-		debug::TestUtils::print(out, counterParties, 6);
-	} 
-	#endif // _DEBUG
+	if (reused)
+		m_header->freeRecord = previous.next;
+	else
+		m_header->recordsUsed++;
+
+	shm::security_record& security = m_securities[securityIndex];
+	record.securityId = security.securityId;
+	record.hash = shm::hash(orderId.data(), orderId.size());
+	record.qty = order.qty();
+	record.working = order.workingQty();
+	record.security = securityIndex;
+	record.buy = order.side() != "Sell";
+	record.live = 1;
+
+	// appends to the security side list (FIFO)
+	int side = record.buy ? 0 : 1;
+	record.prev = security.tail[side];
+	record.next = shm::NIL;
+	if (security.tail[side] != shm::NIL)
+		m_records[security.tail[side]].next = index;
+	else
+		security.head[side] = index;
+	security.tail[side] = index;
+	security.orders++;
 
+	uint32_t mask = m_header->orderTableMask;
+	uint32_t slot = record.hash & mask;
+	while (m_orderTable[slot] != shm::NIL)
+		slot = (slot + 1) & mask;
+	m_orderTable[slot] = index;
+	m_header->orders++;
 
-	unsigned int matchedQuantity = 0;
-	int counter = 0;
+	match(index);
 
-	// for each possible counterparty order
-	for (order_ptr& counterPartyOrder : counterParties) {
-		
-		// locks the counterparty order candidate
-		if (lockOrder)
-			counterPartyOrder->lock();
-		
-		#ifdef _DEBUG
-		if (_verbose)
-			out << "  checking counterparty: " << counterPartyOrder->str() << '\n';
-		#endif // _DEBUG	 
+	endWrite();
+}
 
-		// company cannot trade with itself (no internal trades): skip orders from same company!
-		if (counterPartyOrder->isFilled() 
-			|| order->company() == counterPartyOrder->company()) {
 
-			#ifdef _DEBUG
-			if (_verbose) {
-				out << "   skipping conterparty: ";
-				if (order->company() == counterPartyOrder->company())
-					out << "same company [" << order->company() << "]\n";
-				else
-					out << "no remaining position [" << counterPartyOrder->workingQty() << "]\n";
-			}
-			#endif
+/// <summary>
+/// Cancels the order by specified Id (writer only).
+/// </summary>
+/// <param name="orderId">The order identifier.</param>
+void SharedOrderCache::cancelOrder(const std::string& orderId) {
+	if (!checkWritable())
+		return;
 
-			// unlock and skip counterparty
-			if (lockOrder)
-				counterPartyOrder->unlock();
-			continue;
-		}
-		// gets the tradable quantity of lots between current buy and sell order
-		// i.e., the counterparties should have at LEAST the same working quantity in order to trade!
-		unsigned int qty = std::min(order->workingQty(), counterPartyOrder->workingQty());
-		if (qty == 0) {
+	std::lock_guard<std::mutex> guard(m_writeMutex);
 
-			#ifdef _DEBUG
-			if (_verbose) {
-				out << " - no matches (0 lots) for:\n";
-				out << "       order:        " << order->str() << '\n';
-				out << "       counterparty: " << counterPartyOrder->str() << '\n';
-			}
-			#endif // _DEBUG
-			counterPartyOrder->unlock();
-			continue;
-		}
+	uint32_t slot = findOrder(orderId);
+	if (slot == shm::NIL) {
+		#ifdef THROW_EXCEPTIONS
+		throw std::invalid_argument("error cancelling order: order id not found");
+		#else
+		return;
+		#endif
+	}
 
-		#ifdef _DEBUG
-		if (_verbose) {
-			out << " - Matched " << qty << " lots:\n";
-			out << "   order:        " << order->str() << '\n';
-			out << "   counterparty: " << counterPartyOrder->str() << '\n';
-		}
-		#endif // _DEBUG
+	beginWrite();
+	uint32_t index = m_orderTable[slot];
+	eraseOrderSlot(slot);
+	cancelRecord(index);
+	endWrite();
+}
 
-		// partially fill orders (i.e., on "qty" lots)
-		order->fillLots(qty);
-		counterPartyOrder->fillLots(qty);
-		counterPartyOrder->unlock();
-	
-		matchedQuantity += qty;
 
-#ifdef EXTENDED_INTERFACE
-		//
-		// stores deal information - Extended feature (not required for the proposed problem)
-		//
-		OrderFill& filledOrder = isBuy ?
-			OrderFill{ order->orderId(), counterPartyOrder->orderId(), qty } :
-			OrderFill{ counterPartyOrder->orderId(), order->orderId(), qty };
-		
-		// just stores deal information
-		_orderMatches.push_back(filledOrder);
+/// <summary>
+/// Cancels the orders for the specified user (writer only).
+/// </summary>
+/// <param name="user">The user.</param>
+void SharedOrderCache::cancelOrdersForUser(const std::string& user) {
+	if (!checkWritable())
+		return;
 
-#endif //EXTENDED_INTERFACE
-		
+	std::lock_guard<std::mutex> guard(m_writeMutex);
 
-		#ifdef _DEBUG
-		if (_verbose) {
-			out << " - after match : \n";
-			out << "   order:        " << order->str() << '\n';
-			out << "   counterparty: " << counterPartyOrder->str() << '\n';
-			out << "   total matched quantity on order '" << order->orderId() << "': " << matchedQuantity << " lots\n";
-		}
-		#endif // _DEBUG
+	// users are interned: a user never stored has no orders, otherwise same user <=> same offset
+	const uint32_t offset = findSymbol(user);
+	if (offset == shm::NIL)
+		return;
 
-		if (order->isFilled()) {
-			// the order is filled: all work is done!!!
-			break;
-		}
+	beginWrite();
+	for (uint32_t index = 0; index < m_header->recordsUsed; index++) {
+		shm::order_record& record = m_records[index];
+		if (!record.live || record.user.offset != offset)
+			continue;
+		eraseOrderSlot(findRecordSlot(index));
+		cancelRecord(index);
 	}
-		
-	if (lockOrder)
-		order->unlock();
+	endWrite();
+}
 
-	// stores matched quantity of lots on cache (thread safe writing)
-	_matchedQuantityMutex.lock();
-	_matchedQuantity[order->securityId()] += matchedQuantity;
-	_matchedQuantityMutex.unlock();
 
+/// <summary>
+/// Cancels the orders for sec identifier with minimum quantity of lots (writer only).
+/// </summary>
+/// <param name="securityId">The security identifier.</param>
+/// <param name="minQty">The minimum size to cancel the order.</param>
+void SharedOrderCache::cancelOrdersForSecIdWithMinimumQty(const std::string& securityId, unsigned int minQty) {
+	if (!checkWritable())
+		return;
 
-	#ifdef _DEBUG
-	if (_verbose) {
-		out << "   final matched quantity for order '" << order->orderId() << "': " << matchedQuantity << " lots.\n";
-		out << "   total matched quantity (cached) for security '" << order->securityId() << "': " << getMatchedQuantityInCache(order->securityId()) << " lots.\n";
-		debug::TestUtils::toc(out, start, "   elapsed time: ");
-		debug::TestUtils::print(out, "*");
+	std::lock_guard<std::mutex> guard(m_writeMutex);
+
+	uint32_t securityIndex = findSecurity(securityId);
+	if (securityIndex == shm::NIL)
+		return;
+
+	beginWrite();
+	shm::security_record& security = m_securities[securityIndex];
+	for (int side = 0; side < 2; side++) {
+		uint32_t index = security.head[side];
+		while (index != shm::NIL) {
+			uint32_t next = m_records[index].next;
+			if (m_records[index].qty >= minQty) {
+				eraseOrderSlot(findRecordSlot(index));
+				cancelRecord(index);
+			}
+			index = next;
+		}
 	}
-	#endif // _DEBUG
+	endWrite();
+}
 
-	// ************* HERE *****************
 
-	return matchedQuantity;
+/// <summary>
+/// Gets the matching size for security (writer and readers).
+/// </summary>
+/// <param name="securityId">The security identifier.</param>
+/// <returns></returns>
+unsigned int SharedOrderCache::getMatchingSizeForSecurity(const std::string& securityId) {
+	if (!isOpen())
+		return 0;
+
+	return consistentRead([&]() {
+		uint32_t index = findSecurity(securityId);
+		return index == shm::NIL ? 0u : (unsigned int)m_securities[index].matched;
+	});
 }
 
 
-void OrderCache::matchOrderInPool(order_ptr& ptr){
+/// <summary>
+/// Gets all orders (writer and readers).
+/// </summary>
+/// <returns></returns>
+std::vector<Order> SharedOrderCache::getAllOrders() const {
+	if (!isOpen())
+		return std::vector<Order>();
+
+	return consistentRead([&]() {
+		std::vector<Order> orders;
+		uint32_t used = std::min(m_header->recordsUsed, m_header->orderCapacity);
+		for (uint32_t index = 0; index < used; index++)
+			if (m_records[index].live)
+				orders.push_back(toOrder(index));
+		return orders;
+	});
+}
 
-	matchOrderInCache(std::ref(ptr), true);
 
-	// task is done, remove thread from pool
-	if (_ThreadPool.size() == 0)
-		return;
+/// <summary>
+/// Checks the order existence by the specified order identifier.
+/// </summary>
+bool SharedOrderCache::exists(const std::string& orderId) const {
+	if (!isOpen())
+		return false;
 
-	std::lock_guard<std::mutex> lock(_ThreadPoolMutex);
-	_ThreadPool.erase(
-		std::find_if(_ThreadPool.begin(), _ThreadPool.end(),
-			[](std::thread& x)
-			{
-				if (x.get_id() == std::this_thread::get_id())
-				{
-					// detach inside running thread
-					x.detach(); 
-					return true;
-				}
-				return false;
-			})
-	);
+	return consistentRead([&]() { return findOrder(orderId) != shm::NIL; });
 }
 
 
 /// <summary>
-/// Gets the current cached matched quantity by security (thread-safe).
+/// Gets the number of orders in the segment.
 /// </summary>
-/// <param name="securityId">The security identifier.</param>
-/// <returns></returns>
-unsigned int OrderCache::getMatchedQuantityInCache(const std::string& securityId) const {
-	
-	// locks for reading values
-	_matchedQuantityMutex.lock_shared();	
+size_t SharedOrderCache::size() const {
+	if (!isOpen())
+		return 0;
 
-	// remark: retunrs 0 in case of the security identifier was not found
-	unsigned int value = (_matchedQuantity.count(securityId) == 0) ? 0 :
-		_matchedQuantity.at(securityId);
+	return consistentRead([&]() { return (size_t)m_header->orders; });
+}
 
-	_matchedQuantityMutex.unlock_shared();
 
-	return value;
+/// <summary>
+/// Gets a copy of the order by specified order id.
+/// </summary>
+Order SharedOrderCache::getOrder(const std::string& orderId) const {
+	Order empty{ "", "", "", 0, "", "" };
+	if (!isOpen())
+		return empty;
+
+	std::pair<bool, Order> result = consistentRead([&]() {
+		uint32_t slot = findOrder(orderId);
+		if (slot == shm::NIL)
+			return std::make_pair(false, empty);
+		return std::make_pair(true, toOrder(m_orderTable[slot]));
+	});
+
+	#ifdef THROW_EXCEPTIONS
+	if (!result.first)
+		throw std::range_error("order not found");
+	#endif
+
+	return result.second;
+}
+
+
+/// <summary>
+/// Gets the segment sequence number (incremented by 2 on each mutation).
+/// </summary>
+uint64_t SharedOrderCache::sequence() const {
+	return isOpen() ? m_header->sequence.load(std::memory_order_acquire) : 0;
 }
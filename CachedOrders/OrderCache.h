@@ -56,6 +56,13 @@ There are two class properties defined only for testing purposes / performance c
    - multiThread() / setMultiThread(): enable/disable multi-thread support
    - verbose() / setVerbose(): enable/disable full verbosity on debug mode (_DEBUG)
 
+Remark: console output (debug messages, execution times) is written by "utils::osyncstream" into the
+asynchronous logger "utils::async_logger" (lock-free queue drained by a background thread), so logging
+never blocks the matching threads. Use "utils::async_logger::instance().open(path)" to log into a file.
+
+Remark: "SharedOrderCache" is a variant of the order cache stored in a named shared memory segment (offsets
+instead of pointers), written by one process and read by other processes without IPC (seqlock protocol).
+
 Remark: project was keept on 2 files only for sending/testing easyness
 
 
@@ -109,6 +116,22 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     MACRO PARAMETERS
  ----------------------------------------------------------------*/
 constexpr unsigned int DELETE_CHUNK_SIZE = 64; // this is arbitrary
+constexpr unsigned int LOG_QUEUE_SIZE = 16384;   // asynchronous logger records (240 bytes each)
+constexpr unsigned int REPLICA_QUEUE_SIZE = 65536; // read replica mutations in flight (spilled to an overflow buffer when full)
+constexpr unsigned int EPOCH_READER_SLOTS = 64;    // concurrent pinned readers (deferred deletion)
+constexpr unsigned int RECLAIM_INTERVAL_US = 1000; // background reclamation pass period (deferred deletion)
+constexpr unsigned int RECLAIM_BATCH_SIZE = 256;    // cancelled orders released per reclamation pass, i.e. bounded write lock hold (deferred deletion)
+constexpr unsigned int PAGED_TABLE_MAX_PAGES = 1 << 20; // numeric order ids range (pages of 4096 ids, see utils::paged_table)
+constexpr unsigned int HUGE_PAGE_SIZE = 2u << 20;    // explicit huge pages (memory arena, see utils::memory_arena)
+constexpr unsigned int ADAPTIVE_LAZY_RATIO = 16;     // adaptive matching: adds per query above which a security matches lazily
+constexpr unsigned int ADAPTIVE_EAGER_RATIO = 4;     // adaptive matching: adds per query below which a security matches eagerly (hysteresis)
+constexpr unsigned int MATCHING_SWITCH_LOG = 256;    // adaptive matching: last strategy switches kept (see OrderCache::matchingStats())
+constexpr unsigned int EXPIRY_TICK_US = 1000;        // order expiry: timing wheel resolution (microseconds, see OrderCache::expireOrders())
+constexpr unsigned int EXPIRY_WHEEL_BITS = 8;        // order expiry: slots per timing wheel level (2^8)
+constexpr unsigned int EXPIRY_WHEEL_LEVELS = 4;      // order expiry: timing wheel levels (2^32 ticks, farther expiries wait on an overflow list)
+constexpr unsigned int VOLUME_SECOND_BUCKETS = 300;  // matched volume series: 1s buckets kept by security (ring, see OrderCache::getMatchedVolume())
+constexpr unsigned int VOLUME_MINUTE_BUCKETS = 1440; // matched volume series: 1m buckets kept by security (ring, a day)
+constexpr unsigned int CHANGE_LOG_SIZE = 1 << 20;    // change data capture: default changes kept (see OrderCache::setChangeLog())
 
 
 #include <string>
@@ -121,6 +144,20 @@ constexpr unsigned int DELETE_CHUNK_SIZE = 64; // this is arbitrary
 #include <sstream>
 #include <iostream>
 #include <mutex>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <map>
+#include <deque>
+#include <scoped_allocator>
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <charconv>
+#include <optional>
 
 #ifdef THROW_EXCEPTIONS
 #include <stdexcept>
@@ -134,6 +171,339 @@ constexpr unsigned int DELETE_CHUNK_SIZE = 64; // this is arbitrary
 
 namespace utils {
 
+    /// <summary>
+    /// Bounded lock-free multi-producer/multi-consumer queue (D. Vyukov's algorithm).
+    /// 
+    /// Remark: all cells are preallocated (no allocation on push/pop) and push never
+    ///         blocks: it fails when the queue is full
+    /// </summary>
+    /// <typeparam name="T">item type (default constructible and movable)</typeparam>
+    template <typename T>
+    class mpmc_queue {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="mpmc_queue"/> class.
+        /// </summary>
+        /// <param name="capacity">The capacity (rounded up to a power of 2).</param>
+        explicit mpmc_queue(size_t capacity) {
+            size_t size = 2;
+            while (size < capacity)
+                size <<= 1;
+            m_mask = size - 1;
+            m_cells.reset(new cell[size]);
+            for (size_t i = 0; i < size; i++)
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        mpmc_queue(const mpmc_queue&) = delete;
+        mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+        /// <summary>
+        /// Pushes the item (lock-free). Returns false if the queue is full.
+        /// </summary>
+        /// <param name="item">The item.</param>
+        template <typename U>
+        bool try_push(U&& item) {
+            cell* target;
+            size_t position = m_enqueue.load(std::memory_order_relaxed);
+            while (true) {
+                target = &m_cells[position & m_mask];
+                size_t sequence = target->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+                if (diff == 0) {
+                    if (m_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                    return false; // full
+                else
+                    position = m_enqueue.load(std::memory_order_relaxed);
+            }
+            target->data = std::forward<U>(item);
+            target->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// <summary>
+        /// Pushes "n" items on consecutive cells, all or none (lock-free): "fill(k, item)" 
+        /// writes the k-th item in place. Returns false if the queue has less than "n" free cells.
+        /// </summary>
+        /// <param name="n">The number of items.</param>
+        /// <param name="fill">The items writer.</param>
+        template <typename Fill>
+        bool try_push_n(size_t n, Fill&& fill) {
+            if (n > capacity())
+                return false;
+
+            size_t position = m_enqueue.load(std::memory_order_relaxed);
+            while (true) {
+                // remark: a free cell stays free until claimed (consumers only release cells)
+                intptr_t diff = 0;
+                for (size_t k = 0; k < n && diff == 0; k++)
+                    diff = (intptr_t)m_cells[(position + k) & m_mask].sequence.load(std::memory_order_acquire) - (intptr_t)(position + k);
+                if (diff == 0) {
+                    if (m_enqueue.compare_exchange_weak(position, position + n, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                    return false; // not enough free cells
+                else
+                    position = m_enqueue.load(std::memory_order_relaxed);
+            }
+            for (size_t k = 0; k < n; k++) {
+                cell& target = m_cells[(position + k) & m_mask];
+                fill(k, target.data);
+                target.sequence.store(position + k + 1, std::memory_order_release);
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Pops the oldest item (lock-free). Returns false if the queue is empty.
+        /// </summary>
+        /// <param name="item">The popped item.</param>
+        bool try_pop(T& item) {
+            cell* target;
+            size_t position = m_dequeue.load(std::memory_order_relaxed);
+            while (true) {
+                target = &m_cells[position & m_mask];
+                size_t sequence = target->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t)sequence - (intptr_t)(position + 1);
+                if (diff == 0) {
+                    if (m_dequeue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                    return false; // empty
+                else
+                    position = m_dequeue.load(std::memory_order_relaxed);
+            }
+            item = std::move(target->data);
+            target->sequence.store(position + m_mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// <summary>
+        /// Gets the approximated number of items in the queue.
+        /// </summary>
+        size_t size() const {
+            size_t enqueued = m_enqueue.load(std::memory_order_relaxed);
+            size_t dequeued = m_dequeue.load(std::memory_order_relaxed);
+            return enqueued > dequeued ? enqueued - dequeued : 0;
+        }
+
+        /// <summary>
+        /// Gets the queue capacity.
+        /// </summary>
+        size_t capacity() const { return m_mask + 1; }
+
+    private:
+        struct cell {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        std::unique_ptr<cell[]> m_cells;
+        size_t m_mask = 0;
+        alignas(64) std::atomic<size_t> m_enqueue{ 0 };
+        alignas(64) std::atomic<size_t> m_dequeue{ 0 };
+    };
+
+
+    /// <summary>
+    /// Asynchronous logger: producer threads copy their messages into preallocated 
+    /// records of a lock-free queue, and a background thread drains the queue to
+    /// the console (default) or to a file. 
+    /// 
+    /// Remark: logging never blocks the caller on I/O or on a mutex; messages are
+    ///         dropped (and counted) if the queue is full
+    /// </summary>
+    class async_logger {
+    public:
+
+        /// <summary>
+        /// Gets the process-wide logger instance.
+        /// </summary>
+        static async_logger& instance() {
+            static async_logger logger;
+            return logger;
+        }
+
+        async_logger(const async_logger&) = delete;
+        async_logger& operator=(const async_logger&) = delete;
+
+        ~async_logger() {
+            // drains pending messages and stops the background thread
+            m_running.store(false, std::memory_order_release);
+            if (m_thread.joinable())
+                m_thread.join();
+            close();
+        }
+
+        /// <summary>
+        /// Writes the specified message (thread-safe, lock-free).
+        /// </summary>
+        /// <param name="text">The text.</param>
+        /// <param name="length">The text length.</param>
+        /// <returns>false if the message was dropped</returns>
+        bool write(const char* text, size_t length) {
+            // producer identifier (reassembles messages larger than a record)
+            static std::atomic<unsigned int> producers{ 0 };
+            thread_local unsigned int producer = ++producers;
+
+            // all the records of the message are reserved at once (never waits for the consumer)
+            const size_t capacity = sizeof(record::text);
+            const size_t records = length ? (length + capacity - 1) / capacity : 1;
+            const bool pushed = m_queue.try_push_n(records, [&](size_t k, record& item) {
+                const size_t offset = k * capacity;
+                item.producer = producer;
+                item.length = (unsigned short)std::min(length - offset, capacity);
+                item.more = k + 1 < records;
+                std::copy(text + offset, text + offset + item.length, item.text);
+            });
+
+            if (!pushed) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            m_published.fetch_add(records, std::memory_order_release);
+            return true;
+        }
+
+        /// <summary>
+        /// Writes the specified message (thread-safe, lock-free).
+        /// </summary>
+        /// <param name="text">The text.</param>
+        bool write(const std::string& text) { return write(text.data(), text.size()); }
+
+        /// <summary>
+        /// Redirects the output to the specified file (appending). Returns false if the file cannot be opened.
+        /// </summary>
+        /// <param name="path">The file path.</param>
+        bool open(const std::string& path) {
+            std::FILE* file = std::fopen(path.c_str(), "a");
+            if (!file)
+                return false;
+            setOutput(file, true);
+            return true;
+        }
+
+        /// <summary>
+        /// Redirects the output to the specified stream (e.g. "stdout", "stderr").
+        /// </summary>
+        /// <param name="output">The output stream.</param>
+        /// <param name="owned">true to close the stream when replaced.</param>
+        void setOutput(std::FILE* output, bool owned = false) {
+            // pending messages go to the previous output
+            flush();
+            std::lock_guard<std::mutex> guard(m_outputMutex);
+            if (m_owned && m_output)
+                std::fclose(m_output);
+            m_output = output;
+            m_owned = owned;
+        }
+
+        /// <summary>
+        /// Waits until all messages written so far are drained (shutdown and tests only).
+        /// </summary>
+        void flush() {
+            size_t published = m_published.load(std::memory_order_acquire);
+            while (m_drained.load(std::memory_order_acquire) < published)
+                std::this_thread::yield();
+        }
+
+        /// <summary>
+        /// Gets the number of dropped messages (queue full).
+        /// </summary>
+        size_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+        /// <summary>
+        /// Fixed size log record (queue cell payload)
+        /// </summary>
+        struct record {
+            unsigned int producer = 0;
+            unsigned short length = 0;
+            bool more = false;
+            char text[240];
+        };
+
+        async_logger() : m_queue(LOG_QUEUE_SIZE) {
+            m_thread = std::thread(&async_logger::run, this);
+        }
+
+        /// <summary>
+        /// Background thread: drains the queue to the output
+        /// </summary>
+        void run() {
+            // partial messages by producer (messages larger than a record)
+            std::unordered_map<unsigned int, std::string> partials;
+            size_t reported = 0;
+            record item;
+
+            while (true) {
+                if (!m_queue.try_pop(item)) {
+                    if (!m_running.load(std::memory_order_acquire) && m_queue.size() == 0)
+                        break;
+                    {
+                        std::lock_guard<std::mutex> guard(m_outputMutex);
+                        if (m_output)
+                            std::fflush(m_output);
+                    }
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                    continue;
+                }
+
+                {
+                    std::lock_guard<std::mutex> guard(m_outputMutex);
+                    size_t dropped = m_dropped.load(std::memory_order_relaxed);
+                    if (m_output && dropped != reported) {
+                        std::fprintf(m_output, "[async_logger: %zu messages dropped]\n", dropped - reported);
+                        reported = dropped;
+                    }
+
+                    auto partial = partials.find(item.producer);
+                    if (item.more || partial != partials.end()) {
+                        std::string& text = partials[item.producer];
+                        text.append(item.text, item.length);
+                        if (!item.more) {
+                            if (m_output)
+                                std::fwrite(text.data(), 1, text.size(), m_output);
+                            partials.erase(item.producer);
+                        }
+                    }
+                    else if (m_output)
+                        std::fwrite(item.text, 1, item.length, m_output);
+                }
+                m_drained.fetch_add(1, std::memory_order_release);
+            }
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> guard(m_outputMutex);
+            if (m_output)
+                std::fflush(m_output);
+            if (m_owned && m_output)
+                std::fclose(m_output);
+            m_output = nullptr;
+        }
+
+        mpmc_queue<record> m_queue;
+        std::atomic<bool> m_running{ true };
+        std::atomic<size_t> m_published{ 0 };
+        std::atomic<size_t> m_drained{ 0 };
+        std::atomic<size_t> m_dropped{ 0 };
+
+        // output stream: only contended by the background thread and by "setOutput()"
+        std::mutex m_outputMutex;
+        std::FILE* m_output = stdout;
+        bool m_owned = false;
+
+        std::thread m_thread;
+    };
+
+
     /// <summary>
     /// multithread string buffer (C++17 implementation)
     /// </summary>
@@ -149,24 +519,25 @@ namespace utils {
         }
 
         /// <summary>
-        /// Synchronizes this instance (writes to console - thread-safe.
+        /// Synchronizes this instance (sends buffer to the asynchronous logger - thread-safe).
         /// </summary>
-        /// <returns></returns>
-        int sync()
+        /// <returns>0 on success, -1 otherwise</returns>
+        int sync() override
         {
-            // when the buffer is sync, send to console in thread-safe fashion
-            static std::mutex _mutex;
-            std::lock_guard<std::mutex> guard(_mutex);
-            std::cout << str();
+            std::string text = str();
+            if (text.empty())
+                return 0;
+            str(std::string());
+            return async_logger::instance().write(text) ? 0 : -1;
         }
-
-    private:
-        static std::mutex _mutex;
     };
 
 
     /// <summary>
     /// multithread string stream (a.k.a., "std::cout") (C++17 implementation)
+    /// 
+    /// Remark: the text is sent to the asynchronous logger on "flush()" (or destruction),
+    ///         i.e. no mutex, nor console I/O on the calling thread
     /// </summary>
     /// <seealso cref="std::ostringstream" />
     class osyncstream : public std::ostringstream
@@ -177,20 +548,17 @@ namespace utils {
 
         ~osyncstream() {
             // when the object is destroyed, send to buffered stream 
-            // to console thread-safelly
+            // to the logger (thread-safelly)
             flush();
         }
 
         /// <summary>
-        /// Flushes this instance (writes to console - thread-safe.
-        /// </summary>
-        /// <returns></returns>
+        /// Flushes this instance (sends to the asynchronous logger - thread-safe).
         /// </summary>
         void flush() {
-            // thread-safe flush
-            static std::mutex _mutex;
-            std::lock_guard<std::mutex> guard(_mutex);
-            std::cout << this->str();
+            std::string text = this->str();
+            if (!text.empty())
+                async_logger::instance().write(text);
             // clear string buffer
             this->clean();
         }
@@ -208,10 +576,10 @@ namespace utils {
         /// Add value to stream
         /// </summary>
         /// <typeparam name="T"></typeparam>
-        /// <param name=""></param>
+        /// <param name="value">The value.</param>
         template <typename T>
-        void add(const T&) {
-            ((std::ostringstream)(*this)).operator<<(t);
+        void add(const T& value) {
+            ((std::ostringstream&)(*this)) << value;
         }
 
 
@@ -220,9 +588,6 @@ namespace utils {
             ((std::ostringstream&)os) << value;
             return os;
         }
-
-    private:
-        static std::mutex _mutex;
     };
 
 
@@ -258,658 +623,3030 @@ namespace utils {
             chunkBegin = chunkEnd;
         } while (std::distance(chunkBegin, end) > 0 && counter++ < maxChunks);
     }
-}
 
 
-/*----------------------------------------------------------------
-    PROBLEM INTERFACE
- ----------------------------------------------------------------*/
-
+    /*----------------------------------------------------------------
+        MEMORY ACCOUNTING
+     ----------------------------------------------------------------*/
 
-/// <summary>
-/// Order Transfer Object
-/// </summary>
-class Order
-{
- 
- public:
-         
-     /// <summary>
-     /// Initializes a new instance of the <see cref="Order"/> class.
-     /// </summary>
-     /// <param name="ordId">The ord identifier.</param>
-     /// <param name="secId">The sec identifier.</param>
-     /// <param name="side">The side.</param>
-     /// <param name="qty">The qty.</param>
-     /// <param name="user">The user.</param>
-     /// <param name="company">The company.</param>
-     Order(
-      const std::string& ordId,
-      const std::string& secId,
-      const std::string& side,
-      const unsigned int qty,
-      const std::string& user,
-      const std::string& company)
-      : m_orderId(ordId),
-        m_securityId(secId),
-        m_side(side),
-        m_qty(qty),
-        m_user(user),
-        m_company(company) {
-      m_workingQty = qty; 
-      m_mutex = std::make_shared<std::shared_mutex>();
-      m_locked = false;
-  }
-  
-  /// <summary>
-  /// Gets the order unique identifier.
-  /// </summary>
-  /// <returns></returns>
-  std::string orderId() const { return m_orderId; }  
+    class memory_arena;
 
-  /// <summary>
-  /// Gets the security unique identifier.
-  /// </summary>
-  /// <returns></returns>
-  std::string securityId() const { return m_securityId; }  
+    /// <summary>
+    /// Live heap usage of a data structure (shared by all its tracking allocators, thread-safe)
+    /// </summary>
+    struct memory_counter {
+        std::atomic<size_t> bytes{ 0 };        // bytes currently allocated
+        std::atomic<size_t> allocations{ 0 };  // blocks currently allocated
+        std::atomic<size_t> peak{ 0 };         // high watermark of "bytes"
+        memory_arena* arena = nullptr;         // pre-sized storage, if any (otherwise the heap)
+
+        void allocated(size_t n) noexcept {
+            size_t current = bytes.fetch_add(n, std::memory_order_relaxed) + n;
+            allocations.fetch_add(1, std::memory_order_relaxed);
+            size_t previous = peak.load(std::memory_order_relaxed);
+            while (current > previous && !peak.compare_exchange_weak(previous, current, std::memory_order_relaxed));
+        }
 
-  /// <summary>
-  /// Gets order sides ("Buy"/"Sell").
-  /// </summary>
-  /// <returns></returns>
-  std::string side() const { return m_side; }  
+        void deallocated(size_t n) noexcept {
+            bytes.fetch_sub(n, std::memory_order_relaxed);
+            allocations.fetch_sub(1, std::memory_order_relaxed);
+        }
+    };
 
-  /// <summary>
-  /// Gets the user identifier .
-  /// </summary>
-  /// <returns></returns>
-  std::string user() const { return m_user; }  
 
-  /// <summary>
-  /// Gets the Company identifier
-  /// </summary>
-  /// <returns></returns>
-  std::string company() const { return m_company; }  
+    /// <summary>
+    /// Process page faults counters (minor: no I/O, major: I/O)
+    /// </summary>
+    struct page_faults {
+        size_t minor = 0;
+        size_t major = 0;
 
-  /// <summary>
-  /// Gets the order quantity of lots.
-  /// </summary>
-  /// <returns></returns>
-  unsigned int qty() const { return m_qty; }
-  
-  //----------------------------------------------------------------
+        static page_faults current();
+    };
 
-  /// <summary>
-  /// Gets the number of working lots.
-  /// </summary>
-  /// <returns></returns>
-  unsigned int workingQty() const { return m_workingQty; }
-  
-  /// <summary>
-  /// Gets the number of filled lots.
-  /// </summary>
-  /// <returns></returns>
-  unsigned int filledQty() const { return m_qty - m_workingQty; }
-    
-  /// <summary>
-  /// Subtracts the quantity of working lots to the current order.
-  /// </summary>
-  /// <param name="qty">The qty.</param>
-  inline void fillLots(const unsigned int& qty) {
-      if (m_workingQty > qty)
-          m_workingQty -= qty;
-      else
-          m_workingQty = 0;
-  }
 
-  /// <summary>
-  /// Adds the specified quantity of working lots to the current order.
-  /// </summary>
-  /// <param name="qty">The qty.</param>
-  inline void unfillLots(const unsigned int& qty) {
-      m_workingQty += qty;
-      if (m_workingQty > m_qty)
-          m_workingQty = m_qty;
-  }
-  
-  /// <summary>
-  /// Return true if the order is fully filled (i.e. no working lots), otherwise false.
-  /// </summary>
-  inline bool isFilled() const { return m_workingQty == 0; }
+    /// <summary>
+    /// Pre-sized memory arena for low jitter deployments: a single mapping backed by explicit 
+    /// 2 MB huge pages when available (otherwise transparent huge pages advice), prefaulted and 
+    /// optionally locked in memory at reservation, so the allocations do not page fault.
+    /// 
+    /// Blocks are rounded to power of two size classes ("ALIGNMENT" bytes alignment), bump allocated 
+    /// and recycled by per class free lists (spin lock, no system calls).
+    /// 
+    /// Remark: "allocate()" returns nullptr when the arena is exhausted (caller falls back to the heap)
+    /// Remark: over-aligned types (alignof > "ALIGNMENT") are not served by the arena (see "tracking_allocator")
+    /// Remark: the arena must outlive the containers using it
+    /// </summary>
+    class memory_arena {
+    public:
+        enum class page_mode { none, standard, transparent, huge };
 
-  /// <summary>
-  /// Resets the order matches.
-  /// </summary>
-  inline void resetFills() { m_workingQty = m_qty; }
-  
-  // ** convenience accessor **
-  unsigned int operator+=(unsigned int qty) { unfillLots(qty); return m_workingQty; }  
+        static constexpr size_t ALIGNMENT = 16;   // blocks alignment (smallest size class)
+        static_assert(ALIGNMENT >= alignof(std::max_align_t), "arena blocks must be suitably aligned for any scalar type");
 
-  // ** convenience accessor **
-  unsigned int operator-=(unsigned int qty) { fillLots(qty); return m_workingQty; }
-  
-  /// <summary>
-  /// Locks the current order instance.
-  /// </summary>
-  /// <param name="readonly">true for read shared access, false to block write acess.</param>
-  /// <returns></returns>
-  //bool lock(const bool shared = false) const {
-  bool lock(const bool shared = false) {
-      m_locked = shared? m_mutex->try_lock_shared(): m_mutex->try_lock();
-	  return m_locked;
-  }
-  
-  /// <summary>
-  /// Unlocks the current order instance.
-  /// </summary>
-  /// <param name="readonly">true for read shared access, false to block write acess.</param>
-  bool unlock(const bool shared = false) {
-      if (!m_locked)
-          return false;
+        memory_arena() = default;
+        ~memory_arena() { release(); }
 
-      if (shared)
-          m_mutex->unlock_shared();
-      else
-          m_mutex->unlock(); 
+        memory_arena(const memory_arena&) = delete;
+        memory_arena& operator=(const memory_arena&) = delete;
 
-	  m_locked = false;
-	  return true;
-  }
+        /// <summary>
+        /// Maps and prefaults the arena (rounded to huge pages), locking it in memory if required
+        /// </summary>
+        bool reserve(size_t bytes, bool lock);
+
+        /// <summary>
+        /// Unmaps the arena (all blocks are released)
+        /// </summary>
+        void release();
+
+        void* allocate(size_t bytes) noexcept {
+            const unsigned index = sizeClass(bytes);
+            void* block = nullptr;
+            if (index < SIZE_CLASSES) {
+                acquire();
+                block = m_free[index];
+                if (block)
+                    m_free[index] = *(void**)block;
+                else if (m_used + classBytes(index) <= m_bytes) {
+                    block = m_base + m_used;
+                    m_used += classBytes(index);
+                }
+                m_lock.clear(std::memory_order_release);
+            }
+            if (!block)
+                m_fallbacks.fetch_add(1, std::memory_order_relaxed);
+            return block;
+        }
+
+        /// <summary>
+        /// Recycles the block, returns false case it was not allocated by the arena
+        /// </summary>
+        bool deallocate(void* block, size_t bytes) noexcept {
+            if (!owns(block))
+                return false;
+            const unsigned index = sizeClass(bytes);
+            acquire();
+            *(void**)block = m_free[index];
+            m_free[index] = block;
+            m_lock.clear(std::memory_order_release);
+            return true;
+        }
 
+        bool owns(const void* block) const noexcept { 
+            return m_base && (const char*)block >= m_base && (const char*)block < m_base + m_bytes; 
+        }
 
-  bool locked() const { return m_locked; }
+        size_t reservedBytes() const { return m_bytes; }
+        size_t usedBytes() const { return m_used; }
+        size_t fallbacks() const { return m_fallbacks.load(std::memory_order_relaxed); }
+        page_mode pages() const { return m_pages; }
+        bool locked() const { return m_locked; }
+
+    private:
+        static constexpr unsigned SIZE_CLASSES = 40;
+
+        static unsigned sizeClass(size_t bytes) {
+            unsigned index = 0;
+            while ((ALIGNMENT << index) < bytes)
+                index++;
+            return index;
+        }
+        static size_t classBytes(unsigned index) { return ALIGNMENT << index; }
+
+        void acquire() noexcept {
+            while (m_lock.test_and_set(std::memory_order_acquire))
+                std::this_thread::yield();
+        }
+
+        char* m_base = nullptr;
+        size_t m_bytes = 0;
+        size_t m_used = 0;
+        void* m_free[SIZE_CLASSES] = {};
+        std::atomic_flag m_lock = ATOMIC_FLAG_INIT;
+        std::atomic<size_t> m_fallbacks{ 0 };
+        page_mode m_pages = page_mode::none;
+        bool m_locked = false;
+    };
+
+
+    /// <summary>
+    /// STL allocator that reports every allocation to a memory counter (a default
+    /// constructed allocator has no counter and behaves as "std::allocator").
+    ///
+    /// Remark: nested containers (e.g. map of sets) should use "std::scoped_allocator_adaptor"
+    ///         so that inner containers are charged to the same counter
+    /// Remark: over-aligned types are allocated on the heap (the arena blocks are only 
+    ///         "memory_arena::ALIGNMENT" aligned), still charged to the counter
+    /// </summary>
+    /// <typeparam name="T">allocated type</typeparam>
+    template <typename T>
+    class tracking_allocator {
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        tracking_allocator() noexcept = default;
+
+        explicit tracking_allocator(memory_counter* counter) noexcept : m_counter(counter) { }
+
+        template <typename U>
+        tracking_allocator(const tracking_allocator<U>& other) noexcept : m_counter(other.counter()) { }
+
+        T* allocate(size_t n) {
+            T* p = nullptr;
+            if constexpr (alignof(T) <= memory_arena::ALIGNMENT)
+                if (m_counter && m_counter->arena)
+                    p = (T*)m_counter->arena->allocate(n * sizeof(T));
+            if (!p)
+                p = std::allocator<T>().allocate(n);
+            if (m_counter)
+                m_counter->allocated(n * sizeof(T));
+            return p;
+        }
+
+        void deallocate(T* p, size_t n) noexcept {
+            if (m_counter)
+                m_counter->deallocated(n * sizeof(T));
+            if (alignof(T) > memory_arena::ALIGNMENT || !m_counter || !m_counter->arena || !m_counter->arena->deallocate(p, n * sizeof(T)))
+                std::allocator<T>().deallocate(p, n);
+        }
+
+        memory_counter* counter() const noexcept { return m_counter; }
+
+        template <typename U>
+        bool operator==(const tracking_allocator<U>& other) const noexcept { return m_counter == other.counter(); }
+
+        template <typename U>
+        bool operator!=(const tracking_allocator<U>& other) const noexcept { return m_counter != other.counter(); }
+
+    private:
+        memory_counter* m_counter = nullptr;
+    };
+
+
+    /// <summary>
+    /// Gets the heap bytes used by a string beyond its small string buffer (SSO)
+    /// </summary>
+    /// <param name="value">The string.</param>
+    /// <returns></returns>
+    inline size_t heapBytes(const std::string& value) {
+        static const size_t smallCapacity = std::string().capacity();
+        return value.capacity() > smallCapacity ? value.capacity() + 1 : 0;
+    }
+
+
+    /*----------------------------------------------------------------
+        SERIALIZATION
+     ----------------------------------------------------------------*/
+
+    /// <summary>
+    /// Reusable output buffer for text/binary encoders: "clear()" keeps the
+    /// capacity, so encoding into the same buffer does not allocate once warmed up.
+    /// </summary>
+    class output_buffer {
+    public:
+
+        explicit output_buffer(size_t capacity = 4096) { reserve(capacity); }
+
+        output_buffer(const output_buffer&) = delete;
+        output_buffer& operator=(const output_buffer&) = delete;
+
+        const char* data() const { return m_data.get(); }
+        size_t size() const { return m_size; }
+        size_t capacity() const { return m_capacity; }
+        bool empty() const { return m_size == 0; }
+
+        /// <summary>
+        /// Discards the content (keeps the allocated memory).
+        /// </summary>
+        void clear() { m_size = 0; }
+
+        /// <summary>
+        /// Gets the content as string (allocates).
+        /// </summary>
+        std::string str() const { return std::string(m_data.get(), m_size); }
+
+        /// <summary>
+        /// Ensures room for "n" more bytes and returns the write position (see "commit()").
+        /// </summary>
+        /// <param name="n">The number of bytes.</param>
+        char* reserve(size_t n) {
+            if (m_size + n > m_capacity) {
+                size_t capacity = std::max(m_size + n, 2 * m_capacity);
+                std::unique_ptr<char[]> data(new char[capacity]);
+                if (m_size)
+                    std::memcpy(data.get(), m_data.get(), m_size);
+                m_data = std::move(data);
+                m_capacity = capacity;
+            }
+            return m_data.get() + m_size;
+        }
+
+        /// <summary>
+        /// Commits "n" bytes written at the position returned by "reserve()".
+        /// </summary>
+        void commit(size_t n) { m_size += n; }
+
+        void append(char value) { *reserve(1) = value; m_size++; }
+
+        void append(const char* text, size_t length) {
+            if (length)
+                std::memcpy(reserve(length), text, length);
+            m_size += length;
+        }
+
+        void append(const std::string& text) { append(text.data(), text.size()); }
+
+        /// <summary>
+        /// Appends an unsigned number as decimal text ("std::to_chars").
+        /// </summary>
+        void appendNumber(unsigned long long value) {
+            char* first = reserve(20);
+            m_size += std::to_chars(first, first + 20, value).ptr - first;
+        }
+
+        /// <summary>
+        /// Appends a string as a quoted JSON string (escaped).
+        /// </summary>
+        void appendJson(const std::string& text) {
+            static const char hex[] = "0123456789abcdef";
+            append('"');
+            for (char c : text) {
+                if (c == '"' || c == '\\') {
+                    append('\\');
+                    append(c);
+                }
+                else if ((unsigned char)c < 0x20) {
+                    char escaped[6] = { '\\', 'u', '0', '0', hex[(c >> 4) & 0xF], hex[c & 0xF] };
+                    append(escaped, sizeof(escaped));
+                }
+                else
+                    append(c);
+            }
+            append('"');
+        }
+
+        /// <summary>
+        /// Appends an unsigned number as variable length integer (LEB128, 1 byte for values < 128).
+        /// </summary>
+        void appendVarint(uint64_t value) {
+            char* first = reserve(10);
+            char* last = first;
+            while (value >= 0x80) {
+                *last++ = (char)(value | 0x80);
+                value >>= 7;
+            }
+            *last++ = (char)value;
+            m_size += last - first;
+        }
+
+        /// <summary>
+        /// Appends a string as length (varint) + bytes.
+        /// </summary>
+        void appendBinary(const std::string& text) {
+            appendVarint(text.size());
+            append(text);
+        }
+
+    private:
+        std::unique_ptr<char[]> m_data;
+        size_t m_size = 0;
+        size_t m_capacity = 0;
+    };
+
+
+    /// <summary>
+    /// Copies the text into [first, last) and returns the end position (nullptr if it does not fit).
+    /// </summary>
+    inline char* format(char* first, char* last, const char* text, size_t length) {
+        if (!first || (size_t)(last - first) < length)
+            return nullptr;
+        std::memcpy(first, text, length);
+        return first + length;
+    }
+
+    inline char* format(char* first, char* last, const std::string& text) {
+        return format(first, last, text.data(), text.size());
+    }
+
+    /// <summary>
+    /// Writes the number into [first, last) and returns the end position (nullptr if it does not fit).
+    /// </summary>
+    inline char* format(char* first, char* last, unsigned long long value) {
+        if (!first)
+            return nullptr;
+        auto result = std::to_chars(first, last, value);
+        return result.ec == std::errc() ? result.ptr : nullptr;
+    }
+
+    /// <summary>
+    /// Reads a variable length integer (see "output_buffer::appendVarint()"). Returns false on truncated input.
+    /// </summary>
+    inline bool readVarint(const char*& first, const char* last, uint64_t& value) {
+        value = 0;
+        for (unsigned int shift = 0; first < last && shift < 64; shift += 7) {
+            unsigned char byte = (unsigned char)*first++;
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    /// <summary>
+    /// Reads a string (see "output_buffer::appendBinary()"). Returns false on truncated input.
+    /// </summary>
+    inline bool readBinary(const char*& first, const char* last, std::string& value) {
+        uint64_t length;
+        if (!readVarint(first, last, length) || (uint64_t)(last - first) < length)
+            return false;
+        value.assign(first, (size_t)length);
+        first += length;
+        return true;
+    }
+
+
+    /// <summary>
+    /// Epoch based reclamation: readers pin the current epoch while holding references, 
+    /// and objects retired at epoch "e" can be released once every pinned reader is past "e".
+    /// 
+    /// Remark: fixed number of reader slots (EPOCH_READER_SLOTS), "pin()" spins when all are taken
+    /// Remark: sequentially consistent pin/scan (the pinned slot must be visible to "safe()" before reading)
+    /// </summary>
+    class epoch_manager {
+    public:
+        epoch_manager() {
+            for (auto& slot : m_slots)
+                slot.store(0, std::memory_order_relaxed);
+        }
+
+        /// <summary>
+        /// Gets the current (global) epoch.
+        /// </summary>
+        uint64_t current() const { return m_epoch.load(); }
+
+        /// <summary>
+        /// Starts a new epoch and returns it.
+        /// </summary>
+        uint64_t advance() { return m_epoch.fetch_add(1) + 1; }
 
+        /// <summary>
+        /// Pins the current epoch (lock-free). Returns the reader slot.
+        /// </summary>
+        size_t pin() {
+            while (true) {
+                for (size_t slot = 0; slot < EPOCH_READER_SLOTS; slot++) {
+                    uint64_t epoch = current();
+                    uint64_t expected = 0;
+                    if (!m_slots[slot].compare_exchange_strong(expected, epoch))
+                        continue;
+                    // the epoch may have been advanced meanwhile: publishes the newest one
+                    while (epoch != current()) {
+                        epoch = current();
+                        m_slots[slot].store(epoch);
+                    }
+                    return slot;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        /// <summary>
+        /// Releases the reader slot (see "pin()").
+        /// </summary>
+        void unpin(size_t slot) { m_slots[slot].store(0, std::memory_order_release); }
+
+        /// <summary>
+        /// Gets the oldest pinned epoch (the current epoch if there is no pinned reader), 
+        /// i.e. objects retired before it are not reachable anymore.
+        /// </summary>
+        uint64_t safe() const {
+            uint64_t value = current();
+            for (auto& slot : m_slots) {
+                uint64_t epoch = slot.load();
+                if (epoch && epoch < value)
+                    value = epoch;
+            }
+            return value;
+        }
+
+    private:
+        std::atomic<uint64_t> m_epoch{ 1 };
+        std::atomic<uint64_t> m_slots[EPOCH_READER_SLOTS];
+    };
+
+
+    /// <summary>
+    /// Parses a numeric identifier on its canonical form (digits only, no leading zeros), 
+    /// i.e. there is a single string for each number.
+    /// </summary>
+    inline bool parseId(const std::string& text, uint64_t& value) {
+        if (text.empty() || (text.size() > 1 && text[0] == '0'))
+            return false;
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+
+    /// <summary>
+    /// Direct indexed table of numeric keys: radix pages of 2^PageBits values, allocated on 
+    /// demand from the first inserted key, i.e. lookups are two array indexings (no hashing).
+    /// 
+    /// Remark: designed for mostly monotonic keys, "insert()" returns false for keys below the 
+    ///         first page or beyond PAGED_TABLE_MAX_PAGES pages (caller falls back to a hash map)
+    /// Remark: empty pages are released
+    /// </summary>
+    template <typename T, unsigned int PageBits = 12>
+    class paged_table {
+    public:
+        static constexpr size_t PAGE_SIZE = size_t(1) << PageBits;
+
+        explicit paged_table(memory_counter* counter = nullptr) : 
+            m_directory(tracking_allocator<page*>(counter)), m_allocator(counter) {}
+
+        ~paged_table() { clear(); }
+
+        paged_table(const paged_table&) = delete;
+        paged_table& operator=(const paged_table&) = delete;
+
+        /// <summary>
+        /// Gets the value by key (nullptr if not found).
+        /// </summary>
+        T* find(uint64_t key) const {
+            size_t index, offset;
+            if (!locate(key, index, offset) || index >= m_directory.size())
+                return nullptr;
+            page* target = m_directory[index];
+            if (!target || !(target->present[offset >> 6] & (1ull << (offset & 63))))
+                return nullptr;
+            return &target->values[offset];
+        }
+
+        /// <summary>
+        /// Inserts the value. Returns false if the key is already stored or out of the table range.
+        /// </summary>
+        bool insert(uint64_t key, const T& value) {
+            if (!m_size && !m_pages) {
+                // first key: defines the table base (page aligned)
+                m_base = key & ~(uint64_t)(PAGE_SIZE - 1);
+                m_directory.clear();
+            }
+            size_t index, offset;
+            if (!locate(key, index, offset) || index >= PAGED_TABLE_MAX_PAGES)
+                return false;
+            if (index >= m_directory.size())
+                m_directory.resize(index + 1, nullptr);
+            page*& target = m_directory[index];
+            if (!target) {
+                target = m_allocator.allocate(1);
+                new (target) page();
+                m_pages++;
+            }
+            uint64_t& present = target->present[offset >> 6];
+            const uint64_t bit = 1ull << (offset & 63);
+            if (present & bit)
+                return false;
+            present |= bit;
+            target->values[offset] = value;
+            target->count++;
+            m_size++;
+            return true;
+        }
+
+        /// <summary>
+        /// Removes the value by key. Returns false if not found.
+        /// </summary>
+        bool erase(uint64_t key) {
+            if (!find(key))
+                return false;
+            size_t index, offset;
+            locate(key, index, offset);
+            page*& target = m_directory[index];
+            target->present[offset >> 6] &= ~(1ull << (offset & 63));
+            target->values[offset] = T();
+            m_size--;
+            if (--target->count == 0)
+                release(target);
+            return true;
+        }
+
+        /// <summary>
+        /// Removes all values (and releases all pages).
+        /// </summary>
+        void clear() {
+            for (page*& target : m_directory)
+                if (target)
+                    release(target);
+            m_directory.clear();
+            m_directory.shrink_to_fit();
+            m_size = 0;
+        }
+
+        size_t size() const { return m_size; }
+        size_t pages() const { return m_pages; }
+
+    private:
+        struct page {
+            T values[PAGE_SIZE] = {};
+            uint64_t present[PAGE_SIZE / 64] = {};
+            size_t count = 0;
+        };
+
+        bool locate(uint64_t key, size_t& index, size_t& offset) const {
+            if (key < m_base)
+                return false;
+            index = (size_t)((key - m_base) >> PageBits);
+            offset = (size_t)(key & (PAGE_SIZE - 1));
+            return true;
+        }
+
+        void release(page*& target) {
+            target->~page();
+            m_allocator.deallocate(target, 1);
+            target = nullptr;
+            m_pages--;
+        }
+
+        std::vector<page*, tracking_allocator<page*>> m_directory;
+        tracking_allocator<page> m_allocator;
+        uint64_t m_base = 0;
+        size_t m_size = 0;
+        size_t m_pages = 0;
+    };
+
+
+    /// <summary>
+    /// Pinned epoch scope (see "epoch_manager::pin()")
+    /// </summary>
+    class epoch_guard {
+    public:
+        explicit epoch_guard(epoch_manager& manager) : m_manager(&manager), m_slot(manager.pin()) {}
+        epoch_guard(epoch_guard&& other) noexcept : m_manager(other.m_manager), m_slot(other.m_slot) { other.m_manager = nullptr; }
+        epoch_guard(const epoch_guard&) = delete;
+        epoch_guard& operator=(const epoch_guard&) = delete;
+        epoch_guard& operator=(epoch_guard&&) = delete;
+        ~epoch_guard() {
+            if (m_manager)
+                m_manager->unpin(m_slot);
+        }
+
+    private:
+        epoch_manager* m_manager;
+        size_t m_slot;
+    };
+}
+
+
+/*----------------------------------------------------------------
+    PROBLEM INTERFACE
+ ----------------------------------------------------------------*/
+
+
+struct RiskExposure;
+
+
+/// <summary>
+/// Order Transfer Object
+/// </summary>
+class Order
+{
+ 
+ public:
+         
+     /// <summary>
+     /// Initializes a new instance of the <see cref="Order"/> class.
+     /// </summary>
+     /// <param name="ordId">The ord identifier.</param>
+     /// <param name="secId">The sec identifier.</param>
+     /// <param name="side">The side.</param>
+     /// <param name="qty">The qty.</param>
+     /// <param name="user">The user.</param>
+     /// <param name="company">The company.</param>
+     Order(
+      const std::string& ordId,
+      const std::string& secId,
+      const std::string& side,
+      const unsigned int qty,
+      const std::string& user,
+      const std::string& company)
+      : m_orderId(ordId),
+        m_securityId(secId),
+        m_side(side),
+        m_qty(qty),
+        m_user(user),
+        m_company(company) {
+      m_workingQty = qty; 
+      m_mutex = std::make_shared<std::shared_mutex>();
+      m_locked = false;
+  }
+  
   /// <summary>
-  /// Returns order as string.
+  /// Gets the order unique identifier.
   /// </summary>
   /// <returns></returns>
-  std::string str() const {
-      utils::osyncstream os;
-      os << "order{id: " << orderId() << ", security: " << securityId() << ", side: " << side()
-          << ", qty: " << qty() << ", working: " << workingQty() << ", filled: " << filledQty()
-          << ", user: " << user() << ", company: " << company() << "}";
-      return os.str();
-  }
+  std::string orderId() const { return m_orderId; }  
 
-  // ** convenience operator (cast to string) **
-  operator std::string() const { return str(); }
-  
   /// <summary>
-  /// Formatted data operator (printing)
+  /// Gets the security unique identifier.
   /// </summary>
-  /// <param name="os">The os.</param>
-  /// <param name="order">The order.</param>
   /// <returns></returns>
-  friend utils::osyncstream& operator<<(utils::osyncstream& os, const Order& order) {
-      os << order.str();
-      return os;
-  }
-      
- private:
-  std::string m_orderId;     // unique order id
-  std::string m_securityId;  // security identifier
+  std::string securityId() const { return m_securityId; }  
+
+  /// <summary>
+  /// Gets order sides ("Buy"/"Sell").
+  /// </summary>
+  /// <returns></returns>
+  std::string side() const { return m_side; }  
+
+  /// <summary>
+  /// Gets the user identifier .
+  /// </summary>
+  /// <returns></returns>
+  std::string user() const { return m_user; }  
+
+  /// <summary>
+  /// Gets the Company identifier
+  /// </summary>
+  /// <returns></returns>
+  std::string company() const { return m_company; }  
+
+  /// <summary>
+  /// Gets the client session that entered the order (empty if none, see "OrderCache::cancelOrdersForSession()").
+  /// </summary>
+  /// <returns></returns>
+  const std::string& session() const { return m_session; }
+
+  /// <summary>
+  /// Sets the client session that entered the order (before adding it to the cache).
+  /// </summary>
+  /// <param name="session">The session identifier.</param>
+  void setSession(const std::string& session) { m_session = session; }
+
+  /// <summary>
+  /// Gets the order quantity of lots.
+  /// </summary>
+  /// <returns></returns>
+  unsigned int qty() const { return m_qty; }
+
+  // ** expiry: no expiry (the order is cancelled explicitly) **
+  static constexpr uint64_t GOOD_TILL_CANCEL = 0;
+
+  // ** expiry: the order expires at session end (see "OrderCache::endSession()") **
+  static constexpr uint64_t GOOD_FOR_DAY = UINT64_MAX;
+
+  /// <summary>
+  /// Gets the order expiry time (microseconds since epoch, GOOD_TILL_CANCEL or GOOD_FOR_DAY).
+  /// </summary>
+  /// <returns></returns>
+  uint64_t expiry() const { return m_expiry; }
+
+  /// <summary>
+  /// Gets the mutation sequence number of the last order change (add, fill or amend, see "OrderCache::getOrdersChangedSince()").
+  /// </summary>
+  /// <returns></returns>
+  uint64_t changeSequence() const { return m_changeSequence; }
+
+  /// <summary>
+  /// Sets the order expiry time (before adding it to the cache, see "OrderCache::expireOrders()").
+  /// </summary>
+  /// <param name="expiry">The expiry (microseconds since epoch, GOOD_TILL_CANCEL or GOOD_FOR_DAY).</param>
+  void setExpiry(const uint64_t& expiry) { m_expiry = expiry; }
+  
+  //----------------------------------------------------------------
+
+  /// <summary>
+  /// Gets the number of working lots.
+  /// </summary>
+  /// <returns></returns>
+  unsigned int workingQty() const { return m_workingQty; }
+  
+  /// <summary>
+  /// Gets the number of filled lots.
+  /// </summary>
+  /// <returns></returns>
+  unsigned int filledQty() const { return m_qty - m_workingQty; }
+    
+  /// <summary>
+  /// Subtracts the quantity of working lots to the current order.
+  /// </summary>
+  /// <param name="qty">The qty.</param>
+  inline void fillLots(const unsigned int& qty) {
+      if (m_workingQty > qty)
+          m_workingQty -= qty;
+      else
+          m_workingQty = 0;
+  }
+
+  /// <summary>
+  /// Adds the specified quantity of working lots to the current order.
+  /// </summary>
+  /// <param name="qty">The qty.</param>
+  inline void unfillLots(const unsigned int& qty) {
+      m_workingQty += qty;
+      if (m_workingQty > m_qty)
+          m_workingQty = m_qty;
+  }
+  
+  /// <summary>
+  /// Return true if the order is fully filled (i.e. no working lots), otherwise false.
+  /// </summary>
+  inline bool isFilled() const { return m_workingQty == 0; }
+
+  /// <summary>
+  /// Resets the order matches.
+  /// </summary>
+  inline void resetFills() { m_workingQty = m_qty; }
+  
+  // ** convenience accessor **
+  unsigned int operator+=(unsigned int qty) { unfillLots(qty); return m_workingQty; }  
+
+  // ** convenience accessor **
+  unsigned int operator-=(unsigned int qty) { fillLots(qty); return m_workingQty; }
+  
+  /// <summary>
+  /// Locks the current order instance.
+  /// </summary>
+  /// <param name="readonly">true for read shared access, false to block write acess.</param>
+  /// <returns></returns>
+  //bool lock(const bool shared = false) const {
+  bool lock(const bool shared = false) {
+      m_locked = shared? m_mutex->try_lock_shared(): m_mutex->try_lock();
+	  return m_locked;
+  }
+  
+  /// <summary>
+  /// Unlocks the current order instance.
+  /// </summary>
+  /// <param name="readonly">true for read shared access, false to block write acess.</param>
+  bool unlock(const bool shared = false) {
+      if (!m_locked)
+          return false;
+
+      if (shared)
+          m_mutex->unlock_shared();
+      else
+          m_mutex->unlock(); 
+
+	  m_locked = false;
+	  return true;
+  }
+
+
+  bool locked() const { return m_locked; }
+
+  /// <summary>
+  /// Returns true case the order was cancelled and waits for reclamation (see "OrderCache::setDeferredDeletion()").
+  /// </summary>
+  /// <returns></returns>
+  bool cancelled() const { return m_cancelled; }
+
+  /// <summary>
+  /// Returns a copy of the order with its own lock (copies share the lock otherwise).
+  /// </summary>
+  /// <returns></returns>
+  Order clone() const {
+      Order order{ m_orderId, m_securityId, m_side, m_qty, m_user, m_company };
+      order.m_workingQty = m_workingQty;
+      order.m_expiry = m_expiry;
+      order.m_session = m_session;
+      return order;
+  }
+
+  /// <summary>
+  /// Gets the heap bytes owned by the current order instance, i.e. the
+  /// string identifiers that spill out of the small string buffer.
+  /// </summary>
+  /// <returns></returns>
+  size_t heapBytes() const {
+      return utils::heapBytes(m_orderId) + utils::heapBytes(m_securityId) + utils::heapBytes(m_side)
+          + utils::heapBytes(m_user) + utils::heapBytes(m_company) + utils::heapBytes(m_session);
+  }
+
+  /// <summary>
+  /// Formats the order as text into the caller-provided buffer [first, last) (no allocation).
+  /// </summary>
+  /// <param name="first">The buffer start.</param>
+  /// <param name="last">The buffer end.</param>
+  /// <returns>the end of the written text, or nullptr if the buffer is too small</returns>
+  char* format(char* first, char* last) const {
+      first = utils::format(first, last, "order{id: ", 10);
+      first = utils::format(first, last, m_orderId);
+      first = utils::format(first, last, ", security: ", 12);
+      first = utils::format(first, last, m_securityId);
+      first = utils::format(first, last, ", side: ", 8);
+      first = utils::format(first, last, m_side);
+      first = utils::format(first, last, ", qty: ", 7);
+      first = utils::format(first, last, (unsigned long long)m_qty);
+      first = utils::format(first, last, ", working: ", 11);
+      first = utils::format(first, last, (unsigned long long)m_workingQty);
+      first = utils::format(first, last, ", filled: ", 10);
+      first = utils::format(first, last, (unsigned long long)filledQty());
+      first = utils::format(first, last, ", user: ", 8);
+      first = utils::format(first, last, m_user);
+      first = utils::format(first, last, ", company: ", 11);
+      first = utils::format(first, last, m_company);
+      if (!m_session.empty()) {
+          first = utils::format(first, last, ", session: ", 11);
+          first = utils::format(first, last, m_session);
+      }
+      if (m_expiry != GOOD_TILL_CANCEL) {
+          first = utils::format(first, last, ", expiry: ", 10);
+          first = utils::format(first, last, (unsigned long long)m_expiry);
+      }
+      return utils::format(first, last, "}", 1);
+  }
+
+  /// <summary>
+  /// Formats the order as text at the end of the output buffer.
+  /// </summary>
+  /// <param name="out">The output buffer.</param>
+  void format(utils::output_buffer& out) const {
+      size_t length = 160 + m_orderId.size() + m_securityId.size() + m_side.size() + m_user.size() + m_company.size() + m_session.size();
+      char* first = out.reserve(length);
+      out.commit(format(first, first + length) - first);
+  }
+
+  /// <summary>
+  /// Encodes the order as a JSON object at the end of the output buffer.
+  /// </summary>
+  /// <param name="out">The output buffer.</param>
+  void writeJson(utils::output_buffer& out) const {
+      out.append("{\"id\":", 6);
+      out.appendJson(m_orderId);
+      out.append(",\"security\":", 12);
+      out.appendJson(m_securityId);
+      out.append(",\"side\":", 8);
+      out.appendJson(m_side);
+      out.append(",\"qty\":", 7);
+      out.appendNumber(m_qty);
+      out.append(",\"working\":", 11);
+      out.appendNumber(m_workingQty);
+      out.append(",\"user\":", 8);
+      out.appendJson(m_user);
+      out.append(",\"company\":", 11);
+      out.appendJson(m_company);
+      out.append(",\"session\":", 11);
+      out.appendJson(m_session);
+      out.append(",\"expiry\":", 10);
+      out.appendNumber(m_expiry);
+      out.append('}');
+  }
+
+  /// <summary>
+  /// Encodes the order in compact binary format at the end of the output buffer
+  /// (strings as varint length + bytes, quantities as varints).
+  /// </summary>
+  /// <param name="out">The output buffer.</param>
+  void writeBinary(utils::output_buffer& out) const {
+      out.appendBinary(m_orderId);
+      out.appendBinary(m_securityId);
+      out.appendBinary(m_side);
+      out.appendVarint(m_qty);
+      out.appendVarint(m_workingQty);
+      out.appendBinary(m_user);
+      out.appendBinary(m_company);
+      out.appendBinary(m_session);
+      out.appendVarint(m_expiry);
+  }
+
+  /// <summary>
+  /// Decodes an order written by "writeBinary()" and advances the input position.
+  /// </summary>
+  /// <param name="first">The input position.</param>
+  /// <param name="last">The input end.</param>
+  /// <param name="order">The decoded order.</param>
+  /// <returns>false on truncated input</returns>
+  static bool readBinary(const char*& first, const char* last, Order& order) {
+      uint64_t qty, working;
+      if (!utils::readBinary(first, last, order.m_orderId) || !utils::readBinary(first, last, order.m_securityId)
+          || !utils::readBinary(first, last, order.m_side) || !utils::readVarint(first, last, qty)
+          || !utils::readVarint(first, last, working) || !utils::readBinary(first, last, order.m_user)
+          || !utils::readBinary(first, last, order.m_company) || !utils::readBinary(first, last, order.m_session)
+          || !utils::readVarint(first, last, order.m_expiry))
+          return false;
+      order.m_qty = (unsigned int)qty;
+      order.m_workingQty = (unsigned int)working;
+      return true;
+  }
+
+  /// <summary>
+  /// Returns order as string.
+  /// </summary>
+  /// <returns></returns>
+  std::string str() const {
+      thread_local utils::output_buffer out(256);
+      out.clear();
+      format(out);
+      return out.str();
+  }
+
+  // ** convenience operator (cast to string) **
+  // Remark: allocates a string, use "format()" on hot paths
+  operator std::string() const { return str(); }
+  
+  /// <summary>
+  /// Formatted data operator (printing)
+  /// </summary>
+  /// <param name="os">The os.</param>
+  /// <param name="order">The order.</param>
+  /// <returns></returns>
+  friend utils::osyncstream& operator<<(utils::osyncstream& os, const Order& order) {
+      thread_local utils::output_buffer out(256);
+      out.clear();
+      order.format(out);
+      ((std::ostringstream&)os).write(out.data(), out.size());
+      return os;
+  }
+      
+ private:
+  std::string m_orderId;     // unique order id
+  std::string m_securityId;  // security identifier
   std::string m_side;        // side of the order, eg Buy or Sell
   unsigned int m_qty = 0;    // qty for this order
   std::string m_user;        // user name who owns this order
   std::string m_company;     // company for user
+  std::string m_session;     // client session (optional)
 
   unsigned int m_workingQty = 0;   
   bool m_locked = false;
+  bool m_cancelled = false;  // tombstone (deferred deletion)
+  uint32_t m_userSlot = 0;       // position on the user orders index (OrderCache)
+  uint32_t m_companySlot = 0;    // position on the company orders index (OrderCache)
+  uint32_t m_securitySlot = 0;   // position on the security orders index (OrderCache)
+  uint32_t m_sessionSlot = 0;    // position on the session orders index (OrderCache)
+  uint32_t m_sideSlot = 0;       // position on the security side book (OrderCache)
+  uint32_t m_companyKey = 0;     // interned company (OrderCache)
+  uint64_t m_arrival = 0;        // arrival sequence on the side book (OrderCache)
+  uint64_t m_expiry = GOOD_TILL_CANCEL;  // expiry time (microseconds since epoch)
+  uint64_t m_changeSequence = 0;  // mutation sequence of the last change (OrderCache)
+  uint32_t m_expiryBucket = UINT32_MAX;  // timing wheel bucket, UINT32_MAX if not scheduled (OrderCache)
+  uint32_t m_expirySlot = 0;     // position on the timing wheel bucket (OrderCache)
+  RiskExposure* m_userRisk = nullptr;      // user running aggregates, if risk checks are enabled (OrderCache)
+  RiskExposure* m_companyRisk = nullptr;   // company running aggregates (OrderCache)
+  uint64_t* m_userSecurityRisk = nullptr;     // user working lots on the order security (OrderCache)
+  uint64_t* m_companySecurityRisk = nullptr;  // company working lots on the order security (OrderCache)
   std::shared_ptr<std::shared_mutex> m_mutex;  
+
+  /// <summary>
+  /// Resets the bookkeeping of the cache that stored the order (slots, tombstone, expiry schedule, 
+  /// change sequence and risk aggregates), i.e. copies of a stored order are added as new orders.
+  /// </summary>
+  void resetCacheState() {
+      m_cancelled = false;
+      m_userSlot = m_companySlot = m_securitySlot = m_sessionSlot = m_sideSlot = 0;
+      m_companyKey = 0;
+      m_arrival = 0;
+      m_changeSequence = 0;
+      m_expiryBucket = UINT32_MAX;
+      m_expirySlot = 0;
+      m_userRisk = m_companyRisk = nullptr;
+      m_userSecurityRisk = m_companySecurityRisk = nullptr;
+  }
+
+  friend class OrderCache;
+};
+
+
+
+
+/// <summary>
+/// Order Cache interface
+/// </summary>
+class OrderCacheInterface
+{
+
+ public:
+   
+     /// <summary>
+     /// Adds the order.
+     /// </summary>
+     /// <param name="order">The order.</param>
+     virtual void addOrder(Order order) = 0;
+   
+     /// <summary>
+     /// Removes the order with this unique order id
+     /// </summary>
+     /// <param name="orderId">The order identifier.</param>
+     virtual void cancelOrder(const std::string& orderId) = 0;
+   
+     /// <summary>
+     /// Removes all orders for this user
+     /// </summary>
+     /// <param name="user">The user.</param>
+     virtual void cancelOrdersForUser(const std::string& user) = 0;
+       
+     /// <summary>
+     /// Removes all orders in the cache for this security with qty >= minQty
+     /// </summary>
+     /// <param name="securityId">The security identifier.</param>
+     /// <param name="minQty">The minimum qty.</param>
+     virtual void cancelOrdersForSecIdWithMinimumQty(const std::string& securityId, unsigned int minQty) = 0;
+      
+     /// <summary>
+     /// Returns the total qty that can match for the security id
+     /// </summary>
+     /// <param name="securityId">The security identifier.</param>
+     /// <returns></returns>
+     virtual unsigned int getMatchingSizeForSecurity(const std::string& securityId) = 0;
+   
+     /// <summary>
+     /// Returns all orders in cache in a vector
+     /// </summary>
+     /// <returns></returns>
+     virtual std::vector<Order> getAllOrders() const = 0;
+
 };
 
 
 
+/// <summary>
+/// Provides an implementation for the OrderCache class (Order storage - memory tracked list). 
+/// </summary>
+typedef typename std::list<Order, utils::tracking_allocator<Order>> order_storage;
+
+/// <summary>
+/// Provides an implementation for the OrderCache class (Order iterator/pointer). 
+/// </summary>
+typedef typename order_storage::iterator order_ptr;
+
+/// <summary>
+/// Provides an implementation for the OrderCache class (vector of Order iterator/pointer). 
+/// </summary>
+typedef typename std::vector<order_ptr, utils::tracking_allocator<order_ptr>> order_list;
+
+/// <summary>
+/// Defines a contiguous list of lots (quantity or working lots) or interned keys
+/// </summary>
+typedef typename std::vector<uint32_t, utils::tracking_allocator<uint32_t>> quantity_list;
+
+/// <summary>
+/// Security side book: the orders (arrival ordering) and, at the same positions, 
+/// their working lots and interned company (structure of arrays), i.e. contiguous 
+/// data for the vectorized matching scan (see "OrderCache::setVectorizedMatching()")
+/// 
+/// Remark: working lots are 0 for filled and cancelled orders
+/// </summary>
+struct side_book {
+    typedef utils::tracking_allocator<order_ptr> allocator_type;
+
+    order_list orders;
+    quantity_list working;
+    quantity_list companies;
+
+    side_book() = default;
+    explicit side_book(const allocator_type& allocator) : orders(allocator), working(allocator), companies(allocator) {}
+    side_book(const side_book& other, const allocator_type& allocator) : 
+        orders(other.orders, allocator), working(other.working, allocator), companies(other.companies, allocator) {}
+    side_book(side_book&& other, const allocator_type& allocator) : 
+        orders(std::move(other.orders), allocator), working(std::move(other.working), allocator), companies(std::move(other.companies), allocator) {}
+
+    size_t size() const { return orders.size(); }
+    bool empty() const { return orders.empty(); }
+    size_t capacityBytes() const { 
+        return orders.capacity() * sizeof(order_ptr) + (working.capacity() + companies.capacity()) * sizeof(uint32_t); 
+    }
+};
+
+
+/// <summary>
+/// Order fill information
+/// 
+/// ** this structure is NOT required for the proposed problem itself, just a "extended feature" **
+/// 
+/// Remark: only used at the OrderCache::GetMatches()/GetMatchesBySecurity() methods
+/// Remark: requeires the definition of EXTENDED_INTERFACE macro in order to be evaluated
+/// </summary>
+class OrderFill {
+
+ public:
+    OrderFill(
+        const std::string& buyOrderId,
+        const std::string& sellOrderId,
+        const unsigned int qty): 
+        m_buyOrderId(buyOrderId),
+        m_sellOrderId(sellOrderId),
+        m_qty(qty) {  }
+
+    /// <summary>
+    /// The buy order identifier
+    /// </summary>
+    const std::string buyOrderId() const { return m_buyOrderId; }
+        
+    /// <summary>
+    /// The sell order identifier
+    /// </summary>
+    const std::string sellOrderId() const { return m_sellOrderId; }
+
+    /// <summary>
+    /// The filled quantity of lots
+    /// </summary>
+    const unsigned int qty() const { return m_qty; }
+
+    /// <summary>
+    /// The fill sequence number on the order cache (see OrderCache::getOrderMatches())
+    /// </summary>
+    const uint64_t sequence() const { return m_sequence; }
+
+    /// <summary>
+    /// Gets the heap bytes owned by the order fill (identifiers beyond the small string buffer).
+    /// </summary>
+    size_t heapBytes() const { return utils::heapBytes(m_buyOrderId) + utils::heapBytes(m_sellOrderId); }
+
+    /// <summary>
+    /// Formats the order fill as text into the caller-provided buffer [first, last) (no allocation).
+    /// </summary>
+    /// <returns>the end of the written text, or nullptr if the buffer is too small</returns>
+    char* format(char* first, char* last) const {
+        first = utils::format(first, last, "order fill {buy: ", 17);
+        first = utils::format(first, last, m_buyOrderId);
+        first = utils::format(first, last, ", sell: ", 8);
+        first = utils::format(first, last, m_sellOrderId);
+        first = utils::format(first, last, ", qty: ", 7);
+        first = utils::format(first, last, (unsigned long long)m_qty);
+        return utils::format(first, last, "}", 1);
+    }
+
+    /// <summary>
+    /// Formats the order fill as text at the end of the output buffer.
+    /// </summary>
+    void format(utils::output_buffer& out) const {
+        size_t length = 64 + m_buyOrderId.size() + m_sellOrderId.size();
+        char* first = out.reserve(length);
+        out.commit(format(first, first + length) - first);
+    }
+
+    /// <summary>
+    /// Encodes the order fill as a JSON object at the end of the output buffer.
+    /// </summary>
+    void writeJson(utils::output_buffer& out) const {
+        out.append("{\"buy\":", 7);
+        out.appendJson(m_buyOrderId);
+        out.append(",\"sell\":", 8);
+        out.appendJson(m_sellOrderId);
+        out.append(",\"qty\":", 7);
+        out.appendNumber(m_qty);
+        out.append(",\"sequence\":", 12);
+        out.appendNumber(m_sequence);
+        out.append('}');
+    }
+
+    /// <summary>
+    /// Encodes the order fill in compact binary format at the end of the output buffer.
+    /// </summary>
+    void writeBinary(utils::output_buffer& out) const {
+        out.appendBinary(m_buyOrderId);
+        out.appendBinary(m_sellOrderId);
+        out.appendVarint(m_qty);
+        out.appendVarint(m_sequence);
+    }
+
+    /// <summary>
+    /// Decodes an order fill written by "writeBinary()" and advances the input position.
+    /// </summary>
+    /// <returns>false on truncated input</returns>
+    static bool readBinary(const char*& first, const char* last, OrderFill& fill) {
+        uint64_t qty;
+        if (!utils::readBinary(first, last, fill.m_buyOrderId) || !utils::readBinary(first, last, fill.m_sellOrderId)
+            || !utils::readVarint(first, last, qty) || !utils::readVarint(first, last, fill.m_sequence))
+            return false;
+        fill.m_qty = (unsigned int)qty;
+        return true;
+    }
+
+    /// <summary>
+    /// Returns order fill as string.
+    /// </summary>
+    /// <returns></returns>
+    std::string str() const {
+        thread_local utils::output_buffer out(128);
+        out.clear();
+        format(out);
+        return out.str();
+    }
+
+    // ** convenience operator (cast to string) **
+    // Remark: allocates a string, use "format()" on hot paths
+    operator std::string() const { return str(); }
+
+    /// <summary>
+    /// Formatted data operator (printing)
+    /// </summary>
+    /// <param name="os">The os.</param>
+    /// <param name="order">The order.</param>
+    /// <returns></returns>
+    friend utils::osyncstream& operator<<(utils::osyncstream& os, const OrderFill& fill) {
+        thread_local utils::output_buffer out(128);
+        out.clear();
+        fill.format(out);
+        ((std::ostringstream&)os).write(out.data(), out.size());
+        return os;
+    }
+    
+ private:
+    std::string m_buyOrderId;
+    std::string m_sellOrderId;    
+    unsigned int m_qty = 0;
+    uint64_t m_sequence = 0;
+
+    friend class OrderCache;
+};
+
+
+
+
+/// <summary>
+/// Encoding used by OrderCache::exportOrders()
+/// </summary>
+enum class ExportFormat {
+    Json,     // JSON array of objects (see Order::writeJson())
+    Binary    // varint length prefixed records (see Order::writeBinary())
+};
+
+
+/// <summary>
+/// Memory usage of an internal data structure (see OrderCache::memoryReport())
+/// 
+/// Remark: "allocatedBytes" comes from tracking allocators (nodes, buckets and arrays, exact),
+///         "stringBytes" is the heap spill of the string keys/fields beyond the small string buffer
+/// </summary>
+struct MemoryUsage {
+    size_t elements = 0;
+    size_t allocations = 0;
+    size_t allocatedBytes = 0;
+    size_t peakBytes = 0;
+    size_t stringBytes = 0;
+
+    size_t totalBytes() const { return allocatedBytes + stringBytes; }
+};
+
+
+/// <summary>
+/// Memory usage attributed to a single security (see OrderCache::memoryReport())
+/// 
+/// Remark: node sizes are derived from the element types, since the per-security 
+///         containers share the allocation counter of their parent index
+/// </summary>
+struct SecurityMemoryUsage {
+    size_t orders = 0;
+    size_t orderBytes = 0;      // order list nodes + string spill
+    size_t indexBytes = 0;      // order id / user / security index entries
+    size_t sideIndexBytes = 0;  // long/short side vectors (exact capacity)
+
+    size_t totalBytes() const { return orderBytes + indexBytes + sideIndexBytes; }
+};
+
+
+/// <summary>
+/// Memory footprint report (see OrderCache::memoryReport())
+/// </summary>
+struct MemoryReport {
+    std::map<std::string, MemoryUsage> structures;          // by internal data structure name
+    std::map<std::string, SecurityMemoryUsage> securities;  // by security identifier
+    size_t orderMutexBytes = 0;                             // per order "std::shared_mutex" (estimated, not tracked)
+
+    /// <summary>
+    /// Gets the total bytes used by all data structures.
+    /// </summary>
+    size_t totalBytes() const {
+        size_t total = orderMutexBytes;
+        for (auto& item : structures)
+            total += item.second.totalBytes();
+        return total;
+    }
+
+    /// <summary>
+    /// Returns the report as a printable table.
+    /// </summary>
+    std::string str() const {
+        std::ostringstream os;
+        os << "memory report {total: " << totalBytes() << " bytes}\n";
+        for (auto& item : structures)
+            os << "  " << item.first << ": " << item.second.totalBytes() << " bytes [elements: " << item.second.elements
+               << ", allocations: " << item.second.allocations << ", allocated: " << item.second.allocatedBytes
+               << ", peak: " << item.second.peakBytes << ", strings: " << item.second.stringBytes << "]\n";
+        os << "  order mutexes (estimated): " << orderMutexBytes << " bytes\n";
+        for (auto& item : securities)
+            os << "  security '" << item.first << "': " << item.second.totalBytes() << " bytes [orders: " << item.second.orders
+               << ", order bytes: " << item.second.orderBytes << ", indexes: " << item.second.indexBytes
+               << ", side indexes: " << item.second.sideIndexBytes << "]\n";
+        return os.str();
+    }
+};
+
+
+/// <summary>
+/// Low latency memory arena report (see OrderCache::reserveArena())
+/// </summary>
+struct ArenaReport {
+    std::string pages = "none";   // "huge" (explicit 2 MB pages), "transparent" (advice), "standard" or "none" (heap)
+    size_t reservedBytes = 0;     // arena size (prefaulted)
+    size_t usedBytes = 0;         // bump allocated bytes (free lists included)
+    size_t fallbacks = 0;         // allocations served by the heap (arena exhausted)
+    bool locked = false;          // locked in memory (no swapping)
+    size_t minorFaults = 0;       // process page faults since the session start (see OrderCache::startSession())
+    size_t majorFaults = 0;
+    size_t stringHeapBytes = 0;   // order strings longer than the SSO buffer (heap allocated, outside the arena)
+    size_t stringHeapOrders = 0;  // orders owning at least one of those strings
+
+    /// <summary>
+    /// Returns the report as a printable line.
+    /// </summary>
+    std::string str() const {
+        std::ostringstream os;
+        os << "arena report {pages: " << pages << ", reserved: " << reservedBytes << " bytes, used: " << usedBytes
+           << " bytes, fallbacks: " << fallbacks << ", locked: " << (locked ? "yes" : "no")
+           << ", session page faults: " << minorFaults << " minor / " << majorFaults << " major"
+           << ", string heap: " << stringHeapBytes << " bytes (" << stringHeapOrders << " orders)}\n";
+        return os.str();
+    }
+};
+
+
+
+
+/// <summary>
+/// Queue priority of an order after a quantity increase (see OrderCache::amendOrder())
+/// Remark: quantity reductions always keep the order priority
+/// </summary>
+enum class AmendPolicy {
+    LosePriority,   // re-queued at the end of its side index (exchange convention)
+    KeepPriority    // stays at its current position
+};
+
+
+/// <summary>
+/// Order matching mode (see OrderCache::setMatchingMode())
+/// </summary>
+enum class MatchingMode {
+    Default,   // compile time mode: at "addOrder()" (USE_CACHED_MATCHING_AT_ADD_ORDER) or at every query
+    Lazy,      // "addOrder()" marks the security dirty, the next query matches the orders added since the last one
+    Adaptive   // each security switches between eager (at "addOrder()") and lazy matching by its adds per query
+};
+
+
+/// <summary>
+/// Matching strategy and costs of a security (see OrderCache::matchingStats())
+/// </summary>
+struct SecurityMatchingStats {
+    bool eager = true;              // current strategy (adaptive matching), otherwise lazy
+    size_t adds = 0;                // orders added
+    size_t queries = 0;             // matching size queries
+    double addsPerQuery = 0;        // smoothed adds between queries (switch criterion)
+    size_t switches = 0;            // strategy switches
+    size_t eagerMatches = 0;        // orders matched at "addOrder()"
+    uint64_t eagerNanoseconds = 0;  // time matching at "addOrder()"
+    size_t lazyMatches = 0;         // orders matched at query (pending orders)
+    uint64_t lazyNanoseconds = 0;   // time matching at query
+
+    size_t addsSinceQuery = 0;      // current run of adds (switch criterion)
+};
+
+
+/// <summary>
+/// Strategy switch decision of a security (see OrderCache::matchingStats())
+/// </summary>
+struct MatchingSwitch {
+    std::string securityId;
+    bool eager = true;              // new strategy
+    double addsPerQuery = 0;        // smoothed adds between queries at the decision
+    size_t addsSinceQuery = 0;      // current run of adds at the decision
+};
+
+
+/// <summary>
+/// Matching strategies report (lazy and adaptive matching, see OrderCache::matchingStats())
+/// </summary>
+struct MatchingStats {
+    std::map<std::string, SecurityMatchingStats> securities;  // by security identifier
+    std::vector<MatchingSwitch> switches;                      // last strategy switches (oldest first)
+
+    /// <summary>
+    /// Returns the report as a printable table.
+    /// </summary>
+    std::string str() const {
+        std::ostringstream os;
+        os << "matching stats {securities: " << securities.size() << ", switches: " << switches.size() << "}\n";
+        for (auto& item : securities)
+            os << "  security '" << item.first << "': " << (item.second.eager ? "eager" : "lazy") 
+               << " [adds: " << item.second.adds << ", queries: " << item.second.queries 
+               << ", adds/query: " << item.second.addsPerQuery << ", switches: " << item.second.switches
+               << ", eager: " << item.second.eagerMatches << " orders / " << item.second.eagerNanoseconds << " ns"
+               << ", lazy: " << item.second.lazyMatches << " orders / " << item.second.lazyNanoseconds << " ns]\n";
+        return os.str();
+    }
+};
+
+
+/// <summary>
+/// Pre-trade risk limits of a user or company, on working lots (see OrderCache::setRiskLimits())
+/// </summary>
+struct RiskLimits {
+    uint64_t maxSideQty = UINT64_MAX;      // per side (buy / sell)
+    uint64_t maxSecurityQty = UINT64_MAX;  // per security (both sides)
+    uint64_t maxTotalQty = UINT64_MAX;     // overall
+};
+
+
+/// <summary>
+/// Reason of an order rejection (see OrderCache::addOrderChecked() and OrderCache::amendOrderChecked())
+/// </summary>
+enum class RiskReject {
+    None,                 // accepted
+    DuplicateOrder,       // order id already in the cache
+    UnknownOrder,         // order id not found (amend)
+    UserSideLimit,
+    UserSecurityLimit,
+    UserTotalLimit,
+    CompanySideLimit,
+    CompanySecurityLimit,
+    CompanyTotalLimit
+};
+
+
+/// <summary>
+/// Running aggregates of the working lots of a user or company (see OrderCache::userExposure())
+/// </summary>
+struct RiskExposure {
+    typedef std::unordered_map<std::string, uint64_t, std::hash<std::string>, std::equal_to<std::string>,
+        utils::tracking_allocator<std::pair<const std::string, uint64_t>>> security_lots;
+
+    uint64_t buy = 0;                                        // working lots on buy orders
+    uint64_t sell = 0;                                       // working lots on sell orders
+    security_lots securities;                                // working lots by security (both sides)
+
+    uint64_t total() const { return buy + sell; }
+};
+
+
+/// <summary>
+/// Resolution of the matched volume series (see OrderCache::getMatchedVolume())
+/// </summary>
+enum class VolumeResolution {
+    Second,   // last VOLUME_SECOND_BUCKETS seconds
+    Minute    // last VOLUME_MINUTE_BUCKETS minutes
+};
+
+
+/// <summary>
+/// Matched lots of a security on a time interval (see OrderCache::getMatchedVolume())
+/// </summary>
+struct VolumeBucket {
+    uint64_t start = 0;    // interval start (microseconds since epoch)
+    uint64_t volume = 0;   // matched lots
+};
+
+
+/// <summary>
+/// Orders changed since a mutation sequence number (see OrderCache::getOrdersChangedSince())
+/// </summary>
+struct OrderChanges {
+    uint64_t sequence = 0;               // current mutation sequence (next "since")
+    bool resync = false;                 // the change log does not cover "since": "orders" is the whole book (replace the copy)
+    std::vector<Order> orders;           // added / changed orders (current state, by last change)
+    std::vector<std::string> cancelled;  // tombstones: cancelled order ids
+};
+
+
+/// <summary>
+/// Mutation of an order cache (replication stream, see OrderCacheReplica)
+/// </summary>
+enum class MutationType {
+    AddOrder,
+    CancelOrder,
+    CancelOrdersForUser,
+    CancelOrdersForSecIdWithMinimumQty,
+    CancelOrdersForCompany,
+    CancelOrdersForSession,
+    AmendOrder,
+    ExpireOrders,
+    EndSession
+};
+
+
+/// <summary>
+/// Mutation applied to the primary order cache (replication stream, see OrderCacheReplica)
+/// </summary>
+struct OrderMutation {
+    MutationType type = MutationType::AddOrder;
+    std::optional<Order> order{}; // added order (AddOrder)
+    std::string key{};            // order id, user, security id, company or session
+    unsigned int qty = 0;         // minimum quantity (CancelOrdersForSecIdWithMinimumQty) or new quantity (AmendOrder)
+    AmendPolicy policy = AmendPolicy::LosePriority;   // (AmendOrder)
+    uint64_t sequence = 0;        // replication sequence number
+    std::chrono::steady_clock::time_point timestamp{};  // primary time of the publication
+    uint64_t time = 0;            // expiry time (ExpireOrders)
+};
+
+
+/// <summary>
+/// Staleness of a read replica (see OrderCacheReplica::staleness())
+/// </summary>
+struct ReplicaStaleness {
+    uint64_t pendingMutations = 0;   // published by the primary, not yet applied
+    uint64_t overflowMutations = 0;  // published while the queue was full (spilled, the primary never waits)
+    long long lagMicroseconds = 0;   // primary time between the last applied and the last published mutation
+};
+
+
+class OrderCacheReplica;
+
+
+/// <summary>
+/// Order Cache
+/// </summary>
+/// <seealso cref="OrderCacheInterface" />
+class OrderCache : public OrderCacheInterface
+{
+
+  public:    
+    /// <summary>
+    /// Initializes a new instance of the <see cref="OrderCache"/> class.
+    /// </summary>
+    OrderCache();
+
+    /// <summary>
+    /// Finalizes an instance of the <see cref="OrderCache"/> class (stops the background reclamation, if any).
+    /// </summary>
+    ~OrderCache();
+
+    /// <summary>
+    /// Adds the order into current order cache.
+    /// Remark: O(1) amortized (hash inserts and array appends), plus O(counterparties) matching at add
+    /// </summary>
+    /// <param name="order">The order.</param>
+    void addOrder(Order order) override;
+
+    /// <summary>
+    /// Adds the order into current order cache, checking the pre-trade risk limits first (see 
+    /// "setRiskLimits()"): the order is rejected, before any index insertion, if its lots would 
+    /// push the working lots of its user or company past a limit (per side, per security or overall).
+    /// 
+    /// Remark: O(1) amortized, as "addOrder()" - running aggregates maintained on add, fill, amend and cancel
+    /// Remark: lazy matching: orders waiting for matching count with all their lots (conservative)
+    /// </summary>
+    /// <param name="order">The order.</param>
+    /// <returns>the reject reason, RiskReject::None if added</returns>
+    RiskReject addOrderChecked(Order order);
+    
+    /// <summary>
+    /// Cancels the order by specified Id (thread-safe).
+    /// Remark: O(1)
+    /// </summary>
+    /// <param name="orderId">The order identifier.</param>
+    void cancelOrder(const std::string& orderId) override;
+    
+    /// <summary>
+    /// Cancels the orders for the specified user  (thread-safe).
+    /// </summary>
+    /// <param name="user">The user.</param>
+    void cancelOrdersForUser(const std::string& user) override;
+
+    /// <summary>
+    /// Cancels the orders for the specified company (thread-safe), i.e. firm "kill switch".
+    /// 
+    /// Remark: single bulk operation - O(k) plus one compaction pass per affected side index
+    /// Remark: ** this method is NOT required for the proposed problem itself, just a "aditional feature"... **
+    /// </summary>
+    /// <param name="company">The company.</param>
+    void cancelOrdersForCompany(const std::string& company);
+
+    /// <summary>
+    /// Cancels the orders entered by the specified client session (thread-safe), i.e. cancel on 
+    /// disconnect, whatever the users of the orders (see "Order::setSession()").
+    /// 
+    /// Remark: single bulk operation - O(k) plus one compaction pass per affected side index
+    /// </summary>
+    /// <param name="session">The session identifier.</param>
+    void cancelOrdersForSession(const std::string& session);
+
+    /// <summary>
+    /// Amends the order quantity in place (thread-safe), i.e. without cancel and re-add.
+    /// 
+    /// - reduce: the working quantity is reduced in place (keeps the order priority)
+    /// - increase: the order is re-queued according to "amendPolicy()" and matched again
+    ///   for the additional lots (matched quantity cache updated incrementally)
+    /// 
+    /// Remark: the quantity cannot be reduced below the already filled lots, and 0 cancels the order
+    /// Remark: ** this method is NOT required for the proposed problem itself, just a "aditional feature"... **
+    /// </summary>
+    /// <param name="orderId">The order identifier.</param>
+    /// <param name="qty">The new order quantity.</param>
+    void amendOrder(const std::string& orderId, unsigned int qty);
+
+    /// <summary>
+    /// Amends the order quantity in place (thread-safe), checking the pre-trade risk limits first 
+    /// (see "setRiskLimits()"): a quantity increase is rejected, leaving the order unchanged, if the 
+    /// additional lots would push the working lots of its user or company past a limit.
+    /// 
+    /// Remark: O(1) risk check (running aggregates), reduces are never rejected
+    /// </summary>
+    /// <param name="orderId">The order identifier.</param>
+    /// <param name="qty">The new order quantity.</param>
+    /// <returns>the reject reason, RiskReject::None if amended</returns>
+    RiskReject amendOrderChecked(const std::string& orderId, unsigned int qty);
+    
+    /// <summary>
+    /// Cancels the orders for sec identifier with minimum quantity of lots (thread-safe).
+    /// </summary>
+    /// <param name="securityId">The security identifier.</param>
+    /// <param name="minQty">The minimum size to cancel the order.</param>
+    void cancelOrdersForSecIdWithMinimumQty(const std::string& securityId, unsigned int minQty) override;
+    
+    /// <summary>
+    /// Gets the matching size for security.
+    /// Remark: O(1)
+    /// </summary>
+    /// <param name="securityId">The security identifier.</param>
+    /// <returns></returns>
+    unsigned int getMatchingSizeForSecurity(const std::string& securityId) override;
+    
+    /// <summary>
+    /// Gets all orders in current cache instance as a vector
+    /// </summary>
+    /// <returns>
+    /// vector of orders
+    /// </returns>
+    std::vector<Order> getAllOrders() const override;
+
+    //----------------------------------------------------------------
+        
+    /// <summary>
+    /// Checks the order existence by the specified order identifier.
+    /// 
+    /// Remark: ** this method is NOT required for the proposed problem itself, just a "aditional feature"... **
+    /// </summary>
+    /// <param name="orderId">The order identifier.</param>
+    /// <returns>
+    /// True case order is found, False otherwise
+    /// </returns>
+    const bool exists(const std::string& orderId) const;
+    
+    /// <summary>
+    /// Gets the number of orders in current cache instance.
+    /// 
+    /// Remark: ** this method is NOT required for the proposed problem itself, just a "aditional feature"... **
+    /// </summary>
+    /// <returns></returns>
+    const size_t size() const;
+
+   /// <summary>
+   /// Gets order by specified order id.
+   /// 
+   /// Remark: the reference is invalidated by the order cancel, i.e. only safe while a "pinOrders()" 
+   ///         guard is alive (deferred deletion mode) or without concurrent cancels
+   /// Remark: ** this method is NOT required for the proposed problem itself, just a "aditional feature"... **
+   /// </summary>
+   /// <param name="user">The order id.</param>
+   /// <returns>the order</returns>
+    Order& getOrder(const std::string& orderId) const;
+
+    /// <summary>
+    /// Gets the identifiers of the orders for sec identifier with minimum quantity of lots, 
+    /// i.e. the orders cancelled by "cancelOrdersForSecIdWithMinimumQty()" (ascending quantity).
+    /// 
+    /// Remark: O(n + k log k) - vectorized quantities scan, k: number of returned orders
+    /// Remark: ** this method is NOT required for the proposed problem itself, just a "aditional feature"... **
+    /// </summary>
+    /// <param name="securityId">The security identifier.</param>
+    /// <param name="minQty">The minimum quantity.</param>
+    /// <returns>the order identifiers</returns>
+    std::vector<std::string> getOrdersForSecIdWithMinimumQty(const std::string& securityId, unsigned int minQty) const;
+
+    /// <summary>
+    /// Gets the order by the specified order identifier.
+    /// 
+    /// ** Convenience accessor **
+    /// </summary>
+    /// <param name="orderId">The order identifier.</param>
+    /// <returns></returns>
+    const Order& operator[] (const std::string& orderId);
+    
+    /// <summary>
+    /// Gets all orders matches
+    /// 
+    /// Remark: ** this method is NOT required for the proposed problem itself, just a "aditional feature"... **
+    ///
+    /// Remark: requeires the definition of EXTENDED_INTERFACE macro in order to be evaluated, 
+    ///         otherwise it will return an empty vector (in oder not penalize standard code 
+    ///         performance avaliation).
+    /// </summary>
+    /// <param name="securityId">The security identifier.</param>
+    /// <returns></returns>
+    std::vector<OrderFill> getAllOrderMatches() const;
+
+    /// <summary>
+    /// Gets all orders matches by specified security identifier
+    /// 
+    /// Remark: ** this method is NOT required for the proposed problem itself, just a "aditional feature"... **
+    /// 
+    /// Remark: requeires the definition of EXTENDED_INTERFACE macro in order to be evaluated, 
+    ///         otherwise it will return an empty vector (in oder not penalize standard code 
+    ///         performance avaliation)
+    /// </summary>
+    /// <param name="securityId">The security identifier.</param>
+    /// <returns></returns>
+    std::vector<OrderFill> getOrderMatchesBySecurity(const std::string& securityId) const;
+
+    /// <summary>
+    /// Gets a page of the orders matches, by fill sequence number (see "OrderFill::sequence()").
+    /// Remark: O(k) - k: number of returned fills
+    /// </summary>
+    /// <param name="fromSequence">The first fill sequence number.</param>
+    /// <param name="limit">The maximum number of fills.</param>
+    /// <returns></returns>
+    std::vector<OrderFill> getOrderMatches(uint64_t fromSequence, size_t limit) const;
+
+    /// <summary>
+    /// Gets a page of the orders matches of the security, by fill sequence number.
+    /// Remark: O(log n + k) - n: fills on the security, k: number of returned fills
+    /// </summary>
+    /// <param name="securityId">The security identifier.</param>
+    /// <param name="fromSequence">The first fill sequence number.</param>
+    /// <param name="limit">The maximum number of fills.</param>
+    /// <returns></returns>
+    std::vector<OrderFill> getOrderMatchesBySecurity(const std::string& securityId, uint64_t fromSequence, size_t limit) const;
+
+    /// <summary>
+    /// Gets the sequence number of the next order fill, i.e. the number of fills.
+    /// </summary>
+    /// <returns></returns>
+    uint64_t orderMatchesSequence() const;
+
+    /// <summary>
+    /// Gets the memory footprint of the current cache instance, by internal data 
+    /// structure (exact allocated bytes) and by security (attributed bytes).
+    /// 
+    /// Remark: ** this method is NOT required for the proposed problem itself, just a "aditional feature"... **
+    /// Remark: O(n) - walks all orders and indexes (capacity planning, not for the critical path)
+    /// </summary>
+    /// <returns></returns>
+    MemoryReport memoryReport() const;
+
+    /// <summary>
+    /// Low jitter configuration: all orders and indexes storage is taken from a pre-sized arena, backed 
+    /// by explicit 2 MB huge pages (falling back to transparent huge pages advice), prefaulted and locked 
+    /// in memory (case "lockPages"), so the trading session does not page fault on the cache structures.
+    /// Starts a new session (see "startSession()").
+    /// 
+    /// Remark: only on empty caches (returns false otherwise, or throws case THROW_EXCEPTIONS is defined)
+    /// Remark: strings beyond the small string buffer (e.g. long identifiers) still use the heap
+    /// Remark: allocations beyond the arena use the heap (see "ArenaReport::fallbacks")
+    /// </summary>
+    /// <param name="bytes">The arena size (rounded up to huge pages).</param>
+    /// <param name="lockPages">true to lock the arena in memory (e.g. "mlock()", may require privileges).</param>
+    /// <returns>true case the arena was reserved.</returns>
+    bool reserveArena(size_t bytes, const bool& lockPages = true);
+
+    /// <summary>
+    /// Starts the trading session: page faults are reported from now on (see "arenaReport()").
+    /// </summary>
+    void startSession();
+
+    /// <summary>
+    /// Gets the memory arena report (pages, usage and process page faults taken during the session), 
+    /// including the order strings allocated on the heap anyway (longer than the SSO buffer).
+    /// 
+    /// Remark: O(n) - n: number of orders
+    /// </summary>
+    /// <returns></returns>
+    ArenaReport arenaReport() const;
+
+    /// <summary>
+    /// Encodes all orders in current cache instance at the end of the output buffer, either 
+    /// as a JSON array or as binary records (see "Order::writeBinary()"), without heap allocations
+    /// other than the buffer growth (reuse the buffer between exports).
+    /// 
+    /// Remark: ** this method is NOT required for the proposed problem itself, just a "aditional feature"... **
+    /// </summary>
+    /// <param name="out">The output buffer.</param>
+    /// <param name="format">The export format.</param>
+    /// <returns>the number of exported orders</returns>
+    size_t exportOrders(utils::output_buffer& out, ExportFormat format = ExportFormat::Json) const;
+        
+    /// <summary>
+    /// Returns true case current order cache is in the single thread mode (for debug/performance purposes), false otherwise.
+    /// </summary>
+    /// <returns></returns>
+    const bool multiThread() const { return _multiThread; }
+    
+    /// <summary>
+    /// Sets current order cache the single thread mode (for debug/performance purposes).
+    /// </summary>
+    /// <param name="value">The value.</param>
+    void setMultiThread(const bool& value) { _multiThread = value; }
+
+    /// <summary>
+    /// Returns true case current order cache is in the verbose mode (for debug purposes), false otherwise.
+    /// </summary>
+    /// <returns></returns>
+    const bool verbose() const { return _verbose; }
+
+    /// <summary>
+    /// Sets current order cache the verbose mode (for debug purposes).
+    /// </summary>
+    /// <param name="value">The value.</param>
+    void setVerbose(const bool& value) { _verbose = value; }
+
+    /// <summary>
+    /// Returns true case the counterparties scan uses the vectorized kernels (see "setVectorizedMatching()").
+    /// </summary>
+    /// <returns></returns>
+    const bool vectorizedMatching() const { return _vectorizedMatching; }
+
+    /// <summary>
+    /// Sets the vectorized counterparties scan (default): while matching at "addOrder()", the 
+    /// counterparties are scanned over the side books arrays (working lots and company) by 
+    /// SIMD kernels, in blocks of 8 (AVX2) or 16 (AVX-512) orders, otherwise by the "order_ptr" walk.
+    /// 
+    /// Remark: same fills on both approaches (comparison purposes)
+    /// Remark: the multithreaded (locked) matching always walks the orders
+    /// </summary>
+    /// <param name="value">The value.</param>
+    void setVectorizedMatching(const bool& value) { _vectorizedMatching = value; }
+
+    /// <summary>
+    /// Gets the global mutation sequence number, stamped on every order add, fill, amend and cancel.
+    /// </summary>
+    /// <returns></returns>
+    uint64_t changeSequence() const;
+
+    /// <summary>
+    /// Gets the capacity of the change log (0 if disabled, see "setChangeLog()").
+    /// </summary>
+    /// <returns></returns>
+    const size_t changeLog() const { return _changeLog.size(); }
+
+    /// <summary>
+    /// Sets the change log capacity (bounded ring of the last changes, 0 disables it): enables 
+    /// "getOrdersChangedSince()" from the current sequence on.
+    /// </summary>
+    /// <param name="capacity">The number of changes kept.</param>
+    void setChangeLog(const size_t& capacity = CHANGE_LOG_SIZE);
+
+    /// <summary>
+    /// Gets the orders changed (added, filled, amended) and cancelled since the specified mutation 
+    /// sequence number, i.e. incremental synchronization of downstream copies: O(changes), each order 
+    /// once (its current state). Case the change log does not cover the sequence anymore (bounded), 
+    /// returns the whole book flagged for resynchronization.
+    /// </summary>
+    /// <param name="sequence">The last sequence seen (0 for the whole book).</param>
+    /// <returns></returns>
+    OrderChanges getOrdersChangedSince(uint64_t sequence) const;
+
+    /// <summary>
+    /// Returns true case the matched volume series are maintained (see "setVolumeSeries()").
+    /// </summary>
+    /// <returns></returns>
+    const bool volumeSeries() const { return _volumeSeries; }
+
+    /// <summary>
+    /// Sets the matched volume series: the matched lots of each security are also accumulated in 
+    /// fixed time buckets (ring buffers of 1s and 1m buckets, see VOLUME_SECOND_BUCKETS and 
+    /// VOLUME_MINUTE_BUCKETS) at matching time, with one clock read per matched order.
+    /// </summary>
+    /// <param name="value">The value.</param>
+    void setVolumeSeries(const bool& value);
+
+    /// <summary>
+    /// Gets the matched lots of the security by time bucket on the range [from, to) (microseconds 
+    /// since epoch), one bucket per interval, without scanning the fills.
+    /// 
+    /// Remark: O(buckets) - only the last buckets are kept (older intervals are not returned)
+    /// </summary>
+    /// <param name="securityId">The security identifier.</param>
+    /// <param name="from">The range start (microseconds since epoch).</param>
+    /// <param name="to">The range end (microseconds since epoch, exclusive).</param>
+    /// <param name="resolution">The bucket interval.</param>
+    /// <returns></returns>
+    std::vector<VolumeBucket> getMatchedVolume(const std::string& securityId, uint64_t from, uint64_t to, 
+        VolumeResolution resolution = VolumeResolution::Second) const;
+
+    /// <summary>
+    /// Gets the vectorized counterparties scan kernel selected for the current CPU ("avx512", "avx2" or "scalar").
+    /// </summary>
+    /// <returns></returns>
+    static const char* matchingKernel();
+
+    /// <summary>
+    /// Selects the vectorized counterparties scan kernel ("avx512", "avx2" or "scalar") for all caches of
+    /// the process, e.g. for cross-checking the kernels (default: the widest supported by the current CPU).
+    /// Remark: select it before matching (the running scans keep the previous kernel)
+    /// </summary>
+    /// <param name="name">The kernel name.</param>
+    /// <returns>false case the kernel is unknown or not supported by the current CPU (selection unchanged)</returns>
+    static bool setMatchingKernel(const std::string& name);
+
+    /// <summary>
+    /// Returns true case the numeric order identifiers are indexed by a direct indexed table (see "setNumericOrderIds()").
+    /// </summary>
+    /// <returns></returns>
+    const bool numericOrderIds() const { return _numericOrderIds; }
+
+    /// <summary>
+    /// Sets the numeric order identifiers mode: canonical numeric identifiers (e.g. exchange 
+    /// assigned, mostly monotonic) are indexed by a paged direct indexed table, i.e. lookups, 
+    /// existence checks and cancels without hashing. Other identifiers use the hash index.
+    /// 
+    /// Remark: only on an empty cache
+    /// </summary>
+    /// <param name="value">The value.</param>
+    void setNumericOrderIds(const bool& value);
+
+    /// <summary>
+    /// Gets the queue priority policy of the orders quantity increases (see "amendOrder()").
+    /// </summary>
+    /// <returns></returns>
+    const AmendPolicy amendPolicy() const { return _amendPolicy; }
+
+    /// <summary>
+    /// Sets the queue priority policy of the orders quantity increases (see "amendOrder()").
+    /// </summary>
+    /// <param name="value">The value.</param>
+    void setAmendPolicy(const AmendPolicy& value) { _amendPolicy = value; }
+
+    /// <summary>
+    /// Returns true case the pre-trade risk checks are enabled (see "setRiskLimits()").
+    /// </summary>
+    /// <returns></returns>
+    const bool riskChecks() const { return _riskChecks; }
+
+    /// <summary>
+    /// Sets the pre-trade risk limits of each user and of each company (working lots) and enables 
+    /// the risk checks on "addOrder()" / "addOrderChecked()", i.e. the running aggregates.
+    /// 
+    /// Remark: enabling the risk checks only on an empty cache (limits can be changed afterwards)
+    /// Remark: orders are matched at once while risk checks are enabled (any matching mode), i.e. the 
+    ///         running aggregates never count lots of pending matches
+    /// </summary>
+    /// <param name="user">The limits of each user.</param>
+    /// <param name="company">The limits of each company.</param>
+    void setRiskLimits(const RiskLimits& user, const RiskLimits& company);
+
+    /// <summary>
+    /// Gets the running aggregates of the user working lots (risk checks enabled).
+    /// </summary>
+    /// <returns></returns>
+    RiskExposure userExposure(const std::string& user) const;
+
+    /// <summary>
+    /// Gets the running aggregates of the company working lots (risk checks enabled).
+    /// </summary>
+    /// <returns></returns>
+    RiskExposure companyExposure(const std::string& company) const;
+
+    /// <summary>
+    /// Gets the order matching mode (see "setMatchingMode()").
+    /// </summary>
+    /// <returns></returns>
+    const MatchingMode matchingMode() const { return _matchingMode; }
+
+    /// <summary>
+    /// Sets the order matching mode. On "MatchingMode::Lazy", "addOrder()" only appends the order 
+    /// and marks its security dirty: the first "getMatchingSizeForSecurity()" on a dirty security 
+    /// matches the orders added since the last query (in arrival order, each one against the 
+    /// counterparties that arrived before it) and caches the result, i.e. the same fills of the 
+    /// matching at "addOrder()", amortized across bursts (rarely queried securities cost nothing).
+    /// 
+    /// Remark: cancels and amends settle the pending orders of the security first
+    /// Remark: reads settle the pending orders they report first (e.g. "getOrder()", "getAllOrders()", 
+    ///         "getOrdersChangedSince()", "exportOrders()", fills and matched volume)
+    /// Remark: leaving the lazy mode settles all pending orders
+    /// Remark: orders are matched at once while risk checks are enabled (see "setRiskLimits()")
+    /// 
+    /// On "MatchingMode::Adaptive", each security tracks its adds per query (smoothed) and switches, 
+    /// with hysteresis, to lazy matching above ADAPTIVE_LAZY_RATIO (or as soon as the current run of 
+    /// adds exceeds it) and back to eager matching below ADAPTIVE_EAGER_RATIO (see "matchingStats()").
+    /// </summary>
+    /// <param name="value">The value.</param>
+    void setMatchingMode(const MatchingMode& value);
+
+    /// <summary>
+    /// Gets the matching strategies report: per security strategy, adds per query, costs of each 
+    /// strategy and the last switch decisions (collected on lazy and adaptive matching modes).
+    /// </summary>
+    /// <returns></returns>
+    MatchingStats matchingStats() const;
+
+    /// <summary>
+    /// Gets the number of orders waiting for matching (lazy matching mode).
+    /// </summary>
+    /// <returns></returns>
+    size_t pendingMatches() const;
+
+    /// <summary>
+    /// Matches all orders waiting for matching (lazy matching mode), e.g. before exporting the orders.
+    /// </summary>
+    void settleMatching();
+
+    /// <summary>
+    /// Removes the orders expired at the specified time, i.e. the orders with expiry up to "now" 
+    /// (see "Order::setExpiry()", never before their expiry, up to EXPIRY_TICK_US later), in a 
+    /// single bulk cancel. The expiries are scheduled on a 
+    /// hierarchical timing wheel (EXPIRY_WHEEL_LEVELS levels of 2^EXPIRY_WHEEL_BITS slots, 
+    /// EXPIRY_TICK_US resolution): O(1) to schedule and unschedule an order and O(1) amortized 
+    /// per expired order, skipping the empty slots.
+    /// 
+    /// Remark: the time only moves forward (earlier times expire nothing)
+    /// Remark: the orders added with a past expiry are removed on the next call
+    /// </summary>
+    /// <param name="now">The current time (microseconds since epoch).</param>
+    /// <returns>the number of expired orders</returns>
+    size_t expireOrders(const uint64_t& now);
+
+    /// <summary>
+    /// Removes the orders expired at the current system time (see "expireOrders(now)").
+    /// </summary>
+    /// <returns>the number of expired orders</returns>
+    size_t expireOrders();
+
+    /// <summary>
+    /// Removes the orders valid for the session only (Order::GOOD_FOR_DAY) in a single bulk cancel.
+    /// </summary>
+    /// <returns>the number of expired orders</returns>
+    size_t endSession();
+
+    /// <summary>
+    /// Gets the number of orders scheduled for expiry (including the session orders).
+    /// </summary>
+    /// <returns></returns>
+    size_t expiringOrders() const;
+
+    /// <summary>
+    /// Returns true case a read replica is fed by the current order cache (see OrderCacheReplica).
+    /// </summary>
+    /// <returns></returns>
+    const bool hasReplica() const { return _replica != nullptr; }
+
+    /// <summary>
+    /// Returns true case the cancelled orders are only tombstoned (see "setDeferredDeletion()").
+    /// </summary>
+    /// <returns></returns>
+    const bool deferredDeletion() const { return _deferredDeletion; }
+
+    /// <summary>
+    /// Sets the deferred deletion mode: cancels only tombstone the orders (O(1): order identifier 
+    /// index, working lots, expiry, exposure and change log), while the user, company, session and 
+    /// security indexes removals, the side indexes compaction and the memory reclamation run in 
+    /// bounded background passes (RECLAIM_BATCH_SIZE orders every RECLAIM_INTERVAL_US, back to back 
+    /// while behind), under epoch based reclamation.
+    /// 
+    /// Remark: references to orders (e.g. "getOrder()") stay valid while a "pinOrders()" guard is alive
+    /// Remark: mass cancels skip the tombstones still on the user, company, session and security indexes
+    /// Remark: disabling reclaims all pending orders
+    /// </summary>
+    /// <param name="value">The value.</param>
+    void setDeferredDeletion(const bool& value);
+
+    /// <summary>
+    /// Pins the current epoch: cancelled orders are not reclaimed while the guard is alive, 
+    /// i.e. the order references taken after pinning stay valid (deferred deletion mode).
+    /// </summary>
+    /// <returns>the guard</returns>
+    utils::epoch_guard pinOrders() { return utils::epoch_guard(_epochs); }
+
+    /// <summary>
+    /// Unlinks and releases the oldest cancelled orders not reachable by pinned readers, up to 
+    /// RECLAIM_BATCH_SIZE orders (deferred deletion mode).
+    /// 
+    /// Remark: called by the background reclamation thread, one compaction pass per affected side index
+    /// </summary>
+    /// <returns>the number of reclaimed orders</returns>
+    size_t reclaimOrders();
+
+    /// <summary>
+    /// Gets the number of cancelled orders waiting for reclamation (deferred deletion mode).
+    /// </summary>
+    /// <returns></returns>
+    size_t pendingReclaims() const;
+
+
+private:        
+    friend class OrderCacheReplica;
+
+    template <typename T>
+    using tracked = typename utils::tracking_allocator<T>;
+    template <typename Key, typename T>
+    using tracked_map = typename std::unordered_map<Key, T, std::hash<Key>, std::equal_to<Key>,
+        std::scoped_allocator_adaptor<tracked<std::pair<const Key, T>>>>;
+
+    /// <summary>
+    /// Order fill handle: security (interned) and position on its fills
+    /// </summary>
+    struct fill_handle {
+        uint32_t security;
+        uint32_t position;
+    };
+
+    typedef typename std::deque<OrderFill, tracked<OrderFill>> order_fill_chunks;
+    typedef typename std::deque<fill_handle, tracked<fill_handle>> order_match_storage;
+    typedef typename order_match_storage::iterator order_match_ptr;
+    typedef tracked_map<std::string, order_list> order_index_map;
+    typedef tracked_map<std::string, side_book> order_match_index;
+    typedef tracked_map<std::string, quantity_list> order_qty_array_map;
+
+	typedef typename std::shared_lock<std::shared_timed_mutex> read_lock;
+	typedef typename std::unique_lock<std::shared_timed_mutex> write_lock;
+    
+	//----------------------------------------------------------------
+
+	// internal states (used for testing purposes only)
+    // (compares single thread vc multithread processing times, debug verbosity, etc)
+    bool _multiThread = true;
+    bool _verbose = true;
+    AmendPolicy _amendPolicy = AmendPolicy::LosePriority;
+    std::atomic<MatchingMode> _matchingMode{ MatchingMode::Default };  // read before the locks (queries)
+    bool _riskChecks = false;
+    RiskLimits _userLimits;
+    RiskLimits _companyLimits;
+    bool _vectorizedMatching = true;
+    bool _volumeSeries = false;
+    bool _numericOrderIds = false;
+
+    /// <summary>
+	/// The orders access mutex (thread-saveting)
+    /// </summary>
+    mutable std::shared_timed_mutex _ordersMutex;
+    mutable std::shared_mutex _longOrdersMutex;
+    mutable std::shared_mutex _shortOrdersMutex;
+    
+    /// <summary>
+    /// Returns a scoped lock that can be shared by multiple
+    /// readers at the same time while excluding any writers
+    /// </summary>
+    /// <returns></returns>
+    read_lock lockForReadOrders() const {
+		return read_lock(_ordersMutex);
+    }
+    
+    /// <summary>
+    /// This returns a scoped lock that is exclusing to one
+    /// writer preventing any readers
+    /// </summary>
+    /// <returns></returns>
+    write_lock lockForUpdateOrders() {
+        return write_lock(_ordersMutex);
+    }
+        
+    //----------------------------------------------------------------
+
+    /// <summary>
+    /// Pre-sized storage for all data structures (see "reserveArena()"), nullptr uses the heap
+    /// 
+    /// Remark: must be declared before the data structures (destroyed after them)
+    /// </summary>
+    std::unique_ptr<utils::memory_arena> _arena;
+    utils::page_faults _sessionFaults;
+    
+    /// <summary>
+    /// Heap usage counters by internal data structure (see "memoryReport()")
+    /// 
+    /// Remark: must be declared before the data structures (initialization order)
+    /// </summary>
+    utils::memory_counter _ordersMemory;
+    utils::memory_counter _orderIndexMemory;
+    utils::memory_counter _numericOrderIndexMemory;
+    utils::memory_counter _userOrdersIndexMemory;
+    utils::memory_counter _companyOrdersIndexMemory;
+    utils::memory_counter _sessionOrdersIndexMemory;
+    utils::memory_counter _expiryWheelMemory;
+    utils::memory_counter _securityOrdersIndexMemory;
+    utils::memory_counter _securityQuantitiesMemory;
+    utils::memory_counter _longOrdersIndexMemory;
+    utils::memory_counter _shortOrdersIndexMemory;
+    utils::memory_counter _matchedQuantityMemory;
+    utils::memory_counter _orderMatchesMemory;
+    utils::memory_counter _riskExposuresMemory;
+    utils::memory_counter _changeLogMemory;
+    utils::memory_counter _matchedVolumeMemory;
+    utils::memory_counter _pendingMatchesMemory;
+    utils::memory_counter _matchingStatsMemory;
+    utils::memory_counter _tombstonesMemory;
+    utils::memory_counter _companyKeysMemory;
+
+    /// <summary>
+    /// The orders list 
+    /// 
+    /// Remark: storing orders as a list allows to remove itens at 0(1)
+    /// </summary>
+    order_storage _orders;
+                
+    /// <summary>
+	/// The orders index - O(1) access to orders by index
+    /// 
+    /// Remark: implements a relation 1:1 from "orderId" => order pointer (on list)
+    /// </summary>
+    tracked_map<std::string, order_ptr> _orderIndex;
+
+    /// <summary>
+	/// The numeric orders index - O(1) access to orders by numeric index, without hashing
+    /// 
+    /// Remark: implements a relation 1:1 from numeric "orderId" => order pointer (see "setNumericOrderIds()")
+    /// </summary>
+    utils::paged_table<order_ptr> _numericOrderIndex;
+        
+    /// <summary>
+    /// The user orders index - O(1) access to orders by user
+    /// 
+    /// Remark: implements a relation 1:n from "user" => order pointer (contiguous, no identifiers copy)
+    /// Remark: each order stores its position, i.e. O(1) removal (swap with the last one)
+    /// </summary>
+    order_index_map _userOrdersIndex;
+
+    /// <summary>
+    /// The company orders index - O(1) access to orders by company
+    /// 
+    /// Remark: implements a relation 1:n from "company" => order pointer (as the user orders index)
+    /// </summary>
+    order_index_map _companyOrdersIndex;
+
+    /// <summary>
+    /// The session orders index - O(1) access to orders by client session (orders with a session only)
+    /// 
+    /// Remark: implements a relation 1:n from "session" => order pointer (as the user orders index)
+    /// </summary>
+    order_index_map _sessionOrdersIndex;
+    
+    /// <summary>
+    /// The security orders index - O(1) access to orders by security
+    /// 
+    /// Remark: implements a relation 1:n from "securityId" => order pointer (as the user orders index)
+    /// </summary>
+    order_index_map _securityOrdersIndex;
+
+    /// <summary>
+    /// The security orders quantities, at the same positions of the security orders index (structure 
+    /// of arrays) - vectorized scan of orders with minimum quantity (see "cancelOrdersForSecIdWithMinimumQty()")
+    /// 
+    /// Remark: O(1) append on add (no ordered index: a tree insert per add costs more than the scans 
+    ///         it saves, the scan writes only the qualifying positions)
+    /// </summary>
+    order_qty_array_map _securityQuantities;
+
+
+    //----------------------------------------------------------------
+        
+    // thread-safe reading matched quantity
+    mutable std::shared_timed_mutex _matchedQuantityMutex;
+
+    /// <summary>
+    /// The interned companies (side books company arrays)
+    /// 
+    /// Remark: tracked by "_companyKeysMemory"
+    /// </summary>
+    tracked_map<std::string, uint32_t> _companyKeys;
+
+    /// <summary>
+    /// The running aggregates of the working lots by user and by company (risk checks)
+    /// 
+    /// Remark: the orders point to their aggregates (node based maps, i.e. stable addresses), 
+    /// the maps and their securities lots are tracked by "_riskExposuresMemory"
+    /// </summary>
+    tracked_map<std::string, RiskExposure> _userExposures;
+    tracked_map<std::string, RiskExposure> _companyExposures;
+    mutable std::mutex _riskMutex;  // concurrent matching (fills)
+
+    /// <summary>
+    /// The orders waiting for matching by security, i.e. the dirty securities (lazy matching mode): 
+    /// order and matching horizon (last arrival sequence visible to the order)
+    /// 
+    /// Remark: the map and its lists are tracked by "_pendingMatchesMemory"
+    /// </summary>
+    typedef std::vector<std::pair<order_ptr, uint64_t>, tracked<std::pair<order_ptr, uint64_t>>> pending_list;
+    tracked_map<std::string, pending_list> _pendingMatches;
+    size_t _pendingCount = 0;
+    uint64_t _arrivals = 0;
+
+    /// <summary>
+    /// The matching strategies by security and the last switch decisions (lazy and adaptive matching modes)
+    /// 
+    /// Remark: the query counters are atomics, i.e. updated by the concurrent queries under the read lock, 
+    /// the map is tracked by "_matchingStatsMemory"
+    /// </summary>
+    struct security_matching {
+        SecurityMatchingStats stats;             // adds, matches and switches (orders write lock)
+        std::atomic<size_t> queries{ 0 };
+        std::atomic<size_t> addsSinceQuery{ 0 };
+        std::atomic<double> addsPerQuery{ 0 };
+    };
+    tracked_map<std::string, security_matching> _matchingStats;
+    std::deque<MatchingSwitch> _matchingSwitches;
+
+    /// <summary>
+    /// The hierarchical timing wheel of the orders expiries: EXPIRY_WHEEL_LEVELS levels of 
+    /// 2^EXPIRY_WHEEL_BITS buckets, plus the overflow bucket (expiries beyond the wheel range) and 
+    /// the session bucket (Order::GOOD_FOR_DAY), the current tick and the orders by level
+    /// </summary>
+    std::vector<order_list, std::scoped_allocator_adaptor<tracked<order_list>>> _expiryWheel;
+    uint64_t _expiryTick = 0;
+    size_t _expiryCounts[EXPIRY_WHEEL_LEVELS + 1] = {};
+
+    /// <summary>
+    /// The matched volume series by security: rings of time buckets (bucket number and matched lots)
+    /// 
+    /// Remark: written under the matched quantity lock, the map and its rings are tracked by "_matchedVolumeMemory"
+    /// </summary>
+    struct volume_bucket {
+        uint64_t index = UINT64_MAX;
+        uint64_t volume = 0;
+    };
+    struct volume_series {
+        typedef std::vector<volume_bucket, tracked<volume_bucket>> volume_ring;
+        volume_ring seconds;
+        volume_ring minutes;
+    };
+    tracked_map<std::string, volume_series> _matchedVolume;
+
+    /// <summary>
+    /// The change data capture: mutation sequence and the bounded change log (ring of the last 
+    /// changes), logging from "_changeLogStart" on
+    /// 
+    /// Remark: adds, fills and amends log the order handle (no id copy), linked to the previous change 
+    ///         of the same order; the removal is the last change of an order and logs its id (reusing 
+    ///         the ring slot capacity), so a handle is read only while its order is alive
+    /// </summary>
+    struct change_entry {
+        uint64_t sequence = 0;
+        uint64_t previous = 0;         // previous change of the same order (0: none)
+        const Order* order = nullptr;  // changed order, nullptr on removal
+        std::string removedId;         // removed order id
+    };
+    uint64_t _changeSequence = 0;
+    uint64_t _changeLogStart = 0;
+    std::vector<change_entry, tracked<change_entry>> _changeLog;
+    mutable std::mutex _changeLogMutex;  // concurrent matching (fills)
+
+    /// <summary>
+    /// The security long orders index (buy side) - optimization
+    /// </summary>
+    order_match_index _securityLongOrdersIndex;
+
+    /// <summary>
+    /// The security short orders index (sell side) - optimization
+    /// </summary>
+    order_match_index _securityShortOrdersIndex;
+            
+    /// <summary>
+	/// The matched quantity cache by securityId (main cache)
+    /// 
+    /// Remark: use "getMatchedQuantityInCache()" for thread-safe 
+    /// </summary>
+    tracked_map<std::string, unsigned int> _matchedQuantity;
+    
+    /// <summary>
+    /// The orders matches: fills by security (contiguous chunks, in sequence order) and the 
+    /// fill handles in sequence order (global enumeration, i.e. sequence number => handle)
+    /// Remark: required for extended interface: "getOrderMatches()", "getOrderMatchesBySecurity()", etc
+    /// Remark: requeires the definition of EXTENDED_INTERFACE macro in order to be evaluated, 
+    ///         otherwise it will return an empty vector (in oder not penalize standard code 
+    ///         performance avaliation)
+    /// Remark: all tracked by "_orderMatchesMemory"
+    /// </summary>
+    std::vector<order_fill_chunks, tracked<order_fill_chunks>> _securityFills;
+    tracked_map<std::string, uint32_t> _fillSecurityKeys;
+    order_match_storage _orderMatches;
+    mutable std::mutex _fillsMutex;  // concurrent matching (fills)
+
+    /// <summary>
+    /// Gets the fills key of the security (interned on the first fill) [private]
+    /// </summary>
+    uint32_t fillKey(const std::string& securityId, bool concurrent = false);
+
+    /// <summary>
+    /// Stores the order fill on its security fills (locks the fills storage on the concurrent matching walk only) [private]
+    /// </summary>
+    void storeFill(uint32_t security, OrderFill&& fill, bool concurrent = false);
+
+
+    /// <summary>
+    /// Gets the current cached matched quantity by security (thread-safe).
+    /// </summary>
+    /// <param name="securityId">The security identifier.</param>
+    /// <returns></returns>
+    unsigned int getMatchedQuantityInCache(const std::string& securityId) const;
+
+   
+    //----------------------------------------------------------------
+    
+    /// <summary>
+    /// Cancels the orders (uses multithreading if required, i.e. number of orders > DELETE_CHUNK_SIZE) [private]
+    /// 
+    /// Remark: mass cancels mark the victims and compact each affected side index once (see "compactOrders()")
+    /// </summary>
+    /// <param name="orders">The orders.</param>
+    /// <param name="minQty">Only cancel the specified order if the order quantity if greather than minQty value.</param>
+    void cancelOrders(order_list& orders, unsigned int minQty = 0);
+
+    /// <summary>
+    /// Removes the marked orders from all indexes and from the orders list, with a single 
+    /// (stable) compaction pass per affected side index, i.e. O(n + k) instead of O(n.k) [private]
+    /// </summary>
+    /// <param name="victims">The orders to remove.</param>
+    void compactOrders(const std::vector<order_ptr>& victims);
+
+    /// <summary>
+    /// Removes the order from the identifier indexes (order, user, company and security) [private]
+    /// </summary>
+    void unindexOrder(order_ptr& ptr);
+
+    /// <summary>
+    /// Removes the order from the user, company, session and security indexes - O(1) [private]
+    /// </summary>
+    void removeMembers(order_ptr& ptr);
+
+    /// <summary>
+    /// Removes the order from the order identifier index and the expiry wheel, releases its 
+    /// exposure and logs the change - O(1) [private]
+    /// </summary>
+    void detachOrder(order_ptr& ptr);
+
+    /// <summary>
+    /// Removes the order from the security orders index and quantities - O(1) [private]
+    /// </summary>
+    void removeSecurityMember(order_ptr& ptr);
+
+    /// <summary>
+    /// Removes the orders from the side indexes and releases them [private]
+    /// </summary>
+    void unlinkOrders(const std::vector<order_ptr>& victims);
+
+    /// <summary>
+    /// Tombstones the order and removes it from the order identifier index (deferred deletion) [private]
+    /// </summary>
+    void retireOrder(order_ptr& ptr);
+
+    /// <summary>
+    /// Gets the security side book of the order [private]
+    /// </summary>
+    side_book& sideBook(order_ptr& ptr);
+
+    /// <summary>
+    /// Appends the order to the side book (O(1)), removes it (O(n), stable) or refreshes 
+    /// its working lots (O(1)), keeping the side book arrays at the same positions [private]
+    /// </summary>
+    static void pushSide(side_book& book, order_ptr& ptr);
+    static void eraseSide(side_book& book, order_ptr& ptr);
+    static void updateSide(side_book& book, order_ptr& ptr);
+
+    /// <summary>
+    /// Gets the order pointer by identifier (numeric or hash index), nullptr if not found [private]
+    /// </summary>
+    const order_ptr* findOrder(const std::string& orderId) const;
+
+    //----------------------------------------------------------------
+
+    /// <summary>
+    /// Deferred deletion mode (see "setDeferredDeletion()")
+    /// </summary>
+    std::atomic<bool> _deferredDeletion{ false };
+
+    /// <summary>
+    /// Tombstoned orders (and their retirement epoch) waiting for reclamation, in retirement order
+    /// 
+    /// Remark: written under the orders write lock, tracked by "_tombstonesMemory"
+    /// </summary>
+    std::deque<std::pair<order_ptr, uint64_t>, tracked<std::pair<order_ptr, uint64_t>>> _tombstones;
+
+    /// <summary>
+    /// Epochs of the readers holding order references (see "pinOrders()")
+    /// </summary>
+    utils::epoch_manager _epochs;
+
+    /// <summary>
+    /// Background reclamation thread (deferred deletion mode)
+    /// </summary>
+    std::thread _reclaimer;
+
+
+    // <summary>
+	/// Cancels the orders on the specified range (helper snippet) [private]
+    /// </summary>
+    /// <param name="orders">The orders.</param>
+    /// <param name="start">start iterator.</param>
+    /// <param name="start">end iterator.</param>
+    /// <param name="minQty">Only cancel the specified order if the order quantity if greather than minQty value.</param>
+    void cancelOrdersRange(order_list& orders, order_list::iterator start, order_list::iterator end, unsigned int minQty = 0);
 
-/// <summary>
-/// Order Cache interface
-/// </summary>
-class OrderCacheInterface
-{
 
- public:
-   
-     /// <summary>
-     /// Adds the order.
-     /// </summary>
-     /// <param name="order">The order.</param>
-     virtual void addOrder(Order order) = 0;
-   
-     /// <summary>
-     /// Removes the order with this unique order id
-     /// </summary>
-     /// <param name="orderId">The order identifier.</param>
-     virtual void cancelOrder(const std::string& orderId) = 0;
-   
-     /// <summary>
-     /// Removes all orders for this user
-     /// </summary>
-     /// <param name="user">The user.</param>
-     virtual void cancelOrdersForUser(const std::string& user) = 0;
-       
-     /// <summary>
-     /// Removes all orders in the cache for this security with qty >= minQty
-     /// </summary>
-     /// <param name="securityId">The security identifier.</param>
-     /// <param name="minQty">The minimum qty.</param>
-     virtual void cancelOrdersForSecIdWithMinimumQty(const std::string& securityId, unsigned int minQty) = 0;
-      
-     /// <summary>
-     /// Returns the total qty that can match for the security id
-     /// </summary>
-     /// <param name="securityId">The security identifier.</param>
-     /// <returns></returns>
-     virtual unsigned int getMatchingSizeForSecurity(const std::string& securityId) = 0;
-   
-     /// <summary>
-     /// Returns all orders in cache in a vector
-     /// </summary>
-     /// <returns></returns>
-     virtual std::vector<Order> getAllOrders() const = 0;
+    /// <summary>
+    /// Cancels the order (without locks - thread unsafe) [private]
+    /// </summary>
+    /// <param name="orderId">The order identifier.</param>
+    /// <param name="minQty">Only cancel the specified order if the order quantity if greather than minQty value.</param>
+    void cancelSingleOrder(const std::string& orderId, unsigned int minQty = 0, bool lockOrder = false);
 
-};
 
+    //----------------------------------------------------------------
 
+    /// <summary>
+    /// Finds matches for the specified order and store it in cache (without locks - thread unsafe) [private]
+    /// Remark: solution for getMatchingSizeForSecurity() with O(1)
+    /// </summary>
+    /// <param name="orderId">The order identifier.</param>
+    /// <param name="horizon">The last counterparty arrival sequence visible to the order (lazy matching).</param>
+    unsigned int matchOrderInCache(order_ptr& ptr, bool lockOrder = true, uint64_t horizon = UINT64_MAX);
 
-/// <summary>
-/// Provides an implementation for the OrderCache class (Order iterator/pointer). 
-/// </summary>
-typedef typename std::list<Order>::iterator order_ptr;
+    /// <summary>
+    /// Marks the order security dirty (lazy matching mode, without locks - thread unsafe) [private]
+    /// </summary>
+    void deferMatching(order_ptr& ptr);
 
-/// <summary>
-/// Provides an implementation for the OrderCache class (vector of Order iterator/pointer). 
-/// </summary>
-typedef typename std::vector<order_ptr> order_list;
+    /// <summary>
+    /// Matches the added (or increased) order, at once or deferred by the matching mode / security 
+    /// strategy (without locks - thread unsafe) [private]
+    /// </summary>
+    void matchAdded(order_ptr& ptr);
 
+    /// <summary>
+    /// Accounts a query on the security (atomics - concurrent queries), returns true case its strategy must switch (adaptive matching) [private]
+    /// </summary>
+    bool queried(security_matching& matching);
 
-/// <summary>
-/// Order fill information
-/// 
-/// ** this structure is NOT required for the proposed problem itself, just a "extended feature" **
-/// 
-/// Remark: only used at the OrderCache::GetMatches()/GetMatchesBySecurity() methods
-/// Remark: requeires the definition of EXTENDED_INTERFACE macro in order to be evaluated
-/// </summary>
-class OrderFill {
+    /// <summary>
+    /// Switches the security strategy case still required by its adds per query (adaptive matching, without locks - thread unsafe) [private]
+    /// </summary>
+    void adaptStrategy(const std::string& securityId, security_matching& matching);
 
- public:
-    OrderFill(
-        const std::string& buyOrderId,
-        const std::string& sellOrderId,
-        const unsigned int qty): 
-        m_buyOrderId(buyOrderId),
-        m_sellOrderId(sellOrderId),
-        m_qty(qty) {  }
+    /// <summary>
+    /// Switches the security strategy (adaptive matching) [private]
+    /// </summary>
+    void switchStrategy(const std::string& securityId, security_matching& matching, bool eager);
 
     /// <summary>
-    /// The buy order identifier
+    /// Matches the orders waiting for matching on the security / on all securities (without locks - thread unsafe) [private]
     /// </summary>
-    const std::string buyOrderId() const { return m_buyOrderId; }
-        
+    void settle(const std::string& securityId);
+    void settleAll();
+
     /// <summary>
-    /// The sell order identifier
+    /// Matches the orders waiting for matching on the securities of the orders only (without locks - thread unsafe) [private]
     /// </summary>
-    const std::string sellOrderId() const { return m_sellOrderId; }
+    void settleOrders(const order_list& orders);
 
     /// <summary>
-    /// The filled quantity of lots
+    /// Matches the orders waiting for matching on the security (nullptr: on all securities) before a read, 
+    /// taking the write lock only when dirty (thread-safe, before the read lock) [private]
     /// </summary>
-    const unsigned int qty() const { return m_qty; }
+    void settleForRead(const std::string* securityId = nullptr) const;
+
+
+    //----------------------------------------------------------------
 
     /// <summary>
-    /// Returns order fill as string.
+    /// Stamps the order change with the next mutation sequence and logs it (locks the change log on the concurrent matching walk only) [private]
     /// </summary>
-    /// <returns></returns>
-    std::string str() const {
-        utils::osyncstream os;
-        os << "order fill {buy: " << buyOrderId() << ", sell: " << sellOrderId() << ", qty: " << qty() << "}";
-        return os.str();
-    }
+    void recordChange(Order& order, bool concurrent = false);
 
-    // ** convenience operator (cast to string) **
-    operator std::string() const { return str(); }
+    /// <summary>
+    /// Stamps the order removal with the next mutation sequence and logs its id, if enabled [private]
+    /// </summary>
+    void recordRemoval(Order& order);
 
     /// <summary>
-    /// Formatted data operator (printing)
+    /// Checks the additional order lots against the user and company risk limits (without locks - thread unsafe) [private]
     /// </summary>
-    /// <param name="os">The os.</param>
-    /// <param name="order">The order.</param>
-    /// <returns></returns>
-    friend utils::osyncstream& operator<<(utils::osyncstream& os, const OrderFill& fill) {
-        os << fill.str();
-        return os;
-    }
-    
- private:
-    std::string m_buyOrderId;
-    std::string m_sellOrderId;    
-    unsigned int m_qty = 0;
-};
+    RiskReject checkRisk(const Order& order, uint64_t qty) const;
 
+    /// <summary>
+    /// Adds the working lots delta of the order to its user and company aggregates (risk checks) [private]
+    /// </summary>
+    void addExposure(Order& order, int64_t qty);
 
+    //----------------------------------------------------------------
 
+    /// <summary>
+    /// Schedules the order expiry on the timing wheel, if any (without locks - thread unsafe) [private]
+    /// </summary>
+    void scheduleExpiry(order_ptr& ptr);
 
-/// <summary>
-/// Order Cache
-/// </summary>
-/// <seealso cref="OrderCacheInterface" />
-class OrderCache : public OrderCacheInterface
-{
+    /// <summary>
+    /// Places the order on the timing wheel bucket of the expiry tick (not before the current tick) [private]
+    /// </summary>
+    void placeExpiry(order_ptr& ptr, uint64_t tick);
 
-  public:    
     /// <summary>
-    /// Adds the order into current order cache.
-    /// Remark: O(1)
+    /// Removes the order from its timing wheel bucket, if any (without locks - thread unsafe) [private]
     /// </summary>
-    /// <param name="order">The order.</param>
-    void addOrder(Order order) override;
-    
+    void unscheduleExpiry(order_ptr& ptr);
+
     /// <summary>
-    /// Cancels the order by specified Id (thread-safe).
-    /// Remark: O(1)
+    /// Advances the timing wheel up to the specified tick, collecting the expired orders [private]
     /// </summary>
-    /// <param name="orderId">The order identifier.</param>
-    void cancelOrder(const std::string& orderId) override;
-    
+    void advanceExpiry(uint64_t tick, order_list& expired);
+
     /// <summary>
-    /// Cancels the orders for the specified user  (thread-safe).
+    /// Removes the expired orders in bulk (without locks - thread unsafe) [private]
     /// </summary>
-    /// <param name="user">The user.</param>
-    void cancelOrdersForUser(const std::string& user) override;
-    
+    void removeExpired(order_list& expired);
+
+
+    //----------------------------------------------------------------
+
     /// <summary>
-    /// Cancels the orders for sec identifier with minimum quantity of lots (thread-safe).
+    /// The read replica fed by the mutations of current cache (optional)
+    /// 
+    /// Remark: written under the orders write lock
     /// </summary>
-    /// <param name="securityId">The security identifier.</param>
-    /// <param name="minQty">The minimum size to cancel the order.</param>
-    void cancelOrdersForSecIdWithMinimumQty(const std::string& securityId, unsigned int minQty) override;
-    
+    OrderCacheReplica* _replica = nullptr;
+
     /// <summary>
-    /// Gets the matching size for security.
-    /// Remark: O(1)
+    /// Sends the mutation to the read replica, if any (under the orders write lock) [private]
     /// </summary>
-    /// <param name="securityId">The security identifier.</param>
-    /// <returns></returns>
-    unsigned int getMatchingSizeForSecurity(const std::string& securityId) override;
-    
+    /// <param name="mutation">The mutation.</param>
+    void publish(OrderMutation&& mutation);
+
     /// <summary>
-    /// Gets all orders in current cache instance as a vector
+    /// Stores the order and its indexes, without matching (without locks - thread unsafe) [private]
     /// </summary>
-    /// <returns>
-    /// vector of orders
-    /// </returns>
-    std::vector<Order> getAllOrders() const override;
+    /// <param name="order">The order.</param>
+    /// <returns>the stored order pointer</returns>
+    order_ptr insertOrder(Order&& order);
+
+    /// <summary>
+    /// Copies the orders and the matched quantities into an empty order cache (without locks - thread unsafe) [private]
+    /// </summary>
+    /// <param name="target">The target cache.</param>
+    void copyTo(OrderCache& target) const;
 
     //----------------------------------------------------------------
-        
+
+    std::mutex _ThreadPoolMutex;
+    std::vector<std::thread> _ThreadPool;    
     /// <summary>
-    /// Checks the order existence by the specified order identifier.
-    /// 
-    /// Remark: ** this method is NOT required for the proposed problem itself, just a "aditional feature"... **
+    /// Finds matches for the specified order and store it in cache, handling thread pool
     /// </summary>
-    /// <param name="orderId">The order identifier.</param>
+    /// <param name="ptr">The PTR.</param>
+    void matchOrderInPool(order_ptr& ptr);
+
+    //----------------------------------------------------------------
+
+    /// <summary>
+    /// Determines whether specified order is a buy order (long).
+    /// </summary>
+    /// <param name="ptr">The order pointer.</param>
     /// <returns>
-    /// True case order is found, False otherwise
+    ///   <c>true</c> if order is buy side; <c>false</c> if order is sell side.
     /// </returns>
-    const bool exists(const std::string& orderId) const;
+    static const bool isBuySide(order_ptr& ptr) {
+		return ptr->side() != "Sell";
+    }
     
     /// <summary>
-    /// Gets the number of orders in current cache instance.
-    /// 
-    /// Remark: ** this method is NOT required for the proposed problem itself, just a "aditional feature"... **
+    /// Comparator predicate intended to sorting orders by workings lots (descending).
     /// </summary>
+    /// <param name="left">The left order.</param>
+    /// <param name="right">The right order.</param>
     /// <returns></returns>
-    const size_t size() const;
+    static const bool workingLotsComparator(const order_ptr& left, const order_ptr& right) {        
+        return left->workingQty() > right->workingQty();
+    }
+};
+
 
-   /// <summary>
-   /// Gets order by specified order id.
-   /// 
-   /// Remark: ** this method is NOT required for the proposed problem itself, just a "aditional feature"... **
-   /// </summary>
-   /// <param name="user">The order id.</param>
-   /// <returns>the order</returns>
-    Order& getOrder(const std::string& orderId) const;
 
+/// <summary>
+/// In-process read replica of an order cache.
+/// 
+/// The primary cache sends its mutations (adds and cancels) into a lock-free queue and a 
+/// follower cache applies them on a background thread, so that heavy queries (e.g. 
+/// "getAllOrders()") run on the follower locks and never compete with the primary write path.
+/// Matching is deterministic, so the follower reproduces the primary fills.
+/// 
+/// Remark: queries return the follower state, "staleness()" reports how far behind the primary 
+///         it is, and "setMaxLag()" bounds it (queries wait for the follower to catch up)
+/// Remark: a full queue (REPLICA_QUEUE_SIZE mutations) never stalls the primary: the mutations are
+///         spilled into a growing overflow buffer, drained in order by the follower (see "staleness()")
+/// </summary>
+class OrderCacheReplica
+{
+
+  public:
     /// <summary>
-    /// Gets the order by the specified order identifier.
-    /// 
-    /// ** Convenience accessor **
+    /// Initializes a new instance of the <see cref="OrderCacheReplica"/> class, attached to the
+    /// primary cache (current primary orders are copied to the follower).
     /// </summary>
-    /// <param name="orderId">The order identifier.</param>
-    /// <returns></returns>
-    const Order& operator[] (const std::string& orderId);
-    
+    /// <param name="primary">The primary cache (must outlive the replica).</param>
+    /// <param name="queueSize">The mutations queue size.</param>
+    explicit OrderCacheReplica(OrderCache& primary, size_t queueSize = REPLICA_QUEUE_SIZE);
+
     /// <summary>
-    /// Gets all orders matches
-    /// 
-    /// Remark: ** this method is NOT required for the proposed problem itself, just a "aditional feature"... **
-    ///
-    /// Remark: requeires the definition of EXTENDED_INTERFACE macro in order to be evaluated, 
-    ///         otherwise it will return an empty vector (in oder not penalize standard code 
-    ///         performance avaliation).
+    /// Detaches from the primary cache and stops the follower thread.
+    /// </summary>
+    ~OrderCacheReplica();
+
+    OrderCacheReplica(const OrderCacheReplica&) = delete;
+    OrderCacheReplica& operator=(const OrderCacheReplica&) = delete;
+
+    /// <summary>
+    /// Gets the matching size for security (follower state).
     /// </summary>
     /// <param name="securityId">The security identifier.</param>
-    /// <returns></returns>
-    std::vector<OrderFill> getAllOrderMatches() const;
+    unsigned int getMatchingSizeForSecurity(const std::string& securityId);
 
     /// <summary>
-    /// Gets all orders matches by specified security identifier
-    /// 
-    /// Remark: ** this method is NOT required for the proposed problem itself, just a "aditional feature"... **
-    /// 
-    /// Remark: requeires the definition of EXTENDED_INTERFACE macro in order to be evaluated, 
-    ///         otherwise it will return an empty vector (in oder not penalize standard code 
-    ///         performance avaliation)
+    /// Gets all orders (follower state).
     /// </summary>
-    /// <param name="securityId">The security identifier.</param>
-    /// <returns></returns>
-    std::vector<OrderFill> getOrderMatchesBySecurity(const std::string& securityId) const;
-        
+    std::vector<Order> getAllOrders() const;
+
     /// <summary>
-    /// Returns true case current order cache is in the single thread mode (for debug/performance purposes), false otherwise.
+    /// Checks the order existence by the specified order identifier (follower state).
     /// </summary>
-    /// <returns></returns>
-    const bool multiThread() const { return _multiThread; }
-    
+    bool exists(const std::string& orderId) const;
+
     /// <summary>
-    /// Sets current order cache the single thread mode (for debug/performance purposes).
+    /// Gets the number of orders (follower state).
     /// </summary>
-    /// <param name="value">The value.</param>
-    void setMultiThread(const bool& value) { _multiThread = value; }
+    size_t size() const;
 
     /// <summary>
-    /// Returns true case current order cache is in the verbose mode (for debug purposes), false otherwise.
+    /// Gets the current staleness of the follower.
     /// </summary>
-    /// <returns></returns>
-    const bool verbose() const { return _verbose; }
+    ReplicaStaleness staleness() const;
 
     /// <summary>
-    /// Sets current order cache the verbose mode (for debug purposes).
+    /// Gets the maximum number of pending mutations tolerated by queries.
+    /// </summary>
+    uint64_t maxLag() const { return _maxLag.load(std::memory_order_relaxed); }
+
+    /// <summary>
+    /// Sets the maximum number of pending mutations tolerated by queries (0: read your writes, default: unbounded).
     /// </summary>
     /// <param name="value">The value.</param>
-    void setVerbose(const bool& value) { _verbose = value; }
+    void setMaxLag(uint64_t value) { _maxLag.store(value, std::memory_order_relaxed); }
+
+    /// <summary>
+    /// Waits until the follower applied all mutations published so far.
+    /// </summary>
+    void sync() const;
 
+  private:
+    friend class OrderCache;
 
-private:        
-    typedef typename std::list<OrderFill>::iterator order_match_ptr;
-    typedef typename std::unordered_set<std::string> orders_keys;
-    typedef typename std::unordered_map<std::string, orders_keys> order_index_map;
-    typedef typename std::unordered_map<std::string, order_list> order_match_index;
+    OrderCache& _primary;
+    OrderCache _follower;
+    utils::mpmc_queue<OrderMutation> _queue;
 
-	typedef typename std::shared_lock<std::shared_timed_mutex> read_lock;
-	typedef typename std::unique_lock<std::shared_timed_mutex> write_lock;
-    
-	//----------------------------------------------------------------
+    std::atomic<uint64_t> _published{ 0 };
+    std::atomic<uint64_t> _applied{ 0 };
+    std::atomic<long long> _publishedTime{ 0 };   // steady clock (microseconds)
+    std::atomic<long long> _appliedTime{ 0 };
+    std::atomic<uint64_t> _maxLag{ ULLONG_MAX };
+    std::atomic<bool> _running{ true };
+    std::thread _thread;
 
-	// internal states (used for testing purposes only)
-    // (compares single thread vc multithread processing times, debug verbosity, etc)
-    bool _multiThread = true;
-    bool _verbose = true;
+    // overflow buffer (queue full): used alone until the follower drains it, i.e. keeps the mutations order
+    std::mutex _overflowMutex;
+    std::vector<OrderMutation> _overflow;
+    std::atomic<bool> _overflowing{ false };
+    std::atomic<uint64_t> _overflowMutations{ 0 };
 
     /// <summary>
-	/// The orders access mutex (thread-saveting)
-    /// </summary>
-    mutable std::shared_timed_mutex _ordersMutex;
-    mutable std::shared_mutex _longOrdersMutex;
-    mutable std::shared_mutex _shortOrdersMutex;
-    
-    /// <summary>
-    /// Returns a scoped lock that can be shared by multiple
-    /// readers at the same time while excluding any writers
+    /// Enqueues the mutation (called by the primary, under its write lock) [private]
     /// </summary>
-    /// <returns></returns>
-    read_lock lockForReadOrders() const {
-		return read_lock(_ordersMutex);
-    }
-    
+    void push(OrderMutation&& mutation);
+
     /// <summary>
-    /// This returns a scoped lock that is exclusing to one
-    /// writer preventing any readers
+    /// Follower thread: applies the queued mutations [private]
     /// </summary>
-    /// <returns></returns>
-    write_lock lockForUpdateOrders() {
-        return write_lock(_ordersMutex);
-    }
-        
-    //----------------------------------------------------------------
-    
+    void run();
+
     /// <summary>
-    /// The orders list 
-    /// 
-    /// Remark: storing orders as a list allows to remove itens at 0(1)
+    /// Applies the mutation on the follower cache [private]
     /// </summary>
-    std::list<Order> _orders;
-                
+    void apply(OrderMutation& mutation);
+
     /// <summary>
-	/// The orders index - O(1) access to orders by index
-    /// 
-    /// Remark: implements a relation 1:1 from "orderId" => order pointer (on list)
+    /// Waits until the pending mutations are within the maximum lag [private]
     /// </summary>
-    std::unordered_map<std::string, order_ptr> _orderIndex;
-        
+    void waitForMaxLag() const;
+};
+
+
+
+/*----------------------------------------------------------------
+    SHARED MEMORY ORDER CACHE
+ ----------------------------------------------------------------*/
+
+namespace shm {
+    // shared memory segment layout (see OrderCache.cpp)
+    struct header;
+    struct order_record;
+    struct security_record;
+    struct string_ref;
+}
+
+
+/// <summary>
+/// Capacities of a shared memory order cache segment (fixed at creation)
+/// </summary>
+struct SharedCacheCapacity {
+    unsigned int orders = 1 << 20;       // max live orders
+    unsigned int securities = 1 << 12;   // max distinct securities
+    unsigned int symbols = 1 << 16;      // max distinct security/side/user/company strings
+    size_t arenaBytes = 64ull << 20;     // string arena (order ids + symbols)
+};
+
+
+/// <summary>
+/// Order cache living in a named shared memory segment, readable by multiple processes.
+/// 
+/// Order records, the string arena and all indexes are stored in the segment and link 
+/// to each other by offsets (record indexes) instead of pointers/iterators, so the segment
+/// can be mapped at any address. One writer process creates the segment and owns all 
+/// mutations (matching at insertion time, as USE_CACHED_MATCHING_AT_ADD_ORDER), while 
+/// reader processes map it read-only and run queries (e.g. "getMatchingSizeForSecurity()")
+/// directly on the segment, without IPC.
+/// 
+/// Remark: readers use a seqlock protocol - the writer makes the sequence number odd while
+///         mutating, and readers retry when the sequence changed under their read
+/// Remark: mutating methods are no-ops on readers (or throw, case THROW_EXCEPTIONS is defined)
+/// </summary>
+/// <seealso cref="OrderCacheInterface" />
+class SharedOrderCache : public OrderCacheInterface
+{
+
+  public:
     /// <summary>
-    /// The user orders index - O(1) access to orders by user
-    /// 
-    /// Remark: implements a relation 1:n from "user" => "orderId"
+    /// Creates (or replaces) the named segment and opens it for writing.
     /// </summary>
-    order_index_map _userOrdersIndex;
-    
+    /// <param name="name">The segment name (e.g. "/orders").</param>
+    /// <param name="capacity">The segment capacities.</param>
+    SharedOrderCache(const std::string& name, const SharedCacheCapacity& capacity);
+
     /// <summary>
-    /// The security orders index - O(1) access to orders by security
-    /// 
-    /// Remark: implements a relation 1:n from "securityId" => "orderId"
+    /// Opens the existing named segment for reading only.
     /// </summary>
-    order_index_map _securityOrdersIndex;
+    /// <param name="name">The segment name (e.g. "/orders").</param>
+    explicit SharedOrderCache(const std::string& name);
 
+    ~SharedOrderCache();
 
-    //----------------------------------------------------------------
-        
-    // thread-safe reading matched quantity
-    mutable std::shared_timed_mutex _matchedQuantityMutex;
+    SharedOrderCache(const SharedOrderCache&) = delete;
+    SharedOrderCache& operator=(const SharedOrderCache&) = delete;
 
     /// <summary>
-    /// The security long orders index (buy side) - optimization
+    /// Removes the named segment (mapped instances stay valid until closed).
     /// </summary>
-    order_match_index _securityLongOrdersIndex;
+    /// <param name="name">The segment name.</param>
+    static bool remove(const std::string& name);
 
     /// <summary>
-    /// The security short orders index (sell side) - optimization
+    /// Returns true if the segment was successfully mapped.
     /// </summary>
-    order_match_index _securityShortOrdersIndex;
-            
+    bool isOpen() const { return m_header != nullptr; }
+
     /// <summary>
-	/// The matched quantity cache by securityId (main cache)
-    /// 
-    /// Remark: use "getMatchedQuantityInCache()" for thread-safe 
+    /// Returns true if the current instance is a (read-only) reader.
     /// </summary>
-    std::unordered_map<std::string, unsigned int> _matchedQuantity;
-    
+    bool readOnly() const { return m_readOnly; }
+
     /// <summary>
-    /// The orders matches list 
-    /// Remark: required for extended interface: "getOrderMatches()", "getOrderMatchesBySecurity()", etc
-    /// Remark: requeires the definition of EXTENDED_INTERFACE macro in order to be evaluated, 
-    ///         otherwise it will return an empty vector (in oder not penalize standard code 
-    ///         performance avaliation)
+    /// Adds the order and matches it against the opposite side (writer only).
+    /// Remark: O(1) + O(counterparties)
     /// </summary>
-    std::list<OrderFill> _orderMatches;
-
+    void addOrder(Order order) override;
 
     /// <summary>
-    /// Gets the current cached matched quantity by security (thread-safe).
+    /// Cancels the order by specified Id (writer only).
+    /// Remark: O(1)
     /// </summary>
-    /// <param name="securityId">The security identifier.</param>
-    /// <returns></returns>
-    unsigned int getMatchedQuantityInCache(const std::string& securityId) const;
+    void cancelOrder(const std::string& orderId) override;
 
-   
-    //----------------------------------------------------------------
-    
     /// <summary>
-    /// Cancels the orders (uses multithreading if required, i.e. number of orders > DELETE_CHUNK_SIZE) [private]
+    /// Cancels the orders for the specified user (writer only).
+    /// Remark: O(capacity) - scans the order records
     /// </summary>
-    /// <param name="orders">The order identifiers.</param>
-    /// <param name="minQty">Only cancel the specified order if the order quantity if greather than minQty value.</param>
-    void cancelOrders(orders_keys& orders, unsigned int minQty = 0);
-
+    void cancelOrdersForUser(const std::string& user) override;
 
-    // <summary>
-	/// Cancels the orders on the specified range (helper snippet) [private]
+    /// <summary>
+    /// Cancels the orders for sec identifier with minimum quantity of lots (writer only).
+    /// Remark: O(orders in security)
     /// </summary>
-    /// <param name="orders">The order identifiers.</param>
-    /// <param name="start">start iterator.</param>
-    /// <param name="start">end iterator.</param>
-    /// <param name="minQty">Only cancel the specified order if the order quantity if greather than minQty value.</param>
-    void OrderCache::cancelOrdersRange(orders_keys& orders, orders_keys::iterator& start, orders_keys::iterator& end, unsigned int minQty = 0);
-
+    void cancelOrdersForSecIdWithMinimumQty(const std::string& securityId, unsigned int minQty) override;
 
     /// <summary>
-    /// Cancels the order (without locks - thread unsafe) [private]
+    /// Gets the matching size for security (writer and readers, no IPC).
+    /// Remark: O(1)
     /// </summary>
-    /// <param name="orderId">The order identifier.</param>
-    /// <param name="minQty">Only cancel the specified order if the order quantity if greather than minQty value.</param>
-    void cancelSingleOrder(const std::string& orderId, unsigned int minQty = 0, bool lockOrder = false);
-
-
-    //----------------------------------------------------------------
+    unsigned int getMatchingSizeForSecurity(const std::string& securityId) override;
 
     /// <summary>
-    /// Finds matches for the specified order and store it in cache (without locks - thread unsafe) [private]
-    /// Remark: solution for getMatchingSizeForSecurity() with O(1)
+    /// Gets all orders (writer and readers).
+    /// Remark: O(capacity)
     /// </summary>
-    /// <param name="orderId">The order identifier.</param>
-    unsigned int matchOrderInCache(order_ptr& ptr, bool lockOrder = true);
+    std::vector<Order> getAllOrders() const override;
 
+    /// <summary>
+    /// Checks the order existence by the specified order identifier.
+    /// </summary>
+    bool exists(const std::string& orderId) const;
 
-    std::mutex _ThreadPoolMutex;
-    std::vector<std::thread> _ThreadPool;    
     /// <summary>
-    /// Finds matches for the specified order and store it in cache, handling thread pool
+    /// Gets the number of orders in the segment.
     /// </summary>
-    /// <param name="ptr">The PTR.</param>
-    void matchOrderInPool(order_ptr& ptr);
+    size_t size() const;
 
-    //----------------------------------------------------------------
+    /// <summary>
+    /// Gets a copy of the order by specified order id (empty order if not found, 
+    /// or throws case THROW_EXCEPTIONS is defined).
+    /// </summary>
+    Order getOrder(const std::string& orderId) const;
 
     /// <summary>
-    /// Determines whether specified order is a buy order (long).
+    /// Gets the segment sequence number (incremented by 2 on each mutation).
     /// </summary>
-    /// <param name="ptr">The order pointer.</param>
-    /// <returns>
-    ///   <c>true</c> if order is buy side; <c>false</c> if order is sell side.
-    /// </returns>
-    static const bool isBuySide(order_ptr& ptr) {
-		return ptr->side() != "Sell";
-    }
-    
+    uint64_t sequence() const;
+
+  private:
+    std::string m_name;
+    bool m_readOnly = true;
+    void* m_base = nullptr;
+    size_t m_bytes = 0;
+    void* m_handle = nullptr; // platform specific mapping handle
+
+    shm::header* m_header = nullptr;
+    shm::order_record* m_records = nullptr;
+    shm::security_record* m_securities = nullptr;
+    uint32_t* m_orderTable = nullptr;
+    uint32_t* m_securityTable = nullptr;
+    shm::string_ref* m_symbolTable = nullptr;
+    char* m_arena = nullptr;
+
+    // writer threads of the owning process
+    mutable std::mutex m_writeMutex;
+
+    bool map(bool create, size_t bytes);
+    void unmap();
+    void locate();
+
+    // seqlock (writer side)
+    void beginWrite();
+    void endWrite();
+
     /// <summary>
-    /// Comparator predicate intended to sorting orders by workings lots (descending).
+    /// Runs the read functor until it observes a consistent snapshot (seqlock, reader side).
     /// </summary>
-    /// <param name="left">The left order.</param>
-    /// <param name="right">The right order.</param>
-    /// <returns></returns>
-    static const bool workingLotsComparator(const order_ptr& left, const order_ptr& right) {        
-        return left->workingQty() > right->workingQty();
-    }
+    template <typename Func>
+    auto consistentRead(Func functor) const -> decltype(functor());
+
+    bool checkWritable() const;
+
+    std::string text(const shm::string_ref& ref) const;
+    bool equals(const shm::string_ref& ref, const std::string& value) const;
+    bool allocate(const std::string& value, shm::string_ref& ref);
+    bool intern(const std::string& value, shm::string_ref& ref);
+    uint32_t findSymbol(const std::string& value) const;
+
+    uint32_t findOrder(const std::string& orderId) const;
+    uint32_t findRecordSlot(uint32_t index) const;
+    uint32_t findSecurity(const std::string& securityId) const;
+    uint32_t addSecurity(const std::string& securityId);
+    void eraseOrderSlot(uint32_t slot);
+    void cancelRecord(uint32_t index);
+    void match(uint32_t index);
+    Order toOrder(uint32_t index) const;
 };
 
 
@@ -961,7 +3698,8 @@ namespace debug {
             if (msg == "")
                 return getElapsedTime(start);
 
-            return toc(utils::osyncstream(), start, msg);
+            utils::osyncstream out;
+            return toc(out, start, msg);
         }
 
         /// <summary>
@@ -991,7 +3729,8 @@ namespace debug {
         /// <param name="order">The order.</param>
         /// <param name="tabs">The number of empty spaces on the begining.</param>
         static void print(order_ptr& order, unsigned int tabs = 0) {
-            print(utils::osyncstream(), order, tabs);
+            utils::osyncstream out;
+            print(out, order, tabs);
         }
 
         /// <summary>
@@ -1011,8 +3750,9 @@ namespace debug {
         /// <param name="orders">The orders list.</param>
         /// <param name="tabs">The number of empty spaces on the begining.</param>
         static void print(order_list& orders, unsigned int tabs = 0) {
+            utils::osyncstream out;
             for (order_ptr& order : orders)
-                print(utils::osyncstream(), order, tabs);
+                print(out, order, tabs);
         }
 
         /// <summary>
@@ -1083,4 +3823,210 @@ namespace debug {
         }
         #endif // _DEBUG
     };
+
+
+    /// <summary>
+    /// Latency histogram (nanoseconds) with log-linear buckets: 16 buckets per power of two, 
+    /// i.e. percentiles within 6.25% (no allocation, O(1) recording, mergeable across threads)
+    /// </summary>
+    class LatencyHistogram {
+    public:
+
+        /// <summary>
+        /// Records a latency sample.
+        /// </summary>
+        /// <param name="ns">The latency (nanoseconds).</param>
+        void record(uint64_t ns) {
+            m_counts[bucket(ns)]++;
+            m_count++;
+            m_sum += ns;
+            m_max = std::max(m_max, ns);
+        }
+
+        /// <summary>
+        /// Records the latency elapsed since the start time.
+        /// </summary>
+        /// <param name="start">The start time.</param>
+        void record(const timer_start& start) {
+            record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        /// <summary>
+        /// Adds the samples of other histogram (e.g. of other thread).
+        /// </summary>
+        void merge(const LatencyHistogram& other) {
+            for (size_t i = 0; i < BUCKETS; i++)
+                m_counts[i] += other.m_counts[i];
+            m_count += other.m_count;
+            m_sum += other.m_sum;
+            m_max = std::max(m_max, other.m_max);
+        }
+
+        /// <summary>
+        /// Gets the latency percentile (upper bound of the bucket, nanoseconds).
+        /// </summary>
+        /// <param name="p">The percentile (e.g. 99.9).</param>
+        /// <returns></returns>
+        uint64_t percentile(double p) const {
+            if (m_count == 0)
+                return 0;
+
+            const uint64_t rank = std::max<uint64_t>(1, (uint64_t)(p / 100.0 * m_count + 0.5));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BUCKETS; i++) {
+                seen += m_counts[i];
+                if (seen >= rank)
+                    return std::min(upperBound(i), m_max);
+            }
+            return m_max;
+        }
+
+        uint64_t count() const { return m_count; }
+        uint64_t max() const { return m_max; }
+        double mean() const { return m_count ? (double)m_sum / m_count : 0; }
+
+        /// <summary>
+        /// Returns the percentiles summary (microseconds).
+        /// </summary>
+        std::string str() const {
+            std::ostringstream os;
+            os.setf(std::ios::fixed);
+            os.precision(1);
+            os << "p50: " << percentile(50) / 1000.0 << "us, p99: " << percentile(99) / 1000.0
+               << "us, p99.9: " << percentile(99.9) / 1000.0 << "us, max: " << m_max / 1000.0 << "us";
+            return os.str();
+        }
+
+    private:
+        static constexpr unsigned int SUB_BITS = 4;
+        static constexpr size_t BUCKETS = 64 << SUB_BITS;
+
+        static size_t bucket(uint64_t ns) {
+            if (ns < (1u << SUB_BITS))
+                return (size_t)ns;
+
+            unsigned int msb = 0;
+            for (unsigned int step = 32; step > 0; step >>= 1)
+                if (ns >> (msb + step))
+                    msb += step;
+            const unsigned int shift = msb - SUB_BITS;
+            return ((size_t)(shift + 1) << SUB_BITS) + (size_t)((ns >> shift) & ((1u << SUB_BITS) - 1));
+        }
+
+        static uint64_t upperBound(size_t index) {
+            if (index < (1u << SUB_BITS))
+                return index;
+
+            const unsigned int shift = (unsigned int)(index >> SUB_BITS) - 1;
+            return (((1ull << SUB_BITS) + (index & ((1u << SUB_BITS) - 1))) << shift) + (1ull << shift) - 1;
+        }
+
+        uint64_t m_counts[BUCKETS] = {};
+        uint64_t m_count = 0;
+        uint64_t m_sum = 0;
+        uint64_t m_max = 0;
+    };
+
+
+    /// <summary>
+    /// Open-loop load report (see LoadGenerator::run())
+    /// </summary>
+    struct LoadReport {
+        uint64_t ops = 0;             // issued operations
+        uint64_t late = 0;            // operations issued after their intended send time (generator behind schedule)
+        double targetRate = 0;        // scheduled operations per second
+        double achievedRate = 0;      // completed operations per second
+        LatencyHistogram latency;     // from the intended send time (corrected, i.e. includes the queueing delay)
+        LatencyHistogram service;     // from the actual send time (closed-loop timing, hides the queueing delay)
+
+        /// <summary>
+        /// Returns the report as printable text.
+        /// </summary>
+        std::string str() const {
+            std::ostringstream os;
+            os << "load {ops: " << ops << ", late: " << late << ", target: " << (uint64_t)targetRate 
+               << " ops/s, achieved: " << (uint64_t)achievedRate << " ops/s}\n"
+               << "  corrected latency: " << latency.str() << '\n'
+               << "  service time:      " << service.str() << '\n';
+            return os.str();
+        }
+    };
+
+
+    /// <summary>
+    /// Open-loop load generator: issues the operations on a fixed schedule (operation k at 
+    /// start + k / rate, round robin over the threads), whatever the previous operations took, 
+    /// and measures each latency from its intended send time. Stalls then delay all operations 
+    /// scheduled meanwhile (as they would delay the incoming requests), i.e. percentiles free of 
+    /// coordinated omission, instead of the single slow sample of the closed-loop timing.
+    /// </summary>
+    class LoadGenerator {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="LoadGenerator"/> class.
+        /// </summary>
+        /// <param name="opsPerSecond">The target rate (all threads).</param>
+        /// <param name="threads">The number of sender threads.</param>
+        LoadGenerator(double opsPerSecond, unsigned int threads = 1)
+            : m_rate(opsPerSecond), m_threads(std::max(1u, threads)) {}
+
+        /// <summary>
+        /// Issues the operations on schedule and waits for them.
+        /// </summary>
+        /// <param name="ops">The number of operations.</param>
+        /// <param name="operation">The operation, called as operation(thread, k) with k the operation sequence.</param>
+        /// <returns>the load report</returns>
+        template <typename Operation>
+        LoadReport run(uint64_t ops, Operation operation) const {
+            const std::chrono::nanoseconds interval((int64_t)(1e9 / m_rate));
+            std::vector<LoadReport> reports(m_threads);
+            std::vector<std::thread> threads;
+
+            // remark: a common start (a little ahead) for the threads schedules
+            const timer_start start = TestUtils::tic() + std::chrono::milliseconds(1);
+            for (unsigned int t = 0; t < m_threads; t++)
+                threads.emplace_back([&, t]() {
+                    LoadReport& report = reports[t];
+                    for (uint64_t k = t; k < ops; k += m_threads) {
+                        const timer_start intended = start + interval * k;
+                        
+                        // waits for the send time (sleeps far from it, yields close to it)
+                        timer_start now = TestUtils::tic();
+                        if (intended > now + std::chrono::microseconds(200))
+                            std::this_thread::sleep_until(intended - std::chrono::microseconds(100));
+                        while ((now = TestUtils::tic()) < intended)
+                            std::this_thread::yield();
+                        if (now - intended > interval)
+                            report.late++;
+
+                        operation(t, k);
+
+                        const timer_start end = TestUtils::tic();
+                        report.latency.record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - intended).count());
+                        report.service.record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - now).count());
+                        report.ops++;
+                    }
+                });
+
+            for (std::thread& thread : threads)
+                thread.join();
+            const double seconds = std::chrono::duration<double>(TestUtils::tic() - start).count();
+
+            LoadReport total;
+            total.targetRate = m_rate;
+            for (LoadReport& report : reports) {
+                total.ops += report.ops;
+                total.late += report.late;
+                total.latency.merge(report.latency);
+                total.service.merge(report.service);
+            }
+            total.achievedRate = seconds > 0 ? total.ops / seconds : 0;
+            return total;
+        }
+
+    private:
+        double m_rate;
+        unsigned int m_threads;
+    };
 }
\ No newline at end of file
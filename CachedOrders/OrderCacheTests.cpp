@@ -16,6 +16,10 @@
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <fstream>
+#include <cstdio>
+#include <atomic>
+#include <iomanip>
 
 
 class OrderCacheTest : public ::testing::Test {
@@ -345,7 +349,7 @@ TEST_F(OrderCacheTest, X1_ExtendedTest_OrderSortingByWorkingLots) {
     };
 
     // fill sample data
-    std::list<Order> data;    
+    order_storage data;    
     order_list orderIndex;
 
     for (unsigned int i = 0; i < SIZE; i++) {
@@ -552,7 +556,7 @@ TEST_F(OrderCacheTest, X5_PerformanceTest_MultithreadOrderMatch) {
 
     OrderCache multiThreadCache;
     multiThreadCache.setVerbose(false);
-    multiThreadCache.setMultiThread(false);
+    multiThreadCache.setMultiThread(true);
     fill(multiThreadCache);
     ASSERT_EQ(multiThreadCache.size(), size);
 
@@ -626,6 +630,1828 @@ TEST_F(OrderCacheTest, X6_PerformanceTest_MultithreadCancel) {
 }
 
 
+// Extended Test 7: memory footprint report
+TEST_F(OrderCacheTest, X7_ExtensionsTest_MemoryReport) {
+    cache.setVerbose(false);
+    auto empty = cache.memoryReport();
+
+    for (unsigned int i = 0; i < 1000; i++) {
+        cache.addOrder(Order{ "OrderIdentifierWithLongName" + std::to_string(i), i % 2 ? "SecId1" : "SecId2",
+            i % 4 < 2 ? "Buy" : "Sell", 100, "User" + std::to_string(i % 10), "Company" + std::to_string(i % 3) });
+    }
+    cache.setVerbose(true);
+
+    auto report = cache.memoryReport();
+    #ifdef _DEBUG
+    utils::osyncstream() << report.str();
+    #endif
+
+    ASSERT_EQ(report.structures.size(), 20);
+    ASSERT_EQ(report.structures["_orders"].elements, 1000);
+    ASSERT_GE(report.structures["_orders"].allocatedBytes, 1000 * sizeof(Order));
+    ASSERT_GT(report.structures["_orderIndex"].stringBytes, 0);
+    ASSERT_GT(report.structures["_userOrdersIndex"].allocatedBytes, 0);
+    ASSERT_EQ(report.structures["_companyKeys"].elements, 3);
+    ASSERT_GT(report.structures["_companyKeys"].allocatedBytes, 0);
+    ASSERT_GT(report.totalBytes(), empty.totalBytes());
+
+    ASSERT_EQ(report.securities.size(), 2);
+    ASSERT_EQ(report.securities["SecId1"].orders, 500);
+    ASSERT_GT(report.securities["SecId1"].sideIndexBytes, 0);
+
+    // released memory is reported back
+    cache.cancelOrdersForUser("User1");
+    ASSERT_LT(cache.memoryReport().structures["_orders"].allocatedBytes, report.structures["_orders"].allocatedBytes);
+}
+
+
+// Extended Test 8: asynchronous logger (lock-free queue, background writer)
+TEST_F(OrderCacheTest, X8_ExtensionsTest_AsyncLogger) {
+    const std::string path = "async_logger_test.log";
+    std::remove(path.c_str());
+
+    auto& logger = utils::async_logger::instance();
+    ASSERT_TRUE(logger.open(path));
+
+    // the dropped messages counter is cumulative (process-wide)
+    const size_t droppedBefore = logger.dropped();
+
+    const int nthreads = 4;
+    const int nmessages = 1000;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < nthreads; i++) {
+        threads.push_back(std::thread([i]() {
+            for (int j = 0; j < nmessages; j++)
+                utils::osyncstream() << "thread " << i << " message " << j << "\n";
+        }));
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    // messages larger than a record are reassembled
+    std::string large(1000, 'x');
+    utils::osyncstream() << large << "\n";
+
+    logger.setOutput(stdout);
+
+    std::ifstream file(path);
+    std::string line;
+    size_t lines = 0, largeLines = 0;
+    while (std::getline(file, line)) {
+        // skips the writer notices of dropped messages
+        if (line.rfind("[async_logger:", 0) == 0)
+            continue;
+        if (line == large)
+            largeLines++;
+        else
+            lines++;
+    }
+    file.close();
+    std::remove(path.c_str());
+
+    // every message is either written or dropped as a whole (the large message spans several records)
+    const size_t dropped = logger.dropped() - droppedBefore;
+    ASSERT_LE(lines, (size_t)(nthreads * nmessages));
+    ASSERT_LE(largeLines, 1);
+    ASSERT_EQ(lines + largeLines + dropped, (size_t)(nthreads * nmessages) + 1);
+    if (dropped == 0) {
+        ASSERT_EQ(lines, (size_t)(nthreads * nmessages));
+        ASSERT_EQ(largeLines, 1);
+    }
+}
+
+
+// Extended Test 9: allocation-free serialization (text, JSON and binary)
+TEST_F(OrderCacheTest, X9_ExtensionsTest_Serialization) {
+    auto order = Order{ "Ord\"1", "SecId1", "Buy", 1000, "User1", "CompanyA" };
+    order.fillLots(400);
+
+    // text into a caller-provided buffer
+    char text[256];
+    char* end = order.format(text, text + sizeof(text));
+    ASSERT_NE(end, nullptr);
+    ASSERT_EQ(std::string(text, end), "order{id: Ord\"1, security: SecId1, side: Buy, qty: 1000, working: 600, filled: 400, user: User1, company: CompanyA}");
+    ASSERT_EQ(order.str(), std::string(text, end));
+    ASSERT_EQ(order.format(text, text + 10), nullptr);
+
+    // JSON
+    utils::output_buffer out;
+    order.writeJson(out);
+    ASSERT_EQ(out.str(), "{\"id\":\"Ord\\\"1\",\"security\":\"SecId1\",\"side\":\"Buy\",\"qty\":1000,\"working\":600,\"user\":\"User1\",\"company\":\"CompanyA\",\"session\":\"\",\"expiry\":0}");
+
+    // binary round trip
+    out.clear();
+    order.writeBinary(out);
+    auto decoded = Order{ "", "", "", 0, "", "" };
+    const char* first = out.data();
+    ASSERT_TRUE(Order::readBinary(first, out.data() + out.size(), decoded));
+    ASSERT_EQ(first, out.data() + out.size());
+    ASSERT_EQ(decoded.str(), order.str());
+
+    const char* truncated = out.data();
+    ASSERT_FALSE(Order::readBinary(truncated, out.data() + out.size() - 1, decoded));
+
+    // good-till-date and good-for-day expiries
+    for (uint64_t expiry : { (uint64_t)1700000000000000ull, Order::GOOD_FOR_DAY }) {
+        Order expiring = order.clone();
+        expiring.setExpiry(expiry);
+        out.clear();
+        expiring.writeBinary(out);
+        first = out.data();
+        ASSERT_TRUE(Order::readBinary(first, out.data() + out.size(), decoded));
+        ASSERT_EQ(decoded.expiry(), expiry);
+        ASSERT_EQ(decoded.str(), expiring.str());
+        out.clear();
+        expiring.writeJson(out);
+        ASSERT_NE(out.str().find(",\"expiry\":" + std::to_string(expiry) + "}"), std::string::npos);
+    }
+    ASSERT_EQ(order.str().find("expiry"), std::string::npos);
+
+    // client session (cancel on disconnect of a rebuilt book)
+    Order session = order.clone();
+    session.setSession("Session1");
+    out.clear();
+    session.writeBinary(out);
+    first = out.data();
+    ASSERT_TRUE(Order::readBinary(first, out.data() + out.size(), decoded));
+    ASSERT_EQ(decoded.session(), "Session1");
+    ASSERT_EQ(decoded.str(), session.str());
+    out.clear();
+    session.writeJson(out);
+    ASSERT_NE(out.str().find(",\"session\":\"Session1\""), std::string::npos);
+    ASSERT_EQ(order.str().find("session"), std::string::npos);
+    {
+        OrderCache rebuilt;
+        rebuilt.setVerbose(false);
+        rebuilt.addOrder(decoded);
+        rebuilt.cancelOrdersForSession("Session1");
+        ASSERT_EQ(rebuilt.size(), 0);
+    }
+
+    auto fill = OrderFill{ "Ord1", "Ord2", 300 };
+    out.clear();
+    fill.writeBinary(out);
+    auto decodedFill = OrderFill{ "", "", 0 };
+    first = out.data();
+    ASSERT_TRUE(OrderFill::readBinary(first, out.data() + out.size(), decodedFill));
+    ASSERT_EQ(decodedFill.str(), "order fill {buy: Ord1, sell: Ord2, qty: 300}");
+    out.clear();
+    fill.writeJson(out);
+    ASSERT_EQ(out.str(), "{\"buy\":\"Ord1\",\"sell\":\"Ord2\",\"qty\":300,\"sequence\":0}");
+
+    //
+    // export the cache (reusing the same buffer)
+    //
+    const unsigned int size = 100000;
+    cache.setVerbose(false);
+    for (unsigned int i = 0; i < size; i++)
+        cache.addOrder(Order{ std::to_string(i), "SecId" + std::to_string(i % 1000), i % 2 ? "Buy" : "Sell", i, "User1", "CompanyA" });
+    cache.setVerbose(true);
+
+    out.clear();
+    cache.exportOrders(out, ExportFormat::Json);
+    size_t capacity = out.capacity();
+
+    out.clear();
+    auto start = debug::TestUtils::tic();
+    ASSERT_EQ(cache.exportOrders(out, ExportFormat::Json), size);
+    debug::TestUtils::toc(start, "JSON export time (100k orders): ");
+    ASSERT_EQ(out.capacity(), capacity);
+    ASSERT_EQ(out.data()[0], '[');
+    ASSERT_EQ(out.data()[out.size() - 1], ']');
+
+    out.clear();
+    start = debug::TestUtils::tic();
+    cache.exportOrders(out, ExportFormat::Binary);
+    debug::TestUtils::toc(start, "binary export time (100k orders): ");
+
+    first = out.data();
+    uint64_t count = 0;
+    ASSERT_TRUE(utils::readVarint(first, out.data() + out.size(), count));
+    ASSERT_EQ(count, size);
+    for (uint64_t i = 0; i < count; i++)
+        ASSERT_TRUE(Order::readBinary(first, out.data() + out.size(), decoded));
+    ASSERT_EQ(first, out.data() + out.size());
+}
+
+
+// Extended Test 10: shared memory order cache (single writer, read-only readers)
+TEST_F(OrderCacheTest, X10_ExtensionsTest_SharedMemoryCache) {
+    const std::string name = "/OrderCacheTest_X10";
+
+    SharedCacheCapacity capacity;
+    capacity.orders = 1024;
+    capacity.securities = 16;
+    capacity.symbols = 64;
+    capacity.arenaBytes = 1 << 16;
+
+    SharedOrderCache writer(name, capacity);
+    ASSERT_TRUE(writer.isOpen());
+
+    // first example from README.txt
+    writer.addOrder(Order{"OrdId1", "SecId1", "Buy", 1000, "User1", "CompanyA"});
+    writer.addOrder(Order{"OrdId2", "SecId2", "Sell", 3000, "User2", "CompanyB"});
+    writer.addOrder(Order{"OrdId3", "SecId1", "Sell", 500, "User3", "CompanyA"});
+    writer.addOrder(Order{"OrdId4", "SecId2", "Buy", 600, "User4", "CompanyC"});
+    writer.addOrder(Order{"OrdId5", "SecId2", "Buy", 100, "User5", "CompanyB"});
+    writer.addOrder(Order{"OrdId6", "SecId3", "Buy", 1000, "User6", "CompanyD"});
+    writer.addOrder(Order{"OrdId7", "SecId2", "Buy", 2000, "User7", "CompanyE"});
+    writer.addOrder(Order{"OrdId8", "SecId2", "Sell", 5000, "User8", "CompanyE"});
+
+    // reader (another process would do the same)
+    SharedOrderCache reader(name);
+    ASSERT_TRUE(reader.isOpen());
+    ASSERT_TRUE(reader.readOnly());
+    ASSERT_EQ(reader.size(), 8);
+    ASSERT_EQ(reader.getMatchingSizeForSecurity("SecId1"), 0);
+    ASSERT_EQ(reader.getMatchingSizeForSecurity("SecId2"), 2700);
+    ASSERT_EQ(reader.getMatchingSizeForSecurity("SecId3"), 0);
+    ASSERT_EQ(reader.getOrder("OrdId4").workingQty(), 0);
+    ASSERT_EQ(reader.getOrder("OrdId2").filledQty(), 2600);
+    ASSERT_EQ(reader.getAllOrders().size(), 8);
+
+    // readers cannot mutate the segment
+    reader.cancelOrder("OrdId1");
+    ASSERT_TRUE(reader.exists("OrdId1"));
+
+    // cancels are visible to the reader (and records are reused)
+    writer.cancelOrdersForUser("User2");
+    writer.cancelOrder("OrdId1");
+    writer.cancelOrdersForSecIdWithMinimumQty("SecId2", 2000);
+    ASSERT_FALSE(reader.exists("OrdId2"));
+    ASSERT_FALSE(reader.exists("OrdId1"));
+    ASSERT_FALSE(reader.exists("OrdId7"));
+    ASSERT_EQ(reader.size(), 4);
+    writer.addOrder(Order{"OrdId9", "SecId3", "Sell", 400, "User9", "CompanyF"});
+    ASSERT_EQ(reader.getMatchingSizeForSecurity("SecId3"), 400);
+    ASSERT_EQ(reader.getOrder("OrdId9").side(), "Sell");
+
+    // concurrent reader: always a consistent snapshot (seqlock)
+    std::atomic<bool> done{ false };
+    std::atomic<int> inconsistent{ 0 };
+    std::thread concurrentReader([&]() {
+        while (!done) {
+            auto orders = reader.getAllOrders();
+            unsigned int buy = 0, sell = 0;
+            for (auto& order : orders)
+                if (order.securityId() == "SecId9")
+                    (order.side() == "Buy" ? buy : sell) += order.filledQty();
+            if (buy != sell)
+                inconsistent++;
+        }
+    });
+    for (unsigned int i = 0; i < 500; i++)
+        writer.addOrder(Order{ "X" + std::to_string(i), "SecId9", i % 2 ? "Buy" : "Sell", 10 + i % 7, "User" + std::to_string(i), i % 3 ? "CompanyA" : "CompanyB" });
+    done = true;
+    concurrentReader.join();
+    ASSERT_EQ(inconsistent, 0);
+
+    // mass cancels unlink the order table slots by the stored hashes (probe chains stay intact)
+    const size_t live = writer.size();
+    writer.cancelOrdersForUser("NoUser");
+    ASSERT_EQ(writer.size(), live);
+    for (unsigned int i = 0; i < 200; i++)
+        writer.addOrder(Order{ "Y" + std::to_string(i), "SecId1", "Buy", 1 + i, "User1", "CompanyA" });
+    ASSERT_EQ(writer.size(), live + 200);
+    const size_t others = reader.exists("X1"); // same user
+    writer.cancelOrdersForUser("User1");
+    ASSERT_EQ(reader.size(), live - others);
+    std::vector<bool> stored(500);
+    for (unsigned int i = 0; i < 500; i++)
+        stored[i] = reader.exists("X" + std::to_string(i));
+    ASSERT_GT(std::count(stored.begin(), stored.end(), true), 10);
+    writer.cancelOrdersForSecIdWithMinimumQty("SecId9", 13);
+    for (unsigned int i = 0; i < 500; i++)
+        ASSERT_EQ(reader.exists("X" + std::to_string(i)), stored[i] && 10 + i % 7 < 13);
+    ASSERT_FALSE(reader.exists("Y0"));
+
+    SharedOrderCache::remove(name);
+}
+
+
+// Extended Test 12: in-process read replica fed by the mutations stream
+TEST_F(OrderCacheTest, X12_ExtensionsTest_ReadReplica) {
+    // orders before attaching are copied (not matched again)
+    cache.addOrder(Order{"OrdId1", "SecId1", "Buy", 1000, "User1", "CompanyA"});
+    cache.addOrder(Order{"OrdId2", "SecId2", "Sell", 3000, "User2", "CompanyB"});
+    cache.addOrder(Order{"OrdId3", "SecId1", "Sell", 500, "User3", "CompanyA"});
+    cache.addOrder(Order{"OrdId4", "SecId2", "Buy", 600, "User4", "CompanyC"});
+
+    OrderCacheReplica replica(cache);
+    ASSERT_TRUE(cache.hasReplica());
+    ASSERT_EQ(replica.size(), 4);
+    ASSERT_EQ(replica.getMatchingSizeForSecurity("SecId2"), 600);
+
+    // first example from README.txt (remaining orders)
+    cache.addOrder(Order{"OrdId5", "SecId2", "Buy", 100, "User5", "CompanyB"});
+    cache.addOrder(Order{"OrdId6", "SecId3", "Buy", 1000, "User6", "CompanyD"});
+    cache.addOrder(Order{"OrdId7", "SecId2", "Buy", 2000, "User7", "CompanyE"});
+    cache.addOrder(Order{"OrdId8", "SecId2", "Sell", 5000, "User8", "CompanyE"});
+    
+    // read your writes
+    replica.sync();
+    ASSERT_EQ(replica.staleness().pendingMutations, 0);
+    ASSERT_EQ(replica.size(), 8);
+    ASSERT_EQ(replica.getMatchingSizeForSecurity("SecId1"), 0);
+    ASSERT_EQ(replica.getMatchingSizeForSecurity("SecId2"), 2700);
+    ASSERT_EQ(replica.getMatchingSizeForSecurity("SecId3"), 0);
+
+    cache.cancelOrder("OrdId1");
+    cache.cancelOrdersForUser("User2");
+    cache.cancelOrdersForSecIdWithMinimumQty("SecId2", 2000);
+    replica.setMaxLag(0);
+    ASSERT_FALSE(replica.exists("OrdId1"));
+    ASSERT_FALSE(replica.exists("OrdId2"));
+    ASSERT_FALSE(replica.exists("OrdId7"));
+    ASSERT_EQ(replica.size(), cache.size());
+
+    // replica queries while the primary is updated: converges to the primary state
+    std::atomic<bool> done{ false };
+    replica.setMaxLag(ULLONG_MAX);
+    std::thread reader([&]() {
+        while (!done)
+            replica.getAllOrders();
+    });
+    for (unsigned int i = 0; i < 5000; i++)
+        cache.addOrder(Order{ "X" + std::to_string(i), "SecId" + std::to_string(i % 10), i % 2 ? "Buy" : "Sell", 10 + i % 7, "User" + std::to_string(i % 50), "Company" + std::to_string(i % 3) });
+    cache.cancelOrdersForUser("User7");
+    done = true;
+    reader.join();
+
+    replica.sync();
+    ASSERT_EQ(replica.size(), cache.size());
+    for (unsigned int i = 0; i < 10; i++) {
+        std::string securityId = "SecId" + std::to_string(i);
+        ASSERT_EQ(replica.getMatchingSizeForSecurity(securityId), cache.getMatchingSizeForSecurity(securityId));
+    }
+    ASSERT_EQ(replica.staleness().overflowMutations, 0u);
+
+    // full queue (2 mutations): the primary spills the mutations (never waits), applied in order
+    OrderCache primary;
+    primary.setVerbose(false);
+    OrderCacheReplica spilling(primary, 2);
+    for (unsigned int i = 0; i < 20000; i++)
+        primary.addOrder(Order{ "X" + std::to_string(i), "SecId" + std::to_string(i % 10), i % 2 ? "Buy" : "Sell", 10 + i % 7, "User" + std::to_string(i % 50), "Company" + std::to_string(i % 3) });
+    primary.cancelOrdersForUser("User7");
+    spilling.sync();
+    ASSERT_GT(spilling.staleness().overflowMutations, 0u);
+    ASSERT_EQ(spilling.staleness().pendingMutations, 0u);
+    ASSERT_EQ(spilling.size(), primary.size());
+    for (unsigned int i = 0; i < 10; i++) {
+        std::string securityId = "SecId" + std::to_string(i);
+        ASSERT_EQ(spilling.getMatchingSizeForSecurity(securityId), primary.getMatchingSizeForSecurity(securityId));
+    }
+}
+
+
+// Extended Test 13: minimum quantity scan (1% of a 1M orders security qualifies)
+TEST_F(OrderCacheTest, X13_PerformanceTest_MinimumQtyScan) {
+    const unsigned int size = 1000000;
+    cache.setVerbose(false);
+
+    debug::timer_start start;
+    utils::osyncstream out;
+
+    // single side (no matching): quantities from 1 to 10000 lots
+    start = debug::TestUtils::tic();
+    for (unsigned int i = 0; i < size; i++)
+        cache.addOrder(Order{ std::to_string(i), "SecId1", "Buy", 1 + i % 10000, "User" + std::to_string(i % 100), "CompanyA" });
+    debug::TestUtils::toc(out, start, "adding 1M orders time: ");
+    ASSERT_EQ(cache.size(), size);
+
+    // vectorized quantities scan, copies only the qualifying orders (1%)
+    start = debug::TestUtils::tic();
+    auto qualifying = cache.getOrdersForSecIdWithMinimumQty("SecId1", 9901);
+    debug::TestUtils::toc(out, start, "minimum quantity orders (1%) time: ");
+    ASSERT_EQ(qualifying.size(), size / 100);
+    for (auto& orderId : qualifying)
+        ASSERT_GE(cache.getOrder(orderId).qty(), 9901);
+    ASSERT_TRUE(std::is_sorted(qualifying.begin(), qualifying.end(), [&](auto& a, auto& b) { 
+        return cache.getOrder(a).qty() < cache.getOrder(b).qty(); }));
+    
+    ASSERT_EQ(cache.getOrdersForSecIdWithMinimumQty("SecId1", 10001).size(), 0);
+    ASSERT_EQ(cache.getOrdersForSecIdWithMinimumQty("SecId2", 0).size(), 0);
+
+    // baseline style scan: visits every order of the book
+    start = debug::TestUtils::tic();
+    size_t scanned = 0;
+    for (auto& order : cache.getAllOrders())
+        if (order.securityId() == "SecId1" && order.qty() >= 9901)
+            scanned++;
+    debug::TestUtils::toc(out, start, "baseline scan minimum quantity orders (1%) time: ");
+    ASSERT_EQ(scanned, size / 100);
+
+    start = debug::TestUtils::tic();
+    cache.cancelOrdersForSecIdWithMinimumQty("SecId1", 9901);
+    debug::TestUtils::toc(out, start, "cancel minimum quantity orders (1%) time: ");
+    ASSERT_EQ(cache.size(), size - size / 100);
+    ASSERT_FALSE(cache.exists("9999"));
+    ASSERT_FALSE(cache.exists("9900"));
+    ASSERT_TRUE(cache.exists("9899"));
+    ASSERT_EQ(cache.getOrdersForSecIdWithMinimumQty("SecId1", 9901).size(), 0);
+    ASSERT_EQ(cache.getOrdersForSecIdWithMinimumQty("SecId1", 9900).size(), size / 10000);
+}
+
+
+// Extended Test 14: mass cancel with a single compaction pass (50k user orders in a 1M orders security)
+TEST_F(OrderCacheTest, X14_PerformanceTest_BulkCancelCompaction) {
+    const unsigned int size = 1000000;
+    cache.setVerbose(false);
+
+    debug::timer_start start;
+    utils::osyncstream out;
+
+    // single side (no matching): every 20th order from "UserX"
+    for (unsigned int i = 0; i < size; i++)
+        cache.addOrder(Order{ std::to_string(i), "SecId1", "Buy", 100, i % 20 ? "User" + std::to_string(i % 100) : "UserX", "CompanyA" });
+    ASSERT_EQ(cache.size(), size);
+
+    start = debug::TestUtils::tic();
+    cache.cancelOrdersForUser("UserX");
+    debug::TestUtils::toc(out, start, "cancel 50k user orders time: ");
+    ASSERT_EQ(cache.size(), size - size / 20);
+    ASSERT_FALSE(cache.exists("0"));
+    ASSERT_FALSE(cache.exists("20"));
+    ASSERT_TRUE(cache.exists("21"));
+    ASSERT_EQ(cache.getOrdersForSecIdWithMinimumQty("SecId1", 0).size(), size - size / 20);
+    ASSERT_EQ(cache.memoryReport().structures["_userOrdersIndex"].elements, 95u); // "UserX" entry released
+
+    // counterparties keep the arrival ordering: "0" was cancelled, "1" is the first to trade
+    cache.addOrder(Order{ "Sell1", "SecId1", "Sell", 150, "User1", "CompanyB" });
+    ASSERT_EQ(cache.getMatchingSizeForSecurity("SecId1"), 150);
+    ASSERT_EQ(cache.getOrder("1").workingQty(), 0);
+    ASSERT_EQ(cache.getOrder("2").workingQty(), 50);
+
+    // minimum quantity cancel (bulk): all remaining orders
+    cache.cancelOrdersForSecIdWithMinimumQty("SecId1", 100);
+    ASSERT_EQ(cache.size(), 0);
+}
+
+
+// Extended Test 15: company "kill switch" (1M orders per company)
+TEST_F(OrderCacheTest, X15_PerformanceTest_CancelOrdersForCompany) {
+    const unsigned int size = 1000000;
+    cache.setVerbose(false);
+
+    debug::timer_start start;
+    utils::osyncstream out;
+
+    // CompanyA: 1M buy orders over 100 securities and 1000 users
+    for (unsigned int i = 0; i < size; i++)
+        cache.addOrder(Order{ "A" + std::to_string(i), "SecId" + std::to_string(i % 100), "Buy", 100, "User" + std::to_string(i % 1000), "CompanyA" });
+    // CompanyB: sell orders matched by CompanyA orders
+    for (unsigned int i = 0; i < 100; i++)
+        cache.addOrder(Order{ "B" + std::to_string(i), "SecId" + std::to_string(i), "Sell", 50, "UserB", "CompanyB" });
+    // CompanyB working order (no counterparty: same company only)
+    cache.addOrder(Order{ "BW", "SecId1", "Buy", 100, "UserB", "CompanyB" });
+    ASSERT_EQ(cache.size(), size + 101);
+    ASSERT_EQ(cache.getMatchingSizeForSecurity("SecId1"), 50);
+    ASSERT_EQ(cache.getOrder("BW").workingQty(), 100);
+
+    start = debug::TestUtils::tic();
+    cache.cancelOrdersForCompany("CompanyA");
+    debug::TestUtils::toc(out, start, "cancel 1M company orders time: ");
+    ASSERT_EQ(cache.size(), 101);
+    ASSERT_FALSE(cache.exists("A0"));
+    ASSERT_TRUE(cache.exists("B0"));
+    ASSERT_EQ(cache.getOrdersForSecIdWithMinimumQty("SecId1", 0).size(), 2);
+
+    // unknown (or already cancelled) company: nothing to do
+    cache.cancelOrdersForCompany("CompanyA");
+    ASSERT_EQ(cache.size(), 101);
+
+    // CompanyB orders still trade with new counterparties
+    const unsigned int matched = cache.getMatchingSizeForSecurity("SecId1");
+    cache.addOrder(Order{ "C1", "SecId1", "Sell", 100, "UserC", "CompanyC" });
+    ASSERT_EQ(cache.getMatchingSizeForSecurity("SecId1"), matched + 100);
+    ASSERT_EQ(cache.getOrder("BW").workingQty(), 0);
+    cache.cancelOrdersForCompany("CompanyB");
+    ASSERT_EQ(cache.size(), 1);
+}
+
+
+// Extended Test 16: deferred deletion (tombstones and epoch based reclamation)
+TEST_F(OrderCacheTest, X16_ExtensionsTest_DeferredDeletion) {
+    cache.setDeferredDeletion(true);
+    ASSERT_TRUE(cache.deferredDeletion());
+
+    cache.addOrder(Order{"OrdId1", "SecId1", "Buy", 1000, "User1", "CompanyA"});
+    cache.addOrder(Order{"OrdId2", "SecId2", "Sell", 3000, "User2", "CompanyB"});
+    cache.addOrder(Order{"OrdId3", "SecId1", "Sell", 500, "User3", "CompanyA"});
+    cache.addOrder(Order{"OrdId4", "SecId2", "Sell", 600, "User4", "CompanyC"});
+
+    {
+        // pinned reader: the cancelled order reference stays valid
+        auto guard = cache.pinOrders();
+        const Order& order = cache.getOrder("OrdId2");
+
+        cache.cancelOrder("OrdId2");
+        ASSERT_FALSE(cache.exists("OrdId2"));
+        ASSERT_EQ(cache.size(), 3);
+        ASSERT_EQ(cache.getAllOrders().size(), 3);
+
+        std::this_thread::sleep_for(std::chrono::microseconds(5 * RECLAIM_INTERVAL_US));
+        ASSERT_EQ(cache.pendingReclaims(), 1);
+        ASSERT_EQ(cache.reclaimOrders(), 0);
+        ASSERT_TRUE(order.cancelled());
+        ASSERT_EQ(order.orderId(), "OrdId2");
+        ASSERT_EQ(order.qty(), 3000);
+
+        // a copy of the tombstone is added to another cache as a working order
+        OrderCache other;
+        other.setVerbose(false);
+        other.addOrder(order);
+        other.addOrder(Order{"OrdId9", "SecId2", "Buy", 100, "User9", "CompanyD"});
+        ASSERT_FALSE(other.getOrder("OrdId2").cancelled());
+        ASSERT_EQ(other.getMatchingSizeForSecurity("SecId2"), 100);
+
+        // tombstoned orders are skipped by matching (and the identifier can be reused)
+        cache.addOrder(Order{"OrdId5", "SecId2", "Buy", 500, "User5", "CompanyD"});
+        ASSERT_EQ(cache.getMatchingSizeForSecurity("SecId2"), 500);
+        ASSERT_EQ(cache.getOrder("OrdId4").workingQty(), 100);
+        cache.addOrder(Order{"OrdId2", "SecId2", "Sell", 10, "User2", "CompanyB"});
+        ASSERT_EQ(cache.getOrdersForSecIdWithMinimumQty("SecId2", 1000).size(), 0);
+        cache.cancelOrdersForSecIdWithMinimumQty("SecId2", 1000);
+        ASSERT_TRUE(cache.exists("OrdId2"));
+    }
+
+    // released by the background reclamation
+    for (unsigned int i = 0; i < 1000 && cache.pendingReclaims(); i++)
+        std::this_thread::sleep_for(std::chrono::microseconds(RECLAIM_INTERVAL_US));
+    ASSERT_EQ(cache.pendingReclaims(), 0);
+
+    // mass cancels
+    cache.cancelOrdersForUser("User2");
+    cache.cancelOrdersForCompany("CompanyA");
+    ASSERT_EQ(cache.size(), 2);
+    cache.setDeferredDeletion(false);
+    ASSERT_EQ(cache.pendingReclaims(), 0);
+    ASSERT_EQ(cache.memoryReport().structures["_orders"].elements, 2);
+    ASSERT_EQ(cache.getOrdersForSecIdWithMinimumQty("SecId2", 0).size(), 2);
+
+    // mass cancels skip the tombstones left on the user and security indexes (reused identifier)
+    OrderCache tombstones;
+    tombstones.setVerbose(false);
+    tombstones.setDeferredDeletion(true);
+    {
+        auto guard = tombstones.pinOrders();
+        for (unsigned int i = 0; i < 4 * RECLAIM_BATCH_SIZE; i++)
+            tombstones.addOrder(Order{"T" + std::to_string(i), "SecId1", "Buy", 100, "User7", "CompanyA"});
+        for (unsigned int i = 0; i < 4 * RECLAIM_BATCH_SIZE; i++)
+            tombstones.cancelOrder("T" + std::to_string(i));
+        tombstones.addOrder(Order{"T0", "SecId1", "Buy", 100, "User8", "CompanyA"});
+        tombstones.cancelOrdersForUser("User7");
+        tombstones.cancelOrdersForSecIdWithMinimumQty("SecId1", 200);
+        ASSERT_TRUE(tombstones.exists("T0"));
+        ASSERT_EQ(tombstones.pendingReclaims(), 4 * RECLAIM_BATCH_SIZE);
+        ASSERT_EQ(tombstones.memoryReport().structures["_tombstones"].elements, 4 * RECLAIM_BATCH_SIZE);
+        ASSERT_GT(tombstones.memoryReport().structures["_tombstones"].allocatedBytes, 0u);
+    }
+
+    // bounded reclamation passes
+    ASSERT_LE(tombstones.reclaimOrders(), RECLAIM_BATCH_SIZE);
+    for (unsigned int i = 0; i < 1000 && tombstones.pendingReclaims(); i++)
+        std::this_thread::sleep_for(std::chrono::microseconds(RECLAIM_INTERVAL_US));
+    ASSERT_EQ(tombstones.pendingReclaims(), 0);
+    ASSERT_EQ(tombstones.size(), 1);
+    ASSERT_EQ(tombstones.getOrdersForSecIdWithMinimumQty("SecId1", 0).size(), 1);
+    tombstones.cancelOrdersForSecIdWithMinimumQty("SecId1", 0);
+    ASSERT_EQ(tombstones.size(), 0);
+
+    // single cancels latency (synchronous vs deferred deletion, background reclamation running)
+    const unsigned int size = 100000;
+    utils::osyncstream out;
+    for (bool deferred : { false, true }) {
+        OrderCache latency;
+        latency.setVerbose(false);
+        latency.setDeferredDeletion(deferred);
+        for (unsigned int i = 0; i < size; i++)
+            latency.addOrder(Order{"L" + std::to_string(i), "SecId" + std::to_string(i % 20), "Buy", 1 + i % 100,
+                "User" + std::to_string(i % 50), "Company" + std::to_string(i % 7)});
+        debug::LatencyHistogram cancels;
+        for (unsigned int i = 0; i < size; i += 2) {
+            debug::timer_start start = debug::TestUtils::tic();
+            latency.cancelOrder("L" + std::to_string(i));
+            cancels.record(start);
+        }
+        latency.setDeferredDeletion(false);
+        ASSERT_EQ(latency.size(), size / 2);
+        ASSERT_EQ(latency.pendingReclaims(), 0);
+        out << (deferred ? "cancel latency (deferred deletion): " : "cancel latency (synchronous deletion): ") << cancels.str() << '\n';
+    }
+}
+
+
+// Extended Test 17: in place order amend (quantity reduce/increase)
+TEST_F(OrderCacheTest, X17_ExtensionsTest_AmendOrder) {
+    OrderCacheReplica replica(cache);
+    ASSERT_EQ(cache.amendPolicy(), AmendPolicy::LosePriority);
+
+    // reduce: in place, the filled lots cannot be undone
+    cache.addOrder(Order{"OrdId1", "SecId1", "Buy", 1000, "User1", "CompanyA"});
+    cache.addOrder(Order{"OrdId2", "SecId1", "Sell", 300, "User2", "CompanyB"});
+    cache.amendOrder("OrdId1", 500);
+    ASSERT_EQ(cache.getOrder("OrdId1").qty(), 500);
+    ASSERT_EQ(cache.getOrder("OrdId1").workingQty(), 200);
+    cache.amendOrder("OrdId1", 100);
+    ASSERT_EQ(cache.getOrder("OrdId1").qty(), 300);
+    ASSERT_TRUE(cache.getOrder("OrdId1").isFilled());
+    ASSERT_EQ(cache.getMatchingSizeForSecurity("SecId1"), 300);
+
+    // increase: matches the additional lots only
+    cache.addOrder(Order{"OrdId3", "SecId1", "Buy", 1000, "User3", "CompanyC"});
+    cache.amendOrder("OrdId2", 800);
+    ASSERT_EQ(cache.getOrder("OrdId2").workingQty(), 0);
+    ASSERT_EQ(cache.getOrder("OrdId3").workingQty(), 500);
+    ASSERT_EQ(cache.getMatchingSizeForSecurity("SecId1"), 800);
+    ASSERT_EQ(cache.getOrdersForSecIdWithMinimumQty("SecId1", 800).size(), 2);
+
+    // increase loses priority (default)
+    cache.addOrder(Order{"OrdId4", "SecId2", "Sell", 100, "User4", "CompanyB"});
+    cache.addOrder(Order{"OrdId5", "SecId2", "Sell", 100, "User5", "CompanyC"});
+    cache.amendOrder("OrdId4", 200);
+    cache.addOrder(Order{"OrdId6", "SecId2", "Buy", 100, "User6", "CompanyD"});
+    ASSERT_EQ(cache.getOrder("OrdId4").workingQty(), 200);
+    ASSERT_EQ(cache.getOrder("OrdId5").workingQty(), 0);
+
+    // increase keeps priority
+    cache.setAmendPolicy(AmendPolicy::KeepPriority);
+    cache.addOrder(Order{"OrdId7", "SecId3", "Sell", 100, "User7", "CompanyB"});
+    cache.addOrder(Order{"OrdId8", "SecId3", "Sell", 100, "User8", "CompanyC"});
+    cache.amendOrder("OrdId7", 200);
+    cache.addOrder(Order{"OrdId9", "SecId3", "Buy", 100, "User9", "CompanyD"});
+    ASSERT_EQ(cache.getOrder("OrdId7").workingQty(), 100);
+    ASSERT_EQ(cache.getOrder("OrdId8").workingQty(), 100);
+
+    // 0 cancels, unknown orders are ignored
+    cache.amendOrder("OrdId9", 0);
+    ASSERT_FALSE(cache.exists("OrdId9"));
+    cache.amendOrder("OrdId10", 100);
+    ASSERT_EQ(cache.size(), 8);
+
+    // replicated
+    replica.sync();
+    ASSERT_EQ(replica.size(), 8);
+    for (auto& securityId : { "SecId1", "SecId2", "SecId3" })
+        ASSERT_EQ(replica.getMatchingSizeForSecurity(securityId), cache.getMatchingSizeForSecurity(securityId));
+}
+
+
+// Extended Test 18: numeric order identifiers (direct indexed table) x string identifiers (hash index)
+TEST_F(OrderCacheTest, X18_PerformanceTest_NumericOrderIds) {
+    const unsigned int size = 200000;
+    const uint64_t firstId = 7000000000ull;
+
+    debug::timer_start start;
+    utils::osyncstream out;
+
+    OrderCache numeric;
+    numeric.setVerbose(false);
+    numeric.setNumericOrderIds(true);
+    ASSERT_TRUE(numeric.numericOrderIds());
+    cache.setVerbose(false);
+
+    std::vector<std::string> ids(size);
+    for (unsigned int i = 0; i < size; i++)
+        ids[i] = std::to_string(firstId + i);
+
+    auto fill = [&](OrderCache& target) {
+        for (unsigned int i = 0; i < size; i++)
+            target.addOrder(Order{ ids[i], "SecId" + std::to_string(i % 100), "Buy", 100, "User" + std::to_string(i % 100), "CompanyA" });
+    };
+    auto lookup = [&](OrderCache& target) {
+        unsigned int found = 0;
+        for (unsigned int i = 0; i < size; i++)
+            found += target.exists(ids[(i * 7919u) % size]);
+        return found;
+    };
+    auto cancel = [&](OrderCache& target) {
+        for (unsigned int i = 0; i < size; i += 2)
+            target.cancelOrder(ids[i]);
+    };
+
+    fill(cache);
+    fill(numeric);
+    ASSERT_EQ(numeric.size(), size);
+
+    start = debug::TestUtils::tic();
+    ASSERT_EQ(lookup(cache), size);
+    debug::TestUtils::toc(out, start, "string ids lookup time: ");
+    start = debug::TestUtils::tic();
+    ASSERT_EQ(lookup(numeric), size);
+    debug::TestUtils::toc(out, start, "numeric ids lookup time: ");
+
+    start = debug::TestUtils::tic();
+    cancel(cache);
+    debug::TestUtils::toc(out, start, "string ids cancel time: ");
+    start = debug::TestUtils::tic();
+    cancel(numeric);
+    debug::TestUtils::toc(out, start, "numeric ids cancel time: ");
+
+    ASSERT_EQ(numeric.size(), size / 2);
+    ASSERT_FALSE(numeric.exists(ids[0]));
+    ASSERT_TRUE(numeric.exists(ids[1]));
+    ASSERT_EQ(numeric.getOrder(ids[1]).orderId(), ids[1]);
+
+    // non canonical and out of range identifiers use the hash index
+    numeric.addOrder(Order{ "0" + ids[1], "SecId1", "Sell", 10, "User1", "CompanyB" });
+    numeric.addOrder(Order{ "42", "SecId1", "Sell", 10, "User1", "CompanyB" });
+    numeric.addOrder(Order{ "OrdId1", "SecId1", "Sell", 10, "User1", "CompanyB" });
+    numeric.addOrder(Order{ ids[1], "SecId1", "Sell", 10, "User1", "CompanyB" }); // duplicated
+    ASSERT_EQ(numeric.size(), size / 2 + 3);
+    ASSERT_EQ(numeric.getOrder(ids[1]).side(), "Buy");
+    ASSERT_EQ(numeric.getOrder("0" + ids[1]).side(), "Sell");
+    ASSERT_EQ(numeric.memoryReport().structures["_numericOrderIndex"].elements, size / 2);
+    numeric.cancelOrdersForUser("User1");
+    ASSERT_FALSE(numeric.exists("42"));
+    ASSERT_FALSE(numeric.exists(ids[1]));
+
+    // mode is only changed on empty caches
+    numeric.setNumericOrderIds(false);
+    ASSERT_TRUE(numeric.numericOrderIds());
+}
+
+
+// Extended Test 19: vectorized matching (side book arrays, each supported kernel) vs orders walk
+TEST_F(OrderCacheTest, X19_PerformanceTest_VectorizedMatching) {
+    const unsigned int size = 100000;
+
+    debug::timer_start start;
+    utils::osyncstream out;
+    out << "matching kernel: " << OrderCache::matchingKernel() << '\n';
+
+    // restores the default kernel (process wide)
+    struct KernelGuard {
+        std::string name = OrderCache::matchingKernel();
+        ~KernelGuard() { OrderCache::setMatchingKernel(name); }
+    } guard;
+    ASSERT_FALSE(OrderCache::setMatchingKernel("sse2"));
+    ASSERT_EQ(guard.name, OrderCache::matchingKernel());
+
+    OrderCache walk;
+    walk.setVerbose(false);
+    walk.setVectorizedMatching(false);
+    ASSERT_TRUE(cache.vectorizedMatching());
+    ASSERT_FALSE(walk.vectorizedMatching());
+
+    // random mixed flow (with amends and cancels): same fills on both caches
+    std::mt19937 rng(19);
+    std::vector<Order> flow;
+    flow.reserve(size);
+    for (unsigned int i = 0; i < size; i++)
+        flow.push_back(Order{ "OrdId" + std::to_string(i), "SecId" + std::to_string(rng() % 4), rng() % 2 ? "Buy" : "Sell", 
+            1 + (unsigned int)(rng() % 100), "User" + std::to_string(rng() % 50), "Company" + std::to_string(rng() % 8) });
+
+    auto run = [&](OrderCache& target) {
+        for (unsigned int i = 0; i < size; i++) {
+            target.addOrder(flow[i]);
+            if (i % 97 == 0)
+                target.cancelOrder("OrdId" + std::to_string(i / 2));
+            if (i % 89 == 0)
+                target.amendOrder("OrdId" + std::to_string(i / 3), 150);
+        }
+    };
+
+    // sweep: large orders against many small counterparties
+    OrderCache sweepWalk;
+    sweepWalk.setVerbose(false);
+    sweepWalk.setVectorizedMatching(false);
+    auto sweepBook = [&](OrderCache& target) {
+        for (unsigned int i = 0; i < size; i++)
+            target.addOrder(Order{ "S" + std::to_string(i), "SecId1", "Sell", 1 + i % 10, "User1", "Company" + std::to_string(i % 8) });
+    };
+    auto sweepRun = [&](OrderCache& target) {
+        for (unsigned int i = 0; i < 100; i++)
+            target.addOrder(Order{ "B" + std::to_string(i), "SecId1", "Buy", 5000, "User2", "Company" + std::to_string(i % 8) });
+    };
+
+    start = debug::TestUtils::tic();
+    run(walk);
+    debug::TestUtils::toc(out, start, "orders walk time: ");
+    sweepBook(sweepWalk);
+    start = debug::TestUtils::tic();
+    sweepRun(sweepWalk);
+    debug::TestUtils::toc(out, start, "sweep orders walk time: ");
+    ASSERT_EQ(sweepWalk.getMatchingSizeForSecurity("SecId1"), 500000u);
+
+    // every kernel supported by the build host (not only the default one)
+    size_t kernels = 0;
+    for (const char* kernel : { "scalar", "avx2", "avx512" }) {
+        if (!OrderCache::setMatchingKernel(kernel)) {
+            out << kernel << " kernel: not supported\n";
+            continue;
+        }
+        ASSERT_STREQ(OrderCache::matchingKernel(), kernel);
+        kernels++;
+
+        OrderCache vectorized;
+        vectorized.setVerbose(false);
+        start = debug::TestUtils::tic();
+        run(vectorized);
+        debug::TestUtils::toc(out, start, std::string(kernel) + " vectorized scan time: ");
+
+        ASSERT_EQ(vectorized.size(), walk.size());
+        for (unsigned int i = 0; i < 4; i++)
+            ASSERT_EQ(vectorized.getMatchingSizeForSecurity("SecId" + std::to_string(i)), walk.getMatchingSizeForSecurity("SecId" + std::to_string(i)));
+        for (const Order& order : walk.getAllOrders())
+            ASSERT_EQ(vectorized.getOrder(order.orderId()).workingQty(), order.workingQty());
+
+        OrderCache sweep;
+        sweep.setVerbose(false);
+        sweepBook(sweep);
+        start = debug::TestUtils::tic();
+        sweepRun(sweep);
+        debug::TestUtils::toc(out, start, std::string(kernel) + " sweep vectorized scan time: ");
+
+        ASSERT_EQ(sweep.getMatchingSizeForSecurity("SecId1"), sweepWalk.getMatchingSizeForSecurity("SecId1"));
+        for (unsigned int i = 0; i < size; i += 101)
+            ASSERT_EQ(sweep.getOrder("S" + std::to_string(i)).workingQty(), sweepWalk.getOrder("S" + std::to_string(i)).workingQty());
+    }
+    ASSERT_GE(kernels, 1u);
+}
+
+// Extended Test 20: minimum quantity cancels - vectorized quantities scan (selective and range cancels)
+TEST_F(OrderCacheTest, X20_PerformanceTest_VectorizedMinimumQtyCancel) {
+    const unsigned int size = 200000;
+
+    debug::timer_start start;
+    utils::osyncstream out;
+
+    // restores the default kernel (process wide)
+    struct KernelGuard {
+        std::string name = OrderCache::matchingKernel();
+        ~KernelGuard() { OrderCache::setMatchingKernel(name); }
+    } guard;
+
+    // every filter kernel supported by the build host (not only the default one)
+    for (const char* kernel : { "scalar", "avx2", "avx512" }) {
+        if (!OrderCache::setMatchingKernel(kernel)) {
+            out << kernel << " kernel: not supported\n";
+            continue;
+        }
+
+        OrderCache target;
+        target.setVerbose(false);
+        target.setMultiThread(false);
+
+        std::mt19937 rng(20);
+        std::vector<unsigned int> quantities(size);
+        for (unsigned int i = 0; i < size; i++) {
+            quantities[i] = 1 + (unsigned int)(rng() % 1000);
+            target.addOrder(Order{ "OrdId" + std::to_string(i), i % 10 ? "SecId1" : "SecId2", i % 2 ? "Buy" : "Sell", quantities[i], "User" + std::to_string(i % 100), "Company" + std::to_string(i % 7) });
+        }
+
+        // keeps the quantities in sync (amends and single cancels)
+        for (unsigned int i = 1; i < size; i += 1000) {
+            target.amendOrder("OrdId" + std::to_string(i), 2000);
+            quantities[i] = std::max(2000u, target.getOrder("OrdId" + std::to_string(i)).filledQty());
+            target.cancelOrder("OrdId" + std::to_string(i + 2));
+            quantities[i + 2] = 0;
+        }
+
+        auto expected = [&](const std::string& securityId, unsigned int minQty) {
+            size_t count = 0;
+            for (unsigned int i = 0; i < size; i++)
+                count += quantities[i] && (i % 10 ? "SecId1" : "SecId2") == securityId && quantities[i] >= minQty;
+            return count;
+        };
+
+        // selective cancel
+        const size_t amended = expected("SecId1", 1500);
+        ASSERT_EQ(target.getOrdersForSecIdWithMinimumQty("SecId1", 1500).size(), amended);
+        const size_t before = target.size();
+        start = debug::TestUtils::tic();
+        target.cancelOrdersForSecIdWithMinimumQty("SecId1", 1500);
+        debug::TestUtils::toc(out, start, std::string(kernel) + " selective cancel (vectorized scan) time: ");
+        ASSERT_EQ(target.size(), before - amended);
+        for (unsigned int i = 0; i < size; i++)
+            if (i % 10 && quantities[i] >= 1500)
+                quantities[i] = 0;
+
+        // range cancel: vectorized scan
+        const size_t range = expected("SecId1", 100);
+        ASSERT_GT(range, size / 2);
+        start = debug::TestUtils::tic();
+        target.cancelOrdersForSecIdWithMinimumQty("SecId1", 100);
+        debug::TestUtils::toc(out, start, std::string(kernel) + " range cancel (vectorized scan) time: ");
+        ASSERT_EQ(target.size(), before - amended - range);
+        ASSERT_TRUE(target.getOrdersForSecIdWithMinimumQty("SecId1", 100).empty());
+        ASSERT_EQ(target.getOrdersForSecIdWithMinimumQty("SecId1", 1).size(), expected("SecId1", 1) - range);
+        ASSERT_EQ(target.getOrdersForSecIdWithMinimumQty("SecId2", 1).size(), expected("SecId2", 1));
+
+        // remaining orders are still cancelled by the scan
+        target.cancelOrdersForSecIdWithMinimumQty("SecId1", 0);
+        ASSERT_EQ(target.size(), expected("SecId2", 1));
+        target.cancelOrdersForSecIdWithMinimumQty("SecId2", 0);
+        ASSERT_EQ(target.size(), 0u);
+    }
+}
+
+// Extended Test 21: low jitter configuration (pre-sized arena, prefaulted and locked)
+TEST_F(OrderCacheTest, X21_PerformanceTest_MemoryArena) {
+    const unsigned int size = 100000;
+
+    debug::timer_start start;
+    utils::osyncstream out;
+
+    OrderCache heap;
+    heap.setVerbose(false);
+    cache.setVerbose(false);
+    ASSERT_TRUE(cache.reserveArena(256ull << 20));
+    ASSERT_FALSE(cache.reserveArena(256ull << 20)); // reserved once
+
+    ArenaReport report = cache.arenaReport();
+    ASSERT_NE(report.pages, "none");
+    ASSERT_EQ(report.reservedBytes, 256ull << 20);
+    out << report.str();
+
+    auto run = [&](OrderCache& target) {
+        for (unsigned int i = 0; i < size; i++)
+            target.addOrder(Order{ "OrdId" + std::to_string(i), "SecId" + std::to_string(i % 50), i % 2 ? "Buy" : "Sell", 
+                1 + i % 100, "User" + std::to_string(i % 100), "Company" + std::to_string(i % 7) });
+        for (unsigned int i = 0; i < size; i += 3)
+            target.cancelOrder("OrdId" + std::to_string(i));
+        target.cancelOrdersForUser("User1");
+        target.cancelOrdersForSecIdWithMinimumQty("SecId2", 10);
+    };
+
+    start = debug::TestUtils::tic();
+    run(heap);
+    debug::TestUtils::toc(out, start, "heap session time: ");
+    cache.startSession();
+    start = debug::TestUtils::tic();
+    run(cache);
+    debug::TestUtils::toc(out, start, "arena session time: ");
+
+    report = cache.arenaReport();
+    out << report.str();
+    ASSERT_GT(report.usedBytes, 0u);
+    ASSERT_EQ(report.fallbacks, 0u);
+    ASSERT_EQ(cache.size(), heap.size());
+    for (unsigned int i = 0; i < 50; i++)
+        ASSERT_EQ(cache.getMatchingSizeForSecurity("SecId" + std::to_string(i)), heap.getMatchingSizeForSecurity("SecId" + std::to_string(i)));
+
+    // only on empty caches
+    ASSERT_FALSE(heap.reserveArena(1 << 20));
+    ASSERT_EQ(heap.arenaReport().pages, "none");
+
+    // order strings longer than the SSO buffer stay on the heap (reported)
+    ASSERT_EQ(report.stringHeapBytes, 0u);
+    cache.addOrder(Order{ "OrdId-" + std::string(64, 'L'), "SecId1", "Buy", 10, "User1", "Company1" });
+    report = cache.arenaReport();
+    ASSERT_GE(report.stringHeapBytes, 70u);
+    ASSERT_EQ(report.stringHeapOrders, 1u);
+
+    // over-aligned types bypass the arena (blocks aligned to "memory_arena::ALIGNMENT" only)
+    struct alignas(64) cache_line { char bytes[64]; };
+    utils::memory_arena arena;
+    ASSERT_TRUE(arena.reserve(1 << 20, false));
+    utils::memory_counter counter;
+    counter.arena = &arena;
+    {
+        std::vector<char, utils::tracking_allocator<char>> small{ utils::tracking_allocator<char>(&counter) };
+        small.resize(8);
+        std::vector<cache_line, utils::tracking_allocator<cache_line>> lines{ utils::tracking_allocator<cache_line>(&counter) };
+        lines.resize(3);
+        ASSERT_TRUE(arena.owns(small.data()));
+        ASSERT_FALSE(arena.owns(lines.data()));
+        ASSERT_EQ((uintptr_t)lines.data() % alignof(cache_line), 0u);
+        ASSERT_EQ(counter.bytes.load(), 8 + 3 * sizeof(cache_line));
+    }
+    ASSERT_EQ(counter.bytes.load(), 0u);
+}
+
+// Extended Test 22: lazy matching (dirty securities) vs matching at insertion
+TEST_F(OrderCacheTest, X22_PerformanceTest_LazyMatching) {
+    const unsigned int size = 100000;
+
+    debug::timer_start start;
+    utils::osyncstream out;
+
+    OrderCache eager;
+    eager.setVerbose(false);
+    cache.setVerbose(false);
+    cache.setMatchingMode(MatchingMode::Lazy);
+    ASSERT_EQ(cache.matchingMode(), MatchingMode::Lazy);
+
+    // random flow with queries, amends and cancels: same fills on both modes
+    std::mt19937 rng(22);
+    std::vector<Order> flow;
+    flow.reserve(size);
+    for (unsigned int i = 0; i < size; i++)
+        flow.push_back(Order{ "OrdId" + std::to_string(i), "SecId" + std::to_string(rng() % 20), rng() % 2 ? "Buy" : "Sell",
+            1 + (unsigned int)(rng() % 100), "User" + std::to_string(rng() % 50), "Company" + std::to_string(rng() % 5) });
+
+    std::vector<unsigned int> eagerSizes, lazySizes;
+    auto run = [&](OrderCache& target, std::vector<unsigned int>& sizes) {
+        for (unsigned int i = 0; i < size; i++) {
+            target.addOrder(flow[i]);
+            if (i % 101 == 0)
+                target.cancelOrder("OrdId" + std::to_string(i / 2));
+            if (i % 89 == 0)
+                target.amendOrder("OrdId" + std::to_string(i / 3), 150);
+            if (i % 5003 == 0)
+                target.cancelOrdersForUser("User" + std::to_string(i % 50));
+            if (i % 37 == 0) // queries on a few (busy) securities only
+                sizes.push_back(target.getMatchingSizeForSecurity("SecId" + std::to_string(i % 3)));
+        }
+    };
+
+    start = debug::TestUtils::tic();
+    run(eager, eagerSizes);
+    debug::TestUtils::toc(out, start, "matching at insertion time: ");
+    start = debug::TestUtils::tic();
+    run(cache, lazySizes);
+    debug::TestUtils::toc(out, start, "lazy matching time: ");
+
+    ASSERT_EQ(lazySizes, eagerSizes);
+    ASSERT_GT(cache.pendingMatches(), 0u);
+    for (unsigned int i = 0; i < 20; i++)
+        ASSERT_EQ(cache.getMatchingSizeForSecurity("SecId" + std::to_string(i)), eager.getMatchingSizeForSecurity("SecId" + std::to_string(i)));
+    ASSERT_EQ(cache.pendingMatches(), 0u);
+    for (const Order& order : eager.getAllOrders())
+        ASSERT_EQ(cache.getOrder(order.orderId()).workingQty(), order.workingQty());
+
+    // bursts of adds on many securities, queries on a few ones only
+    OrderCache burstEager;
+    OrderCache burstLazy;
+    burstEager.setVerbose(false);
+    burstLazy.setVerbose(false);
+    burstLazy.setMatchingMode(MatchingMode::Lazy);
+    auto burst = [&](OrderCache& target) {
+        unsigned int matched = 0;
+        for (unsigned int i = 0; i < size; i++) {
+            target.addOrder(Order{ "B" + std::to_string(i), "SecId" + std::to_string(i % 100), i % 3 ? "Buy" : "Sell",
+                1 + i % 100, "User1", "Company" + std::to_string(i % 7) });
+            if (i % 1000 == 999)
+                matched += target.getMatchingSizeForSecurity("SecId" + std::to_string(i % 5));
+        }
+        return matched;
+    };
+
+    start = debug::TestUtils::tic();
+    const unsigned int burstEagerMatched = burst(burstEager);
+    debug::TestUtils::toc(out, start, "bursts - matching at insertion time: ");
+    start = debug::TestUtils::tic();
+    const unsigned int burstLazyMatched = burst(burstLazy);
+    debug::TestUtils::toc(out, start, "bursts - lazy matching time: ");
+    ASSERT_EQ(burstLazyMatched, burstEagerMatched);
+
+    // queries on clean securities share the read lock (atomic query counters)
+    const unsigned int expected = eager.getMatchingSizeForSecurity("SecId0");
+    const size_t queries = cache.matchingStats().securities["SecId0"].queries;
+    std::atomic<size_t> mismatches{ 0 };
+    std::vector<std::thread> readers;
+    for (unsigned int t = 0; t < 4; t++)
+        readers.emplace_back([&]() {
+            for (unsigned int i = 0; i < 1000; i++)
+                mismatches += cache.getMatchingSizeForSecurity("SecId0") != expected;
+        });
+    for (auto& reader : readers)
+        reader.join();
+    ASSERT_EQ(mismatches, 0u);
+    ASSERT_EQ(cache.matchingStats().securities["SecId0"].queries, queries + 4000);
+
+    // mass cancels settle the securities of the cancelled orders only
+    cache.addOrder(Order{ "A1", "SecIdA", "Buy", 10, "UserA", "CompanyX" });
+    cache.addOrder(Order{ "A2", "SecIdA", "Sell", 10, "UserB", "CompanyY" });
+    cache.addOrder(Order{ "B1", "SecIdB", "Buy", 10, "UserB", "CompanyX" });
+    cache.addOrder(Order{ "B2", "SecIdB", "Sell", 10, "UserC", "CompanyY" });
+    ASSERT_EQ(cache.pendingMatches(), 4u);
+    cache.cancelOrdersForUser("UserA");
+    ASSERT_EQ(cache.pendingMatches(), 2u);
+    ASSERT_EQ(cache.getOrder("A2").workingQty(), 0u);
+    ASSERT_EQ(cache.pendingMatches(), 2u);
+    cache.cancelOrdersForUser("UserB");
+    ASSERT_EQ(cache.pendingMatches(), 0u);
+    ASSERT_EQ(cache.getOrder("B2").workingQty(), 0u);
+    cache.cancelOrder("B2");
+
+    // leaving the lazy mode settles the pending orders
+    cache.addOrder(Order{ "Lazy1", "SecIdLazy", "Buy", 10, "User1", "CompanyX" });
+    cache.addOrder(Order{ "Lazy2", "SecIdLazy", "Sell", 10, "User2", "CompanyY" });
+    ASSERT_EQ(cache.pendingMatches(), 2u);
+    MemoryUsage pending = cache.memoryReport().structures["_pendingMatches"];
+    ASSERT_EQ(pending.elements, 2u);
+    ASSERT_GE(pending.allocatedBytes, 2 * 2 * sizeof(uint64_t));  // order and horizon by pending order
+    cache.setMatchingMode(MatchingMode::Default);
+    ASSERT_EQ(cache.pendingMatches(), 0u);
+    ASSERT_EQ(cache.memoryReport().structures["_pendingMatches"].elements, 0u);
+    ASSERT_EQ(cache.getOrder("Lazy2").workingQty(), 0u);
+
+    // reads settle the pending orders they report (same working lots and fills of matching at "addOrder()")
+    for (MatchingMode mode : { MatchingMode::Default, MatchingMode::Lazy }) {
+        OrderCache reads;
+        reads.setVerbose(false);
+        reads.setMatchingMode(mode);
+        reads.addOrder(Order{ "R1", "SecIdR", "Buy", 100, "User1", "CompanyX" });
+        reads.addOrder(Order{ "R2", "SecIdR", "Sell", 100, "User2", "CompanyY" });
+        reads.addOrder(Order{ "R3", "SecIdS", "Buy", 100, "User1", "CompanyX" });
+        reads.addOrder(Order{ "R4", "SecIdS", "Sell", 40, "User2", "CompanyY" });
+        ASSERT_EQ(reads.getOrder("R1").workingQty(), 0u);
+        ASSERT_EQ(reads.pendingMatches(), mode == MatchingMode::Lazy ? 2u : 0u);
+        ASSERT_EQ(reads.getOrderMatchesBySecurity("SecIdS").size(), 1u);
+        ASSERT_EQ(reads.pendingMatches(), 0u);
+        reads.addOrder(Order{ "R5", "SecIdS", "Sell", 10, "User2", "CompanyY" });
+        for (const Order& order : reads.getAllOrders())
+            if (order.orderId() == "R3") {
+                ASSERT_EQ(order.workingQty(), 50u);
+            }
+        reads.addOrder(Order{ "R6", "SecIdS", "Sell", 10, "User2", "CompanyY" });
+        ASSERT_EQ(reads.getAllOrderMatches().size(), 4u);
+        reads.addOrder(Order{ "R7", "SecIdS", "Sell", 10, "User2", "CompanyY" });
+        ASSERT_EQ(reads.getOrdersChangedSince(0).orders.size(), 7u);
+        ASSERT_EQ(reads.pendingMatches(), 0u);
+        ASSERT_EQ(reads.getOrder("R3").workingQty(), 30u);
+    }
+    ASSERT_EQ(cache.getOrder("Lazy2").workingQty(), 0u);
+    ASSERT_EQ(cache.getMatchingSizeForSecurity("SecIdLazy"), 10u);
+}
+
+// Extended Test 23: adaptive matching strategy by security (adds per query, hysteresis)
+TEST_F(OrderCacheTest, X23_PerformanceTest_AdaptiveMatching) {
+    const unsigned int size = 60000;
+
+    debug::timer_start start;
+    utils::osyncstream out;
+
+    OrderCache eager;
+    eager.setVerbose(false);
+    cache.setVerbose(false);
+    cache.setMatchingMode(MatchingMode::Adaptive);
+    ASSERT_EQ(cache.matchingMode(), MatchingMode::Adaptive);
+
+    // "Hot": queried after every add, "Cold": queried once per 1000 adds,
+    // "Shift": cold on the first half, hot on the second half
+    std::vector<unsigned int> eagerSizes, adaptiveSizes;
+    auto run = [&](OrderCache& target, std::vector<unsigned int>& sizes) {
+        for (unsigned int i = 0; i < size; i++) {
+            const std::string securityId = i % 3 == 0 ? "Hot" : i % 3 == 1 ? "Cold" : "Shift";
+            target.addOrder(Order{ "OrdId" + std::to_string(i), securityId, i % 2 ? "Buy" : "Sell",
+                1 + i % 50, "User" + std::to_string(i % 10), "Company" + std::to_string(i % 4) });
+            if (i % 3 == 0 || (i % 3 == 2 && i > size / 2) || i % 3000 == 1)
+                sizes.push_back(target.getMatchingSizeForSecurity(securityId));
+            if (i % 997 == 0)
+                target.cancelOrder("OrdId" + std::to_string(i / 2));
+        }
+    };
+
+    start = debug::TestUtils::tic();
+    run(eager, eagerSizes);
+    debug::TestUtils::toc(out, start, "matching at insertion time: ");
+    start = debug::TestUtils::tic();
+    run(cache, adaptiveSizes);
+    debug::TestUtils::toc(out, start, "adaptive matching time: ");
+
+    // same fills of the matching at insertion time
+    ASSERT_EQ(adaptiveSizes, eagerSizes);
+
+    MatchingStats stats = cache.matchingStats();
+    out << stats.str();
+    ASSERT_TRUE(stats.securities["Hot"].eager);
+    ASSERT_EQ(stats.securities["Hot"].switches, 0u);
+    ASSERT_EQ(stats.securities["Hot"].lazyMatches, 0u);
+    ASSERT_FALSE(stats.securities["Cold"].eager);
+    ASSERT_GT(stats.securities["Cold"].lazyMatches, 0u);
+    ASSERT_EQ(stats.securities["Cold"].switches, 1u);
+    ASSERT_TRUE(stats.securities["Shift"].eager);
+    ASSERT_GE(stats.securities["Shift"].switches, 2u);
+    ASSERT_GT(stats.securities["Shift"].eagerMatches, 0u);
+    ASSERT_GT(stats.securities["Shift"].lazyMatches, 0u);
+    ASSERT_FALSE(stats.switches.empty());
+    ASSERT_TRUE(std::any_of(stats.switches.begin(), stats.switches.end(),
+        [](const MatchingSwitch& item) { return item.securityId == "Cold" && !item.eager && item.addsSinceQuery > ADAPTIVE_LAZY_RATIO; }));
+    ASSERT_EQ(stats.switches.back().securityId, "Shift");
+    ASSERT_TRUE(stats.switches.back().eager);
+    ASSERT_LT(stats.switches.back().addsPerQuery, (double)ADAPTIVE_EAGER_RATIO);
+
+    // tracked matching stats (by security)
+    MemoryUsage matching = cache.memoryReport().structures["_matchingStats"];
+    ASSERT_EQ(matching.elements, stats.securities.size());
+    ASSERT_GE(matching.allocatedBytes, stats.securities.size() * sizeof(SecurityMatchingStats));
+}
+
+// Extended Test 24: good-till-date / good-for-day orders expiry (timing wheel vs cancels by an external scheduler)
+TEST_F(OrderCacheTest, X24_PerformanceTest_OrderExpiry) {
+    const unsigned int size = 100000;
+    const uint64_t t0 = 1700000000000000ull;   // microseconds since epoch
+    const uint64_t day = 86400000000ull;
+
+    debug::timer_start start;
+    utils::osyncstream out;
+
+    OrderCache scheduled;
+    scheduled.setVerbose(false);
+    cache.setVerbose(false);
+
+    // a quarter good-till-cancel, a quarter good-for-day, the others expiring from milliseconds 
+    // up to 60 days (beyond the timing wheel range) after t0
+    std::vector<std::pair<uint64_t, std::string>> expiries;
+    for (unsigned int i = 0; i < size; i++) {
+        Order order{ "OrdId" + std::to_string(i), "SecId" + std::to_string(i % 20), i % 3 ? "Buy" : "Sell",
+            1 + i % 100, "User" + std::to_string(i % 10), "Company" + std::to_string(i % 7) };
+        if (i % 4 == 1)
+            order.setExpiry(Order::GOOD_FOR_DAY);
+        else if (i % 4 > 1) {
+            const uint64_t offset = i % 8 == 2 ? (uint64_t)i * 7919 % (2 * day) : (uint64_t)i * 104729 % (60 * day);
+            order.setExpiry(t0 + offset);
+            expiries.emplace_back(t0 + offset, order.orderId());
+        }
+        scheduled.addOrder(order.clone());
+        cache.addOrder(std::move(order));
+    }
+    ASSERT_EQ(cache.expiringOrders(), size * 3 / 4);
+    ASSERT_EQ(cache.memoryReport().structures["_expiryWheel"].elements, size * 3 / 4);
+    ASSERT_GE(cache.memoryReport().structures["_expiryWheel"].allocatedBytes, size * 3 / 4 * sizeof(order_ptr));
+
+    // cancelled orders are unscheduled
+    for (unsigned int i = 2; i < size; i += 400)
+        cache.cancelOrder("OrdId" + std::to_string(i));
+    for (unsigned int i = 2; i < size; i += 400)
+        scheduled.cancelOrder("OrdId" + std::to_string(i));
+    ASSERT_EQ(cache.expiringOrders(), size * 3 / 4 - size / 400);
+    std::sort(expiries.begin(), expiries.end());
+
+    // expiries by the timing wheel (bulk) vs per order cancels (sorted expiries)
+    std::vector<uint64_t> times;
+    for (uint64_t now = t0 - day; now < t0 + 61 * day; now += now < t0 + 2 * day ? 60000000ull : day)
+        times.push_back(now);
+
+    start = debug::TestUtils::tic();
+    size_t expired = 0;
+    for (const uint64_t& now : times)
+        expired += cache.expireOrders(now);
+    debug::TestUtils::toc(out, start, "timing wheel expiry time: ");
+
+    start = debug::TestUtils::tic();
+    auto next = expiries.begin();
+    for (const uint64_t& now : times)
+        for (; next != expiries.end() && next->first <= now; ++next)
+            scheduled.cancelOrder(next->second);
+    debug::TestUtils::toc(out, start, "per order cancels time: ");
+
+    ASSERT_EQ(expired, size / 2 - size / 400);
+    ASSERT_EQ(cache.size(), scheduled.size());
+    ASSERT_EQ(cache.expiringOrders(), size / 4);
+    for (const Order& order : scheduled.getAllOrders())
+        ASSERT_TRUE(order.expiry() == Order::GOOD_TILL_CANCEL || order.expiry() == Order::GOOD_FOR_DAY);
+    for (const Order& order : cache.getAllOrders())
+        ASSERT_TRUE(order.expiry() == Order::GOOD_TILL_CANCEL || order.expiry() == Order::GOOD_FOR_DAY);
+    for (unsigned int i = 0; i < 20; i++)
+        ASSERT_EQ(cache.getMatchingSizeForSecurity("SecId" + std::to_string(i)), scheduled.getMatchingSizeForSecurity("SecId" + std::to_string(i)));
+
+    // exact expiry times (tick resolution) and past expiries
+    const uint64_t now = t0 + 62 * day;
+    Order order1{ "Exp1", "SecIdExp", "Buy", 10, "User1", "CompanyX" };
+    Order order2{ "Exp2", "SecIdExp", "Sell", 10, "User2", "CompanyY" };
+    Order order3{ "Exp3", "SecIdExp", "Sell", 10, "User3", "CompanyZ" };
+    order1.setExpiry(now + EXPIRY_TICK_US);
+    order2.setExpiry(now + EXPIRY_TICK_US + 1);
+    order3.setExpiry(now - day);
+    cache.addOrder(std::move(order1));
+    cache.addOrder(std::move(order2));
+    cache.addOrder(std::move(order3));
+    ASSERT_EQ(cache.expireOrders(now), 1u);
+    ASSERT_EQ(cache.expireOrders(now + EXPIRY_TICK_US - 1), 0u);
+    ASSERT_EQ(cache.expireOrders(now + EXPIRY_TICK_US), 1u);
+    ASSERT_EQ(cache.getOrder("Exp2").orderId(), "Exp2");
+    ASSERT_EQ(cache.expireOrders(now + 2 * EXPIRY_TICK_US), 1u);
+
+    // session end
+    ASSERT_EQ(cache.endSession(), size / 4);
+    ASSERT_EQ(cache.expiringOrders(), 0u);
+    ASSERT_EQ(cache.size(), size / 4);
+    for (const Order& order : cache.getAllOrders())
+        ASSERT_EQ(order.expiry(), Order::GOOD_TILL_CANCEL);
+}
+
+// Extended Test 25: cancel on disconnect (session orders spanning several users vs cancels by user)
+TEST_F(OrderCacheTest, X25_PerformanceTest_CancelOrdersForSession) {
+    const unsigned int size = 100000;
+    const unsigned int sessions = 50;   // 4 users per session
+
+    debug::timer_start start;
+    utils::osyncstream out;
+
+    OrderCache byUser;
+    byUser.setVerbose(false);
+    cache.setVerbose(false);
+
+    for (unsigned int i = 0; i < size; i++) {
+        const unsigned int user = i % (4 * sessions);
+        Order order{ "OrdId" + std::to_string(i), "SecId" + std::to_string(i % 20), i % 3 ? "Buy" : "Sell",
+            1 + i % 100, "User" + std::to_string(user), "Company" + std::to_string(i % 7) };
+        order.setSession("Session" + std::to_string(user / 4));
+        byUser.addOrder(order.clone());
+        cache.addOrder(std::move(order));
+    }
+    // an order without session
+    cache.addOrder(Order{ "NoSession", "SecId1", "Buy", 10, "User0", "Company0" });
+    byUser.addOrder(Order{ "NoSession", "SecId1", "Buy", 10, "User0", "Company0" });
+    ASSERT_EQ(cache.getOrder("OrdId5").session(), "Session1");
+    ASSERT_EQ(cache.getOrder("NoSession").session(), "");
+
+    // half of the sessions drop
+    start = debug::TestUtils::tic();
+    for (unsigned int session = 0; session < sessions; session += 2)
+        cache.cancelOrdersForSession("Session" + std::to_string(session));
+    debug::TestUtils::toc(out, start, "cancel orders for session time: ");
+
+    start = debug::TestUtils::tic();
+    for (unsigned int session = 0; session < sessions; session += 2)
+        for (unsigned int user = 4 * session; user < 4 * session + 4; user++)
+            byUser.cancelOrdersForUser("User" + std::to_string(user));
+    debug::TestUtils::toc(out, start, "cancel orders for users time: ");
+
+    // the no session order of "User0" is kept
+    ASSERT_EQ(cache.size(), size / 2 + 1);
+    ASSERT_EQ(byUser.size(), size / 2);
+    ASSERT_EQ(cache.getOrder("NoSession").orderId(), "NoSession");
+    for (const Order& order : byUser.getAllOrders())
+        ASSERT_EQ(cache.getOrder(order.orderId()).workingQty(), order.workingQty());
+    for (const Order& order : cache.getAllOrders())
+        ASSERT_TRUE(order.session().empty() || (order.session().back() - '0') % 2 == 1);
+
+    // dropped session is gone, other sessions are kept
+    cache.cancelOrdersForSession("Session0");
+    ASSERT_EQ(cache.size(), size / 2 + 1);
+    cache.cancelOrder("OrdId5");
+    cache.cancelOrdersForSession("Session1");
+    ASSERT_EQ(cache.size(), size / 2 + 1 - size / sessions);
+    ASSERT_EQ(cache.memoryReport().structures["_sessionOrdersIndex"].elements, sessions / 2 - 1);
+}
+
+// Extended Test 26: pre-trade risk checks (running aggregates vs exposures computed from the orders)
+TEST_F(OrderCacheTest, X26_PerformanceTest_RiskChecks) {
+    const unsigned int size = 100000;
+
+    debug::timer_start start;
+    utils::osyncstream out;
+
+    RiskLimits userLimits;
+    userLimits.maxSideQty = 3000;
+    userLimits.maxSecurityQty = 1500;
+    userLimits.maxTotalQty = 5000;
+    RiskLimits companyLimits;
+    companyLimits.maxSideQty = 20000;
+    companyLimits.maxSecurityQty = 8000;
+    companyLimits.maxTotalQty = 30000;
+
+    // risk checks are only enabled on an empty cache
+    OrderCache unchecked;
+    unchecked.setVerbose(false);
+    unchecked.addOrder(Order{ "Unchecked", "SecId1", "Buy", 10, "User1", "Company1" });
+    unchecked.setRiskLimits(userLimits, companyLimits);
+    ASSERT_FALSE(unchecked.riskChecks());
+    unchecked.cancelOrder("Unchecked");
+
+    cache.setVerbose(false);
+    cache.setRiskLimits(userLimits, companyLimits);
+    ASSERT_TRUE(cache.riskChecks());
+
+    // exposures computed from the orders - O(n)
+    auto exposures = [](OrderCache& target, bool byCompany) {
+        std::map<std::string, RiskExposure> result;
+        for (const Order& order : target.getAllOrders()) {
+            RiskExposure& exposure = result[byCompany ? order.company() : order.user()];
+            (order.side() == "Buy" ? exposure.buy : exposure.sell) += order.workingQty();
+            exposure.securities[order.securityId()] += order.workingQty();
+        }
+        return result;
+    };
+    auto expected = [](const Order& order, uint64_t qty, const std::map<std::string, RiskExposure>& byKey, 
+        const std::string& key, const RiskLimits& limits, RiskReject side, RiskReject security, RiskReject total) {
+        RiskExposure exposure;
+        if (byKey.count(key))
+            exposure = byKey.at(key);
+        if ((order.side() == "Buy" ? exposure.buy : exposure.sell) + qty > limits.maxSideQty)
+            return side;
+        if (exposure.securities[order.securityId()] + qty > limits.maxSecurityQty)
+            return security;
+        if (exposure.total() + qty > limits.maxTotalQty)
+            return total;
+        return RiskReject::None;
+    };
+    // reject reason predicted from the exposures computed from the orders - O(n)
+    auto predict = [&](const Order& order, uint64_t qty) {
+        RiskReject prediction = expected(order, qty, exposures(cache, false), order.user(), userLimits,
+            RiskReject::UserSideLimit, RiskReject::UserSecurityLimit, RiskReject::UserTotalLimit);
+        if (prediction == RiskReject::None)
+            prediction = expected(order, qty, exposures(cache, true), order.company(), companyLimits,
+                RiskReject::CompanySideLimit, RiskReject::CompanySecurityLimit, RiskReject::CompanyTotalLimit);
+        return prediction;
+    };
+    auto same = [](const RiskExposure& lhs, const RiskExposure& rhs) {
+        if (lhs.buy != rhs.buy || lhs.sell != rhs.sell)
+            return false;
+        for (auto& item : lhs.securities)
+            if (item.second != (rhs.securities.count(item.first) ? rhs.securities.at(item.first) : 0))
+                return false;
+        for (auto& item : rhs.securities)
+            if (item.second != (lhs.securities.count(item.first) ? lhs.securities.at(item.first) : 0))
+                return false;
+        return true;
+    };
+
+    size_t accepted = 0, rejected = 0, amendsAccepted = 0, amendsRejected = 0;
+    start = debug::TestUtils::tic();
+    for (unsigned int i = 0; i < size; i++) {
+        Order order{ "OrdId" + std::to_string(i), "SecId" + std::to_string(i % 20), i % 3 ? "Buy" : "Sell",
+            1 + i % 100, "User" + std::to_string(i % 50), "Company" + std::to_string(i % 7) };
+
+        // checks every 50th add and the adds following an amend
+        const bool checked = i % 50 == 0 || i % 97 == 1;
+        const RiskReject prediction = checked ? predict(order, order.qty()) : RiskReject::None;
+
+        const RiskReject reject = cache.addOrderChecked(std::move(order));
+        if (checked) {
+            ASSERT_EQ(reject, prediction);
+        }
+        (reject == RiskReject::None ? accepted : rejected)++;
+
+        if (i % 97 == 0) {
+            // amends: only the additional lots of an increase are checked
+            const std::string orderId = "OrdId" + std::to_string(i / 2);
+            const unsigned int qty = 1 + i % 150;
+            RiskReject amendPrediction = RiskReject::UnknownOrder;
+            if (cache.exists(orderId)) {
+                const Order& amended = cache.getOrder(orderId);
+                amendPrediction = qty > amended.qty() ? predict(amended, qty - amended.qty()) : RiskReject::None;
+            }
+            ASSERT_EQ(cache.amendOrderChecked(orderId, qty), amendPrediction);
+            (amendPrediction == RiskReject::None || amendPrediction == RiskReject::UnknownOrder ? amendsAccepted : amendsRejected)++;
+        }
+        if (i % 89 == 0)
+            cache.cancelOrder("OrdId" + std::to_string(i / 3));
+        if (i % 10007 == 0)
+            cache.cancelOrdersForUser("User" + std::to_string(i % 50));
+    }
+    debug::TestUtils::toc(out, start, "adds with risk checks time: ");
+    ASSERT_GT(accepted, 0u);
+    ASSERT_GT(rejected, 0u);
+    ASSERT_GT(amendsAccepted, 0u);
+    ASSERT_GT(amendsRejected, 0u);
+    ASSERT_EQ(cache.addOrderChecked(Order{ "OrdId1", "SecId1", "Buy", 1, "User1", "Company1" }), RiskReject::DuplicateOrder);
+
+    // running aggregates (adds, fills, amends and cancels)
+    for (auto& item : exposures(cache, false))
+        ASSERT_TRUE(same(cache.userExposure(item.first), item.second));
+    for (auto& item : exposures(cache, true))
+        ASSERT_TRUE(same(cache.companyExposure(item.first), item.second));
+    for (unsigned int i = 0; i < 50; i++)
+        ASSERT_LE(cache.userExposure("User" + std::to_string(i)).total(), userLimits.maxTotalQty);
+    ASSERT_EQ(cache.memoryReport().structures["_riskExposures"].elements, 50u + 7u);
+    ASSERT_GT(cache.memoryReport().structures["_riskExposures"].allocatedBytes, 0u);
+    ASSERT_EQ(cache.userExposure("User1").securities.get_allocator().counter(), nullptr);
+
+    // without risk checks
+    start = debug::TestUtils::tic();
+    for (unsigned int i = 0; i < size; i++)
+        unchecked.addOrder(Order{ "OrdId" + std::to_string(i), "SecId" + std::to_string(i % 20), i % 3 ? "Buy" : "Sell",
+            1 + i % 100, "User" + std::to_string(i % 50), "Company" + std::to_string(i % 7) });
+    debug::TestUtils::toc(out, start, "adds without risk checks time: ");
+    ASSERT_EQ(unchecked.userExposure("User1").total(), 0u);
+
+    // cancels release the exposure
+    for (unsigned int i = 0; i < 50; i++)
+        cache.cancelOrdersForUser("User" + std::to_string(i));
+    ASSERT_EQ(cache.companyExposure("Company1").total(), 0u);
+    ASSERT_EQ(cache.addOrderChecked(Order{ "Big", "SecId1", "Buy", 1500, "User1", "Company1" }), RiskReject::None);
+    ASSERT_EQ(cache.addOrderChecked(Order{ "Big2", "SecId1", "Sell", 1, "User1", "Company2" }), RiskReject::UserSecurityLimit);
+
+    // amend increases are checked (order left unchanged on reject), reduces are not
+    ASSERT_EQ(cache.amendOrderChecked("Big", 1501), RiskReject::UserSecurityLimit);
+    ASSERT_EQ(cache.getOrder("Big").qty(), 1500u);
+    ASSERT_EQ(cache.userExposure("User1").total(), 1500u);
+    cache.amendOrder("Big", 1600);
+    ASSERT_EQ(cache.getOrder("Big").qty(), 1500u);
+    ASSERT_EQ(cache.amendOrderChecked("Big", 1000), RiskReject::None);
+    ASSERT_EQ(cache.userExposure("User1").total(), 1000u);
+    ASSERT_EQ(cache.amendOrderChecked("Big", 1500), RiskReject::None);
+    ASSERT_EQ(cache.userExposure("User1").total(), 1500u);
+    ASSERT_EQ(cache.amendOrderChecked("Missing", 10), RiskReject::UnknownOrder);
+
+    // copies of checked orders added to another cache do not update the source aggregates
+    {
+        OrderCache other;
+        other.setVerbose(false);
+        for (const Order& order : cache.getAllOrders())
+            other.addOrder(order);
+        other.cancelOrder("Big");
+    }
+    ASSERT_EQ(cache.userExposure("User1").total(), 1500u);
+    ASSERT_EQ(cache.companyExposure("Company1").total(), 1500u);
+
+    // lazy and adaptive modes: the exposures exclude the lots that would have matched
+    for (MatchingMode mode : { MatchingMode::Default, MatchingMode::Lazy, MatchingMode::Adaptive }) {
+        RiskLimits limits;
+        limits.maxSideQty = 150;
+        OrderCache matching;
+        matching.setVerbose(false);
+        matching.setMatchingMode(mode);
+        matching.setRiskLimits(limits, companyLimits);
+        ASSERT_EQ(matching.addOrderChecked(Order{ "B1", "SecId1", "Buy", 100, "User1", "Company1" }), RiskReject::None);
+        ASSERT_EQ(matching.addOrderChecked(Order{ "S1", "SecId1", "Sell", 100, "User2", "Company2" }), RiskReject::None);
+        ASSERT_EQ(matching.addOrderChecked(Order{ "B2", "SecId1", "Buy", 100, "User1", "Company1" }), RiskReject::None);
+        ASSERT_EQ(matching.amendOrderChecked("B2", 150), RiskReject::None);
+        ASSERT_EQ(matching.pendingMatches(), 0u);
+        ASSERT_EQ(matching.userExposure("User1").buy, 150u);
+    }
+}
+
+// Extended Test 27: scalability of mixed concurrent workloads (1..N producers adding / cancelling, M readers)
+TEST_F(OrderCacheTest, X27_PerformanceTest_ThreadScalability) {
+    const unsigned int ops = 4000;        // adds per producer (half of them cancelled)
+    const unsigned int readers = 2;
+    const unsigned int anchors = 1000;    // orders read by the readers (never cancelled)
+    const unsigned int maxProducers = std::max(4u, std::thread::hardware_concurrency());
+
+    utils::osyncstream out;
+    out << "\nproducers | readers | writes/s | reads/s | write latency | read latency\n";
+
+    for (unsigned int producers = 1; producers <= maxProducers; producers *= 2) {
+        OrderCache target;
+        target.setVerbose(false);
+        for (unsigned int i = 0; i < anchors; i++)
+            target.addOrder(Order{ "Anchor" + std::to_string(i), "SecId" + std::to_string(i % 8), i % 2 ? "Buy" : "Sell",
+                1 + i % 100, "User" + std::to_string(i % 10), "Company" + std::to_string(i % 4) });
+
+        std::vector<debug::LatencyHistogram> writes(producers), reads(readers);
+        std::atomic<unsigned int> running{ producers };
+        std::atomic<bool> go{ false };
+        std::vector<std::thread> threads;
+
+        for (unsigned int t = 0; t < producers; t++)
+            threads.emplace_back([&, t]() {
+                while (!go.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+                const std::string prefix = "P" + std::to_string(t) + "_";
+                for (unsigned int k = 0; k < ops; k++) {
+                    debug::timer_start start = debug::TestUtils::tic();
+                    target.addOrder(Order{ prefix + std::to_string(k), "SecId" + std::to_string(k % 8), (k + t) % 2 ? "Buy" : "Sell",
+                        1 + k % 100, "User" + std::to_string(t), "Company" + std::to_string(t % 4) });
+                    writes[t].record(start);
+                    if (k % 2 == 1) {
+                        start = debug::TestUtils::tic();
+                        target.cancelOrder(prefix + std::to_string(k - 1));
+                        writes[t].record(start);
+                    }
+                }
+                running--;
+            });
+
+        for (unsigned int r = 0; r < readers; r++)
+            threads.emplace_back([&, r]() {
+                while (!go.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+                for (unsigned int k = r; running.load(std::memory_order_acquire) > 0; k++) {
+                    debug::timer_start start = debug::TestUtils::tic();
+                    if (k % 2)
+                        target.getMatchingSizeForSecurity("SecId" + std::to_string(k % 8));
+                    else
+                        (void)target.getOrder("Anchor" + std::to_string(k % anchors)).qty();
+                    reads[r].record(start);
+                }
+            });
+
+        debug::timer_start start = debug::TestUtils::tic();
+        go.store(true, std::memory_order_release);
+        for (std::thread& thread : threads)
+            thread.join();
+        const double seconds = std::max<long long>(1, debug::TestUtils::toc(start)) / 1e6;
+
+        debug::LatencyHistogram write, read;
+        for (auto& histogram : writes)
+            write.merge(histogram);
+        for (auto& histogram : reads)
+            read.merge(histogram);
+
+        ASSERT_EQ(target.size(), anchors + producers * ops / 2);
+        ASSERT_EQ(write.count(), (uint64_t)producers * (ops + ops / 2));
+        ASSERT_LE(write.percentile(50), write.percentile(99));
+        ASSERT_LE(write.percentile(99), write.percentile(99.9));
+        ASSERT_LE(write.percentile(99.9), write.max());
+
+        out << std::setw(9) << producers << " | " << std::setw(7) << readers << " | "
+            << std::setw(8) << (uint64_t)(write.count() / seconds) << " | " << std::setw(7) << (uint64_t)(read.count() / seconds)
+            << " | " << write.str() << " | " << read.str() << '\n';
+    }
+    out.flush();
+}
+
+// Extended Test 28: open-loop load (fixed schedule) latency vs closed-loop timing (coordinated omission)
+TEST_F(OrderCacheTest, X28_PerformanceTest_OpenLoopLoad) {
+    const uint64_t ops = 40000;
+
+    utils::osyncstream out;
+    cache.setVerbose(false);
+
+    // adds and cancels on schedule (2 sender threads)
+    debug::LoadGenerator generator(200000, 2);
+    auto operation = [&](unsigned int t, uint64_t k) {
+        const std::string prefix = "T" + std::to_string(t) + "_";
+        if (k % 4 < 2)
+            cache.addOrder(Order{ prefix + std::to_string(k), "SecId" + std::to_string(k % 8), k % 4 ? "Buy" : "Sell",
+                (unsigned int)(1 + k % 100), "User" + std::to_string(k % 10), "Company" + std::to_string(k % 3) });
+        else
+            cache.cancelOrder(prefix + std::to_string(k - 2));
+    };
+    debug::LoadReport report = generator.run(ops, operation);
+    out << report.str();
+
+    ASSERT_EQ(report.ops, ops);
+    ASSERT_EQ(report.latency.count(), ops);
+    ASSERT_EQ(cache.size(), 0u);
+    ASSERT_GE(report.latency.percentile(50), report.service.percentile(50) / 2);
+    ASSERT_GE(report.latency.max(), report.service.max());
+
+    // a 20ms stall: a single slow sample for the closed-loop timing, 
+    // but it delays every operation scheduled meanwhile (10% of them)
+    debug::LoadGenerator stalled(100000, 1);
+    debug::LoadReport stall = stalled.run(20000, [&](unsigned int, uint64_t k) {
+        if (k == 5000)
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        cache.getMatchingSizeForSecurity("SecId" + std::to_string(k % 8));
+    });
+    out << stall.str();
+    out.flush();
+
+    ASSERT_EQ(stall.ops, 20000u);
+    ASSERT_GE(stall.late, 1000u);
+    ASSERT_GE(stall.latency.percentile(95), 1000000u);
+    ASSERT_LT(stall.service.percentile(95), stall.latency.percentile(95));
+    ASSERT_GE(stall.service.max(), 20000000u);
+}
+
+// Extended Test 30: matched volume series by security (time buckets vs differencing the matched sizes)
+TEST_F(OrderCacheTest, X30_PerformanceTest_MatchedVolumeSeries) {
+    const unsigned int size = 100000;
+    const unsigned int securities = 20;
+
+    debug::timer_start start;
+    utils::osyncstream out;
+
+    auto now = []() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    };
+    auto fill = [&](OrderCache& target) {
+        for (unsigned int i = 0; i < size; i++)
+            target.addOrder(Order{ "OrdId" + std::to_string(i), "SecId" + std::to_string(i % securities), i % 3 ? "Buy" : "Sell",
+                1 + i % 100, "User" + std::to_string(i % 10), "Company" + std::to_string(i % 7) });
+    };
+
+    OrderCache plain;
+    plain.setVerbose(false);
+    start = debug::TestUtils::tic();
+    fill(plain);
+    debug::TestUtils::toc(out, start, "adds without volume series time: ");
+
+    cache.setVerbose(false);
+    cache.setVolumeSeries(true);
+    ASSERT_TRUE(cache.volumeSeries());
+    const uint64_t from = now();
+    start = debug::TestUtils::tic();
+    fill(cache);
+    debug::TestUtils::toc(out, start, "adds with volume series time: ");
+    const uint64_t to = now() + 1;
+
+    // the buckets of the range add up to the matched size (seconds and minutes)
+    start = debug::TestUtils::tic();
+    for (unsigned int i = 0; i < securities; i++) {
+        const std::string securityId = "SecId" + std::to_string(i);
+        uint64_t seconds = 0, minutes = 0;
+        for (const VolumeBucket& bucket : cache.getMatchedVolume(securityId, from, to))
+            seconds += bucket.volume;
+        for (const VolumeBucket& bucket : cache.getMatchedVolume(securityId, from, to, VolumeResolution::Minute))
+            minutes += bucket.volume;
+        ASSERT_EQ(seconds, cache.getMatchingSizeForSecurity(securityId));
+        ASSERT_EQ(minutes, cache.getMatchingSizeForSecurity(securityId));
+        ASSERT_EQ(seconds, plain.getMatchingSizeForSecurity(securityId));
+    }
+    debug::TestUtils::toc(out, start, "volume range queries time: ");
+
+    // one bucket per interval (consecutive starts), empty outside the matching interval
+    std::vector<VolumeBucket> buckets = cache.getMatchedVolume("SecId1", from - 10000000, to + 10000000);
+    ASSERT_GE(buckets.size(), 20u);
+    for (size_t i = 1; i < buckets.size(); i++)
+        ASSERT_EQ(buckets[i].start, buckets[i - 1].start + 1000000);
+    ASSERT_EQ(buckets.front().volume, 0u);
+    ASSERT_EQ(buckets.back().volume, 0u);
+
+    // only the last ring buckets of a range are kept
+    ASSERT_EQ(cache.getMatchedVolume("SecId1", from - 3600000000ull, to).size(), VOLUME_SECOND_BUCKETS);
+    ASSERT_TRUE(cache.getMatchedVolume("NoSecId", from, to).empty());
+    ASSERT_TRUE(plain.getMatchedVolume("SecId1", from, to).empty());
+
+    // tracked rings (both resolutions, by security)
+    MemoryUsage volume = cache.memoryReport().structures["_matchedVolume"];
+    ASSERT_EQ(volume.elements, securities);
+    ASSERT_GE(volume.allocatedBytes, securities * (VOLUME_SECOND_BUCKETS + VOLUME_MINUTE_BUCKETS) * 2 * sizeof(uint64_t));
+    ASSERT_EQ(plain.memoryReport().structures["_matchedVolume"].allocatedBytes, 0u);
+}
+
+
+// Extended Test 31: change data capture (incremental sync of a downstream copy vs full pulls)
+TEST_F(OrderCacheTest, X31_PerformanceTest_OrdersChangedSince) {
+    const unsigned int size = 100000;
+
+    debug::timer_start start;
+    utils::osyncstream out;
+
+    auto add = [&](unsigned int from, unsigned int to) {
+        for (unsigned int i = from; i < to; i++)
+            cache.addOrder(Order{ "OrdId" + std::to_string(i), "SecId" + std::to_string(i % 50), i % 3 ? "Buy" : "Sell",
+                1 + i % 100, "User" + std::to_string(i % 10), "Company" + std::to_string(i % 7) });
+    };
+
+    // downstream copy (by order id), synchronized by the changes since the last sequence
+    std::unordered_map<std::string, Order> copy;
+    uint64_t sequence = 0;
+    size_t changed = 0;
+    auto sync = [&]() {
+        OrderChanges changes = cache.getOrdersChangedSince(sequence);
+        if (changes.resync)
+            copy.clear();
+        for (const Order& order : changes.orders)
+            copy.insert_or_assign(order.orderId(), order);
+        for (const std::string& orderId : changes.cancelled)
+            copy.erase(orderId);
+        sequence = changes.sequence;
+        changed = changes.orders.size() + changes.cancelled.size();
+        return changes.resync;
+    };
+    auto assertSynchronized = [&]() {
+        std::vector<Order> orders = cache.getAllOrders();
+        ASSERT_EQ(copy.size(), orders.size());
+        for (const Order& order : orders) {
+            auto it = copy.find(order.orderId());
+            ASSERT_TRUE(it != copy.end());
+            ASSERT_EQ(it->second.workingQty(), order.workingQty());
+            ASSERT_EQ(it->second.qty(), order.qty());
+            ASSERT_EQ(it->second.changeSequence(), order.changeSequence());
+        }
+    };
+
+    cache.setVerbose(false);
+    cache.setChangeLog();
+    ASSERT_EQ(cache.changeLog(), CHANGE_LOG_SIZE);
+    ASSERT_GE(cache.memoryReport().structures["_changeLog"].allocatedBytes, CHANGE_LOG_SIZE * sizeof(std::string));
+    add(0, size);
+    ASSERT_FALSE(sync());
+    ASSERT_EQ(sequence, cache.changeSequence());
+    assertSynchronized();
+
+    // a few changes: fills (new orders), amends and cancels
+    add(size, size + 1000);
+    cache.amendOrder("OrdId1", 1000);
+    cache.cancelOrder("OrdId2");
+    cache.cancelOrdersForUser("User3");
+    start = debug::TestUtils::tic();
+    ASSERT_FALSE(sync());
+    debug::TestUtils::toc(out, start, "incremental sync time: ");
+    ASSERT_LT(changed, size / 2);
+    assertSynchronized();
+    ASSERT_TRUE(copy.find("OrdId2") == copy.end());
+
+    // reused ids: each id is reported once, by its newest order (live or cancelled)
+    cache.cancelOrder("OrdId4");
+    cache.addOrder(Order{ "OrdId4", "SecId9", "Buy", 7, "User9", "Company9" });
+    cache.cancelOrder("OrdId5");
+    cache.addOrder(Order{ "OrdId5", "SecId9", "Buy", 7, "User9", "Company9" });
+    cache.cancelOrder("OrdId5");
+    OrderChanges reused = cache.getOrdersChangedSince(sequence);
+    ASSERT_EQ(reused.orders.size(), 1u);
+    ASSERT_EQ(reused.orders[0].orderId(), "OrdId4");
+    ASSERT_EQ(reused.orders[0].qty(), 7u);
+    ASSERT_EQ(reused.cancelled, std::vector<std::string>{ "OrdId5" });
+    ASSERT_FALSE(sync());
+    assertSynchronized();
+
+    start = debug::TestUtils::tic();
+    std::vector<Order> orders = cache.getAllOrders();
+    debug::TestUtils::toc(out, start, "full pull time: ");
+
+    // nothing changed
+    ASSERT_FALSE(sync());
+    ASSERT_EQ(changed, 0u);
+
+    // the (bounded) change log does not cover old sequences: resynchronization
+    OrderCache small;
+    small.setVerbose(false);
+    small.setChangeLog(100);
+    for (unsigned int i = 0; i < 1000; i++)
+        small.addOrder(Order{ "OrdId" + std::to_string(i), "SecId1", "Buy", 10, "User1", "Company1" });
+    OrderChanges changes = small.getOrdersChangedSince(10);
+    ASSERT_TRUE(changes.resync);
+    ASSERT_EQ(changes.orders.size(), small.size());
+    changes = small.getOrdersChangedSince(small.changeSequence() - 100);
+    ASSERT_FALSE(changes.resync);
+    ASSERT_EQ(changes.orders.size(), 100u);
+    ASSERT_TRUE(OrderCache().getOrdersChangedSince(0).orders.empty());
+}
+
+
 #ifdef EXTENDED_INTERFACE
 
 // Extended Test 11: Get
@@ -641,6 +2467,91 @@ TEST_F(OrderCacheTest, X11_ExtendedTest_GetAllOrderMatches) {
     ASSERT_EQ(orders.size(), 4);
 }
 
+// Extended Test 29: per security fills (chunked, with sequence numbers) and paged retrieval
+TEST_F(OrderCacheTest, X29_PerformanceTest_OrderMatchesBySecurity) {
+    const unsigned int size = 100000;
+    const unsigned int securities = 50;
+
+    debug::timer_start start;
+    utils::osyncstream out;
+    cache.setVerbose(false);
+
+    for (unsigned int i = 0; i < size; i++)
+        cache.addOrder(Order{ std::to_string(i), "SecId" + std::to_string(i % securities), i % 3 ? "Buy" : "Sell",
+            1 + i % 100, "User" + std::to_string(i % 10), "Company" + std::to_string(i % 7) });
+
+    std::vector<OrderFill> all = cache.getAllOrderMatches();
+    ASSERT_GT(all.size(), 0u);
+    ASSERT_EQ(cache.orderMatchesSequence(), all.size());
+    for (size_t i = 0; i < all.size(); i++)
+        ASSERT_EQ(all[i].sequence(), i);
+
+    // per security fills: the fills of its orders (order id % securities), in sequence order
+    start = debug::TestUtils::tic();
+    std::vector<OrderFill> filtered;
+    for (const OrderFill& fill : cache.getAllOrderMatches())
+        if (std::stoul(fill.buyOrderId()) % securities == 7)
+            filtered.push_back(fill);
+    debug::TestUtils::toc(out, start, "all fills filtering time: ");
+
+    start = debug::TestUtils::tic();
+    std::vector<OrderFill> bySecurity = cache.getOrderMatchesBySecurity("SecId7");
+    debug::TestUtils::toc(out, start, "security fills time: ");
+
+    ASSERT_EQ(bySecurity.size(), filtered.size());
+    for (size_t i = 0; i < bySecurity.size(); i++) {
+        ASSERT_EQ(bySecurity[i].sequence(), filtered[i].sequence());
+        ASSERT_EQ(bySecurity[i].buyOrderId(), filtered[i].buyOrderId());
+        ASSERT_EQ(bySecurity[i].sellOrderId(), filtered[i].sellOrderId());
+        ASSERT_EQ(bySecurity[i].qty(), filtered[i].qty());
+    }
+    size_t total = 0;
+    for (unsigned int i = 0; i < securities; i++)
+        total += cache.getOrderMatchesBySecurity("SecId" + std::to_string(i)).size();
+    ASSERT_EQ(total, all.size());
+    ASSERT_TRUE(cache.getOrderMatchesBySecurity("NoSecId").empty());
+
+    // paged retrieval (global and by security)
+    std::vector<OrderFill> paged;
+    for (uint64_t sequence = 0; ; ) {
+        std::vector<OrderFill> page = cache.getOrderMatches(sequence, 1000);
+        if (page.empty())
+            break;
+        ASSERT_LE(page.size(), 1000u);
+        sequence = page.back().sequence() + 1;
+        paged.insert(paged.end(), page.begin(), page.end());
+    }
+    ASSERT_EQ(paged.size(), all.size());
+    ASSERT_EQ(paged.back().sequence(), all.back().sequence());
+
+    std::vector<OrderFill> pagedSecurity;
+    for (uint64_t sequence = 0; ; ) {
+        std::vector<OrderFill> page = cache.getOrderMatchesBySecurity("SecId7", sequence, 100);
+        if (page.empty())
+            break;
+        sequence = page.back().sequence() + 1;
+        pagedSecurity.insert(pagedSecurity.end(), page.begin(), page.end());
+    }
+    ASSERT_EQ(pagedSecurity.size(), bySecurity.size());
+    for (size_t i = 0; i < pagedSecurity.size(); i++)
+        ASSERT_EQ(pagedSecurity[i].sequence(), bySecurity[i].sequence());
+    ASSERT_TRUE(cache.getOrderMatches(all.size(), 10).empty());
+
+    // exported fills keep their sequence numbers (paging resumes from the last exported fill)
+    utils::output_buffer exported;
+    for (const OrderFill& fill : cache.getOrderMatches(0, 1000))
+        fill.writeBinary(exported);
+    auto decoded = OrderFill{ "", "", 0 };
+    const char* first = exported.data();
+    while (first != exported.data() + exported.size())
+        ASSERT_TRUE(OrderFill::readBinary(first, exported.data() + exported.size(), decoded));
+    ASSERT_EQ(decoded.sequence(), 999u);
+    std::vector<OrderFill> resumed = cache.getOrderMatches(decoded.sequence() + 1, 1);
+    ASSERT_EQ(resumed.front().sequence(), 1000u);
+    ASSERT_EQ(resumed.front().buyOrderId(), all[1000].buyOrderId());
+}
+
+
 #endif // EXTENDED_INTERFACE
 
 #endif // EXTENDED_TESTING